@@ -0,0 +1,62 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#include "IAudioCacheClient.h"
+
+namespace talcs {
+
+    /**
+     * @interface IAudioCacheClient
+     * @brief Interface for objects that hold audio caches accounted by AudioCacheBudget
+     *
+     * The getters are called by AudioCacheBudget from any thread while its own mutex is locked, so they must not block:
+     * they should return snapshots kept in atomic variables instead of locking the mutex shared with the audio thread.
+     * @see AudioCacheBudget
+     */
+
+    /**
+     * @fn qint64 IAudioCacheClient::cacheMemoryUsage() const
+     * Gets the memory currently allocated for the cache in bytes.
+     *
+     * This function can be called from any thread.
+     */
+
+    /**
+     * @fn qint64 IAudioCacheClient::preferredCacheMemory() const
+     * Gets the memory in bytes that the cache would use without a budget.
+     */
+
+    /**
+     * @fn qint64 IAudioCacheClient::minimumCacheMemory() const
+     * Gets the memory in bytes that the cache needs to keep working. The budget never limits the client below it.
+     */
+
+    /**
+     * @fn qint64 IAudioCacheClient::playheadDistance() const
+     * Gets how far the cached audio is from being played, in samples. Clients with smaller distance get their
+     * preferred memory first.
+     */
+
+    /**
+     * @fn void IAudioCacheClient::setCacheMemoryLimit(qint64 bytes)
+     * Limits the memory of the cache. This function is called by AudioCacheBudget during rebalancing, and the client
+     * should shrink or evict its cache to fit the limit. A negative value means unlimited.
+     */
+
+}
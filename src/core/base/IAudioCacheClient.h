@@ -0,0 +1,40 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#ifndef TALCS_IAUDIOCACHECLIENT_H
+#define TALCS_IAUDIOCACHECLIENT_H
+
+#include <TalcsCore/TalcsCoreGlobal.h>
+
+namespace talcs {
+
+    class TALCSCORE_EXPORT IAudioCacheClient {
+    public:
+        virtual ~IAudioCacheClient() = default;
+
+        virtual qint64 cacheMemoryUsage() const = 0;
+        virtual qint64 preferredCacheMemory() const = 0;
+        virtual qint64 minimumCacheMemory() const = 0;
+        virtual qint64 playheadDistance() const = 0;
+        virtual void setCacheMemoryLimit(qint64 bytes) = 0;
+    };
+
+}
+
+#endif // TALCS_IAUDIOCACHECLIENT_H
@@ -51,6 +51,41 @@ namespace talcs {
             return d->intervalLookup(position(), content()).length();
         }
 
+        qint64 ClipViewImpl::fadeInLength() const {
+            Q_ASSERT(isValid());
+            return d->clipAttributesDict.value(k).fadeInLength;
+        }
+
+        FadeCurve::Shape ClipViewImpl::fadeInShape() const {
+            Q_ASSERT(isValid());
+            return d->clipAttributesDict.value(k).fadeInShape;
+        }
+
+        qint64 ClipViewImpl::fadeOutLength() const {
+            Q_ASSERT(isValid());
+            return d->clipAttributesDict.value(k).fadeOutLength;
+        }
+
+        FadeCurve::Shape ClipViewImpl::fadeOutShape() const {
+            Q_ASSERT(isValid());
+            return d->clipAttributesDict.value(k).fadeOutShape;
+        }
+
+        float ClipViewImpl::gain() const {
+            Q_ASSERT(isValid());
+            return d->clipAttributesDict.value(k).gain;
+        }
+
+        float ClipViewImpl::pan() const {
+            Q_ASSERT(isValid());
+            return d->clipAttributesDict.value(k).pan;
+        }
+
+        bool ClipViewImpl::isMute() const {
+            Q_ASSERT(isValid());
+            return d->clipAttributesDict.value(k).isMute;
+        }
+
         ClipViewImpl::ClipViewImpl(const IClipSeriesPrivate *d, qint64 k) : d(d), k(k) {
 
         }
@@ -67,13 +102,18 @@ namespace talcs {
         clipContentDict.insert(k, content);
         clipKeyDict.insert(content, k);
         clipContentSet.insert(content);
+        clipAttributesDict.insert(k, {});
+        positionSet.insert(position);
         endSet.insert(position + length);
+        updateEffectiveClipAttributes(position, length);
+        clipsVersion++;
         return ClipViewPrivate::ClipViewImpl(this, k);
     }
 
     void IClipSeriesPrivate::setClipStartPos(const ClipViewPrivate::ClipViewImpl &clipViewImpl, qint64 startPos) {
         Q_ASSERT(clipViewImpl.isValid());
         clipStartPosDict[clipViewImpl.k] = startPos;
+        clipsVersion++;
     }
 
     bool IClipSeriesPrivate::setClipRange(const ClipViewPrivate::ClipViewImpl &clipViewImpl, qint64 position, qint64 length) {
@@ -84,8 +124,13 @@ namespace talcs {
         auto interval = IClipSeriesPrivate::ClipInterval(clipViewImpl.content(), position, length);
         clips.insert(interval);
         clipPositionDict[clipViewImpl.k] = position;
-        endSet.erase(oldPosition + oldLength);
+        positionSet.erase(positionSet.find(oldPosition));
+        positionSet.insert(position);
+        endSet.erase(endSet.find(oldPosition + oldLength));
         endSet.insert(position + length);
+        updateEffectiveClipAttributes(oldPosition, oldLength);
+        updateEffectiveClipAttributes(position, length);
+        clipsVersion++;
         return true;
     }
 
@@ -99,13 +144,54 @@ namespace talcs {
         clips.erase(it);
         clipContentSet.remove(clipViewImpl.content());
         clipKeyDict.remove(clipViewImpl.content());
+        effectiveClipAttributesDict.insert(content, effectiveClipAttributesDict.take(clipViewImpl.content()));
         clipContentDict[clipViewImpl.k] = content;
         clipKeyDict[content] = clipViewImpl.k;
         clipContentSet.insert(content);
         clips.insert(newInterval);
+        clipsVersion++;
         return true;
     }
 
+    void IClipSeriesPrivate::setClipFadeIn(const ClipViewPrivate::ClipViewImpl &clipViewImpl, qint64 length, FadeCurve::Shape shape) {
+        Q_ASSERT(clipViewImpl.isValid());
+        auto &attributes = clipAttributesDict[clipViewImpl.k];
+        attributes.fadeInLength = qMax(0ll, length);
+        attributes.fadeInShape = shape;
+        updateEffectiveClipAttributes(clipViewImpl.position(), 1);
+        clipsVersion++;
+    }
+
+    void IClipSeriesPrivate::setClipFadeOut(const ClipViewPrivate::ClipViewImpl &clipViewImpl, qint64 length, FadeCurve::Shape shape) {
+        Q_ASSERT(clipViewImpl.isValid());
+        auto &attributes = clipAttributesDict[clipViewImpl.k];
+        attributes.fadeOutLength = qMax(0ll, length);
+        attributes.fadeOutShape = shape;
+        updateEffectiveClipAttributes(clipViewImpl.position(), 1);
+        clipsVersion++;
+    }
+
+    void IClipSeriesPrivate::setClipGain(const ClipViewPrivate::ClipViewImpl &clipViewImpl, float gain) {
+        Q_ASSERT(clipViewImpl.isValid());
+        clipAttributesDict[clipViewImpl.k].gain = gain;
+        updateEffectiveClipAttributes(clipViewImpl.position(), 1);
+        clipsVersion++;
+    }
+
+    void IClipSeriesPrivate::setClipPan(const ClipViewPrivate::ClipViewImpl &clipViewImpl, float pan) {
+        Q_ASSERT(clipViewImpl.isValid());
+        clipAttributesDict[clipViewImpl.k].pan = pan;
+        updateEffectiveClipAttributes(clipViewImpl.position(), 1);
+        clipsVersion++;
+    }
+
+    void IClipSeriesPrivate::setClipMute(const ClipViewPrivate::ClipViewImpl &clipViewImpl, bool isMute) {
+        Q_ASSERT(clipViewImpl.isValid());
+        clipAttributesDict[clipViewImpl.k].isMute = isMute;
+        updateEffectiveClipAttributes(clipViewImpl.position(), 1);
+        clipsVersion++;
+    }
+
     ClipViewPrivate::ClipViewImpl IClipSeriesPrivate::findClipByContent(void *content) const {
         return ClipViewPrivate::ClipViewImpl(this, clipKeyDict.value(content));
     }
@@ -121,10 +207,15 @@ namespace talcs {
         auto it = findClipIterator(pos, clipViewImpl.content());
         auto endPos = pos + it->interval().length();
         clips.erase(it);
+        effectiveClipAttributesDict.remove(clipViewImpl.content());
         clipPositionDict.remove(clipViewImpl.k);
         clipStartPosDict.remove(clipViewImpl.k);
+        clipAttributesDict.remove(clipViewImpl.k);
         clipContentSet.remove(clipContentDict.take(clipViewImpl.k));
-        endSet.erase(endPos);
+        positionSet.erase(positionSet.find(pos));
+        endSet.erase(endSet.find(endPos));
+        updateEffectiveClipAttributes(pos, endPos - pos);
+        clipsVersion++;
     }
 
     void IClipSeriesPrivate::removeAllClips() {
@@ -133,7 +224,11 @@ namespace talcs {
         clipStartPosDict.clear();
         clipContentDict.clear();
         clipContentSet.clear();
+        clipAttributesDict.clear();
+        effectiveClipAttributesDict.clear();
+        positionSet.clear();
         endSet.clear();
+        clipsVersion++;
     }
 
     QList<ClipViewPrivate::ClipViewImpl> IClipSeriesPrivate::clipViewImplList() const {
@@ -150,6 +245,74 @@ namespace talcs {
         return *endSet.rbegin();
     }
 
+    qint64 IClipSeriesPrivate::nextClipPosition(qint64 position) const {
+        bool isInClip = false;
+        clips.overlap_find_all({nullptr, position, 1}, [&](const ClipIntervalTree::const_iterator &) {
+            isInClip = true;
+            return false;
+        });
+        if (isInClip)
+            return position;
+        auto it = positionSet.upper_bound(position);
+        if (it == positionSet.end())
+            return std::numeric_limits<qint64>::max();
+        return *it;
+    }
+
+    static IClipSeriesPrivate::ClipAttributes computeEffectiveClipAttributes(const IClipSeriesPrivate *d, const IClipSeriesPrivate::ClipInterval &clip) {
+        auto attributes = d->clipAttributesDict.value(d->clipKeyDict.value(clip.content()));
+        if (!d->overlapCrossfadeEnabled || attributes.isMute)
+            return attributes;
+        auto clipEnd = clip.position() + clip.length();
+        // A clip that starts earlier and ends inside this clip is crossfaded with the head of this clip
+        d->clips.overlap_find_all({nullptr, clip.position(), 1}, [&](const IClipSeriesPrivate::ClipIntervalTree::const_iterator &it) {
+            auto other = it->interval();
+            auto otherEnd = other.position() + other.length();
+            if (other.position() < clip.position() && otherEnd < clipEnd && otherEnd - clip.position() > attributes.fadeInLength) {
+                attributes.fadeInLength = otherEnd - clip.position();
+                attributes.fadeInShape = d->overlapCrossfadeShape;
+            }
+            return true;
+        });
+        // A clip that starts inside this clip and ends later is crossfaded with the tail of this clip
+        d->clips.overlap_find_all({nullptr, clipEnd - 1, 1}, [&](const IClipSeriesPrivate::ClipIntervalTree::const_iterator &it) {
+            auto other = it->interval();
+            auto otherEnd = other.position() + other.length();
+            if (other.position() > clip.position() && otherEnd > clipEnd && clipEnd - other.position() > attributes.fadeOutLength) {
+                attributes.fadeOutLength = clipEnd - other.position();
+                attributes.fadeOutShape = d->overlapCrossfadeShape;
+            }
+            return true;
+        });
+        return attributes;
+    }
+
+    // The crossfades of a clip depend on the clips overlapping it, so they are computed when clips are changed instead
+    // of on every read. All clips overlapping the changed range are updated.
+    void IClipSeriesPrivate::updateEffectiveClipAttributes(qint64 position, qint64 length) {
+        qAsConst(clips).overlap_find_all({nullptr, position, qMax(1ll, length)}, [&](const ClipIntervalTree::const_iterator &it) {
+            effectiveClipAttributesDict.insert(it->interval().content(), computeEffectiveClipAttributes(this, it->interval()));
+            return true;
+        });
+    }
+
+    void IClipSeriesPrivate::updateAllEffectiveClipAttributes() {
+        for (auto p = clips.cbegin(); p != clips.cend(); p++)
+            effectiveClipAttributesDict.insert(p->interval().content(), computeEffectiveClipAttributes(this, p->interval()));
+    }
+
+    void IClipSeriesPrivate::setOverlapCrossfadeEnabled(bool enabled) {
+        overlapCrossfadeEnabled = enabled;
+        updateAllEffectiveClipAttributes();
+        clipsVersion++;
+    }
+
+    void IClipSeriesPrivate::setOverlapCrossfadeShape(FadeCurve::Shape shape) {
+        overlapCrossfadeShape = shape;
+        updateAllEffectiveClipAttributes();
+        clipsVersion++;
+    }
+
     IClipSeriesPrivate::ClipInterval IClipSeriesPrivate::intervalLookup(qint64 pos, void *content) const {
         return findClipIterator(pos, content)->interval();
     }
@@ -226,6 +389,41 @@ namespace talcs {
      * Gets the length of the clip.
      */
 
+    /**
+     * @fn qint64 IClipSeries::ClipView::fadeInLength() const
+     * Gets the length of the fade-in of the clip.
+     */
+
+    /**
+     * @fn FadeCurve::Shape IClipSeries::ClipView::fadeInShape() const
+     * Gets the shape of the fade-in of the clip.
+     */
+
+    /**
+     * @fn qint64 IClipSeries::ClipView::fadeOutLength() const
+     * Gets the length of the fade-out of the clip.
+     */
+
+    /**
+     * @fn FadeCurve::Shape IClipSeries::ClipView::fadeOutShape() const
+     * Gets the shape of the fade-out of the clip.
+     */
+
+    /**
+     * @fn float IClipSeries::ClipView::gain() const
+     * Gets the gain of the clip.
+     */
+
+    /**
+     * @fn float IClipSeries::ClipView::pan() const
+     * Gets the pan of the clip.
+     */
+
+    /**
+     * @fn bool IClipSeries::ClipView::isMute() const
+     * Gets whether the clip is muted.
+     */
+
     /**
      * @fn bool IClipSeries::ClipView::operator==(const IClipSeries::ClipView &other) const
      * Equal-to operator overloading.
@@ -262,6 +460,33 @@ namespace talcs {
      * If it fails (due to duplicated content or other reasons), false will be returned
      */
 
+    /**
+     * @fn void IClipSeries::setClipFadeIn(const IClipSeries::ClipView &clip, qint64 length, FadeCurve::Shape shape)
+     * Sets the fade-in of a clip. The fade starts at the beginning of the clip and lasts for @p length samples.
+     *
+     * The fade is applied while the clip is being read, so no additional gain stage is needed.
+     */
+
+    /**
+     * @fn void IClipSeries::setClipFadeOut(const IClipSeries::ClipView &clip, qint64 length, FadeCurve::Shape shape)
+     * Sets the fade-out of a clip. The fade ends at the end of the clip and lasts for @p length samples.
+     */
+
+    /**
+     * @fn void IClipSeries::setClipGain(const IClipSeries::ClipView &clip, float gain)
+     * Sets the gain of a clip. The gain is applied while the clip is added into the output of the series.
+     */
+
+    /**
+     * @fn void IClipSeries::setClipPan(const IClipSeries::ClipView &clip, float pan)
+     * Sets the pan of a clip. The pan is applied in the same way as IMixer::setPan().
+     */
+
+    /**
+     * @fn void IClipSeries::setClipMute(const IClipSeries::ClipView &clip, bool isMute)
+     * Sets whether a clip is muted. A muted clip is not read at all.
+     */
+
     /**
      * @fn IClipSeries::ClipView IClipSeries::findClip(T *content) const
      * Finds a clip by its content.
@@ -296,4 +521,29 @@ namespace talcs {
      * Gets the effective length (i.e. the ending position of the last clip).
      */
 
+    /**
+     * @fn void IClipSeries::setOverlapCrossfadeEnabled(bool enabled)
+     * Sets whether overlapping clips are crossfaded automatically.
+     *
+     * If enabled, when a clip starts inside another one and ends after it, the tail of the earlier clip fades out and
+     * the head of the later clip fades in over the overlapping range. The crossfade only takes effect when it is longer
+     * than the fade set on the clip.
+     * @see setOverlapCrossfadeShape()
+     */
+
+    /**
+     * @fn bool IClipSeries::isOverlapCrossfadeEnabled() const
+     * Gets whether overlapping clips are crossfaded automatically.
+     */
+
+    /**
+     * @fn void IClipSeries::setOverlapCrossfadeShape(FadeCurve::Shape shape)
+     * Sets the shape of the automatic crossfade. The default is FadeCurve::EqualPower.
+     */
+
+    /**
+     * @fn FadeCurve::Shape IClipSeries::overlapCrossfadeShape() const
+     * Gets the shape of the automatic crossfade.
+     */
+
 } // talcs
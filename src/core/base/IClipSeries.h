@@ -21,6 +21,7 @@
 #define TALCS_ICLIPSERIES_H
 
 #include <TalcsCore/TalcsCoreGlobal.h>
+#include <TalcsCore/FadeCurve.h>
 
 namespace talcs {
 
@@ -45,6 +46,15 @@ namespace talcs {
 
             qint64 length() const;
 
+            qint64 fadeInLength() const;
+            FadeCurve::Shape fadeInShape() const;
+            qint64 fadeOutLength() const;
+            FadeCurve::Shape fadeOutShape() const;
+
+            float gain() const;
+            float pan() const;
+            bool isMute() const;
+
             template<class ClipView>
             ClipViewImpl(const ClipView &clipView) : ClipViewImpl(clipView.m_impl) {
             }
@@ -90,6 +100,34 @@ namespace talcs {
                 return m_impl.length();
             }
 
+            qint64 fadeInLength() const {
+                return m_impl.fadeInLength();
+            }
+
+            FadeCurve::Shape fadeInShape() const {
+                return m_impl.fadeInShape();
+            }
+
+            qint64 fadeOutLength() const {
+                return m_impl.fadeOutLength();
+            }
+
+            FadeCurve::Shape fadeOutShape() const {
+                return m_impl.fadeOutShape();
+            }
+
+            float gain() const {
+                return m_impl.gain();
+            }
+
+            float pan() const {
+                return m_impl.pan();
+            }
+
+            bool isMute() const {
+                return m_impl.isMute();
+            }
+
             bool operator==(const ClipView &other) const {
                 return content() == other.content();
             }
@@ -106,6 +144,11 @@ namespace talcs {
         virtual void setClipStartPos(const ClipView &clip, qint64 startPos) = 0;
         virtual bool setClipRange(const ClipView &clip, qint64 position, qint64 length) = 0;
         virtual bool setClipContent(const ClipView &clip, T *content) = 0;
+        virtual void setClipFadeIn(const ClipView &clip, qint64 length, FadeCurve::Shape shape) = 0;
+        virtual void setClipFadeOut(const ClipView &clip, qint64 length, FadeCurve::Shape shape) = 0;
+        virtual void setClipGain(const ClipView &clip, float gain) = 0;
+        virtual void setClipPan(const ClipView &clip, float pan) = 0;
+        virtual void setClipMute(const ClipView &clip, bool isMute) = 0;
 
         virtual ClipView findClip(T *content) const = 0;
         virtual QList<ClipView> findClip(qint64 position) const = 0;
@@ -117,6 +160,11 @@ namespace talcs {
 
         virtual qint64 effectiveLength() const = 0;
 
+        virtual void setOverlapCrossfadeEnabled(bool enabled) = 0;
+        virtual bool isOverlapCrossfadeEnabled() const = 0;
+        virtual void setOverlapCrossfadeShape(FadeCurve::Shape shape) = 0;
+        virtual FadeCurve::Shape overlapCrossfadeShape() const = 0;
+
     protected:
         ~IClipSeries() = default;
 
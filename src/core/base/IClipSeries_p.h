@@ -22,6 +22,7 @@
 
 #include <set>
 #include <atomic>
+#include <limits>
 
 #include <QHash>
 #include <QSet>
@@ -53,6 +54,16 @@ namespace talcs {
             void *m_content;
         };
 
+        struct ClipAttributes {
+            qint64 fadeInLength = 0;
+            FadeCurve::Shape fadeInShape = FadeCurve::Linear;
+            qint64 fadeOutLength = 0;
+            FadeCurve::Shape fadeOutShape = FadeCurve::Linear;
+            float gain = 1;
+            float pan = 0;
+            bool isMute = false;
+        };
+
         using ClipIntervalTree = lib_interval_tree::interval_tree<ClipInterval>;
         ClipIntervalTree clips;
         QHash<qint64, qint64> clipPositionDict;
@@ -60,9 +71,18 @@ namespace talcs {
         QHash<qint64, void *> clipContentDict;
         QHash<void *, qint64> clipKeyDict;
         QSet<void *> clipContentSet;
-        std::set<qint64> endSet;
+        QHash<qint64, ClipAttributes> clipAttributesDict;
+        QHash<void *, ClipAttributes> effectiveClipAttributesDict;
+        std::multiset<qint64> positionSet;
+        std::multiset<qint64> endSet;
         std::atomic<qint64> clipViewKeyCounter = 0x10000;
 
+        bool overlapCrossfadeEnabled = false;
+        FadeCurve::Shape overlapCrossfadeShape = FadeCurve::EqualPower;
+
+        // Increased whenever the clips change
+        quint64 clipsVersion = 0;
+
         inline qint64 nextKey() {
             return clipViewKeyCounter++;
         }
@@ -71,6 +91,11 @@ namespace talcs {
         void setClipStartPos(const ClipViewPrivate::ClipViewImpl &clipViewImpl, qint64 startPos);
         bool setClipRange(const ClipViewPrivate::ClipViewImpl &clipViewImpl, qint64 position, qint64 length);
         bool setClipContent(const ClipViewPrivate::ClipViewImpl &clipViewImpl, void *content);
+        void setClipFadeIn(const ClipViewPrivate::ClipViewImpl &clipViewImpl, qint64 length, FadeCurve::Shape shape);
+        void setClipFadeOut(const ClipViewPrivate::ClipViewImpl &clipViewImpl, qint64 length, FadeCurve::Shape shape);
+        void setClipGain(const ClipViewPrivate::ClipViewImpl &clipViewImpl, float gain);
+        void setClipPan(const ClipViewPrivate::ClipViewImpl &clipViewImpl, float pan);
+        void setClipMute(const ClipViewPrivate::ClipViewImpl &clipViewImpl, bool isMute);
 
         ClipViewPrivate::ClipViewImpl findClipByContent(void *content) const;
         void findClipByPosition(qint64 position, const std::function<bool(const ClipViewPrivate::ClipViewImpl &)> &onFind) const;
@@ -81,6 +106,15 @@ namespace talcs {
         QList<ClipViewPrivate::ClipViewImpl> clipViewImplList() const;
 
         qint64 effectiveLength() const;
+        qint64 nextClipPosition(qint64 position) const;
+
+        inline ClipAttributes effectiveClipAttributes(const ClipInterval &clip) const {
+            return effectiveClipAttributesDict.value(clip.content());
+        }
+        void updateEffectiveClipAttributes(qint64 position, qint64 length);
+        void updateAllEffectiveClipAttributes();
+        void setOverlapCrossfadeEnabled(bool enabled);
+        void setOverlapCrossfadeShape(FadeCurve::Shape shape);
 
         IClipSeriesPrivate::ClipInterval intervalLookup(qint64 pos, void *content) const;
         IClipSeriesPrivate::ClipIntervalTree::iterator findClipIterator(qint64 pos, void * content);
@@ -20,12 +20,15 @@
 #ifndef TALCS_IMIXER_P_H
 #define TALCS_IMIXER_P_H
 
+#include <type_traits>
+
 #include <QHash>
 #include <QList>
 #include <QMutex>
 
 #include <TalcsCore/AudioBuffer.h>
 #include <TalcsCore/IMixer.h>
+#include <TalcsCore/PositionableAudioSource.h>
 
 namespace talcs {
 
@@ -52,7 +55,7 @@ namespace talcs {
         QHash<T *, SourceInfo<T>> sourceDict;
         std::list<T *> sourceList;
 
-        QMutex mutex;
+        mutable QMutex mutex;
 
         float gain = 1;
         float pan = 0;
@@ -197,6 +200,21 @@ namespace talcs {
                 auto srcInfo = sourceDict.value(src);
                 bool isMutedBySoloSetting = (soloCounter && !srcInfo.isSolo);
 
+                if constexpr (std::is_base_of_v<PositionableAudioSource, T>) {
+                    // The source is known to be empty in this block, so only move its read position
+                    auto srcPosition = src->nextReadPosition();
+                    if (src->isEmptyRange(srcPosition, readLength)) {
+                        src->setNextReadPosition(srcPosition + readLength);
+                        actualReadLength = qMax(readLength, actualReadLength);
+                        if (routeChannels) {
+                            if (routeCnt >= channelCount / 2)
+                                break;
+                            routeCnt++;
+                        }
+                        continue;
+                    }
+                }
+
                 if (sourceList.size() == 1) { // fast-read
                     IAudioSampleContainer *adoptedBuffer = readData.buffer->isContinuous() ? readData.buffer : &tmpBuf;
                     actualReadLength = src->read(AudioSourceReadData(adoptedBuffer, adoptedBuffer == readData.buffer ? readData.startPos : 0, readLength, isMutedBySoloSetting ? -1 : silentFlags));
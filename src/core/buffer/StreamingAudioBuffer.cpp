@@ -0,0 +1,119 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#include "StreamingAudioBuffer.h"
+#include "StreamingAudioBuffer_p.h"
+
+#include <algorithm>
+
+namespace talcs {
+
+    static constexpr qint64 CHUNK_SIZE = 16384;
+
+    /**
+     * @class StreamingAudioBuffer
+     * @brief A buffer of fixed length that is filled progressively by one thread while being read by others
+     *
+     * The producer appends audio with append(), and the samples before sampleCountAvailable() can be read from any
+     * thread at the same time. The samples after it read as silence. Memory is allocated in chunks as the audio grows,
+     * and appending never moves the samples already written, so no lock is needed.
+     *
+     * This is the growing buffer of a FutureAudioSource that is rendered progressively: wrap it in a MemoryAudioSource
+     * and set it as the streaming source of the FutureAudioSource. The producer reports the progress value of the future
+     * after appending, so that the progress never exceeds sampleCountAvailable().
+     * @see FutureAudioSource::setStreamingSource()
+     */
+
+    /**
+     * Constructor.
+     * @param channelCount the number of channels
+     * @param sampleCount the total length of the audio
+     */
+    StreamingAudioBuffer::StreamingAudioBuffer(int channelCount, qint64 sampleCount) : d(new StreamingAudioBufferPrivate) {
+        d->channelCount = channelCount;
+        d->sampleCount = qMax(0ll, sampleCount);
+        d->chunks.fill(nullptr, static_cast<int>((d->sampleCount + CHUNK_SIZE - 1) / CHUNK_SIZE));
+    }
+
+    StreamingAudioBuffer::~StreamingAudioBuffer() {
+        for (auto chunk : qAsConst(d->chunks))
+            delete[] chunk;
+    }
+
+    /**
+     * Gets a sample. Samples after sampleCountAvailable() are zero.
+     */
+    float StreamingAudioBuffer::sample(int channel, qint64 pos) const {
+        if (pos < 0 || pos >= d->sampleCountAvailable.loadAcquire())
+            return 0;
+        return d->chunks[static_cast<int>(pos / CHUNK_SIZE)][channel * CHUNK_SIZE + pos % CHUNK_SIZE];
+    }
+
+    int StreamingAudioBuffer::channelCount() const {
+        return d->channelCount;
+    }
+
+    /**
+     * Gets the total length of the audio, including the part that is not appended yet.
+     */
+    qint64 StreamingAudioBuffer::sampleCount() const {
+        return d->sampleCount;
+    }
+
+    /**
+     * Appends audio after the samples available. This function should be called from only one thread.
+     *
+     * Channels that @p src does not have are filled with silence.
+     * @return the number of samples appended, which is less than @p length if the buffer is full
+     */
+    qint64 StreamingAudioBuffer::append(const IAudioSampleProvider &src, qint64 srcStartPos, qint64 length) {
+        auto available = d->sampleCountAvailable.loadRelaxed();
+        length = qBound(0ll, length, d->sampleCount - available);
+        for (qint64 offset = 0; offset < length;) {
+            auto pos = available + offset;
+            auto &chunk = d->chunks[static_cast<int>(pos / CHUNK_SIZE)];
+            if (!chunk)
+                chunk = new float[d->channelCount * CHUNK_SIZE];
+            auto chunkOffset = pos % CHUNK_SIZE;
+            auto pieceLength = qMin(CHUNK_SIZE - chunkOffset, length - offset);
+            for (int ch = 0; ch < d->channelCount; ch++) {
+                auto dest = chunk + ch * CHUNK_SIZE + chunkOffset;
+                if (ch >= src.channelCount()) {
+                    std::fill_n(dest, pieceLength, 0.0f);
+                } else if (src.isContinuous()) {
+                    std::copy_n(src.readPointerTo(ch, srcStartPos + offset), pieceLength, dest);
+                } else {
+                    for (qint64 i = 0; i < pieceLength; i++)
+                        dest[i] = src.sample(ch, srcStartPos + offset + i);
+                }
+            }
+            offset += pieceLength;
+        }
+        d->sampleCountAvailable.storeRelease(available + length);
+        return length;
+    }
+
+    /**
+     * Gets the number of samples from the beginning that have been appended.
+     */
+    qint64 StreamingAudioBuffer::sampleCountAvailable() const {
+        return d->sampleCountAvailable.loadAcquire();
+    }
+
+}
@@ -0,0 +1,49 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#ifndef TALCS_STREAMINGAUDIOBUFFER_H
+#define TALCS_STREAMINGAUDIOBUFFER_H
+
+#include <QScopedPointer>
+
+#include <TalcsCore/IAudioSampleProvider.h>
+
+namespace talcs {
+
+    class StreamingAudioBufferPrivate;
+
+    class TALCSCORE_EXPORT StreamingAudioBuffer : public IAudioSampleProvider {
+    public:
+        StreamingAudioBuffer(int channelCount, qint64 sampleCount);
+        ~StreamingAudioBuffer() override;
+
+        float sample(int channel, qint64 pos) const override;
+        int channelCount() const override;
+        qint64 sampleCount() const override;
+
+        qint64 append(const IAudioSampleProvider &src, qint64 srcStartPos, qint64 length);
+        qint64 sampleCountAvailable() const;
+
+    private:
+        QScopedPointer<StreamingAudioBufferPrivate> d;
+    };
+
+}
+
+#endif // TALCS_STREAMINGAUDIOBUFFER_H
@@ -0,0 +1,41 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#ifndef TALCS_STREAMINGAUDIOBUFFER_P_H
+#define TALCS_STREAMINGAUDIOBUFFER_P_H
+
+#include <QAtomicInteger>
+#include <QVector>
+
+#include <TalcsCore/StreamingAudioBuffer.h>
+
+namespace talcs {
+
+    class StreamingAudioBufferPrivate {
+    public:
+        int channelCount;
+        qint64 sampleCount;
+        // Allocated by the producer as the audio grows, and never moved, so that samples can be read while appending
+        QVector<float *> chunks;
+        QAtomicInteger<qint64> sampleCountAvailable = 0;
+    };
+
+}
+
+#endif // TALCS_STREAMINGAUDIOBUFFER_P_H
@@ -59,16 +59,21 @@ namespace talcs {
             readData.buffer->clear(ch, readData.startPos, readData.length);
         }
         QMutexLocker locker(&d->mutex);
+        d->maintainOpenWindow(d->position);
         qAsConst(d->clips).overlap_find_all(
             readDataInterval, [=](const decltype(d->clips)::const_iterator &it) {
                 auto clip = it->interval();
+                auto attributes = d->effectiveClipAttributes(clip);
+                if (attributes.isMute)
+                    return true;
+                if (!d->ensureClipOpen(clip.content()))
+                    return true;
                 auto [clipReadPosition, clipReadData] =
                     d->calculateClipReadData(clip, d->position, readData);
                 auto clipSrc = static_cast<PositionableAudioSource *>(clip.content());
                 clipSrc->setNextReadPosition(clipReadPosition);
                 clipSrc->read(clipReadData);
-                for (int ch = 0; ch < readData.buffer->channelCount(); ch++)
-                    readData.buffer->addSampleRange(ch, readData.startPos, readData.length, d->buf, ch, 0);
+                d->mixClip(clip, attributes, d->position, clipReadData, readData);
                 return true;
             });
         d->position += readData.length;
@@ -85,6 +90,7 @@ namespace talcs {
         Q_D(AudioSourceClipSeries);
         QMutexLocker locker(&d->mutex);
         d->position = pos;
+        d->maintainOpenWindow(pos);
     }
 
     /**
@@ -120,7 +126,10 @@ namespace talcs {
         QMutexLocker locker(&d->mutex);
         if (!d->preInsertClip(content))
             return {};
-        return d->insertClip(content, position, startPos, length);
+        auto ret = d->insertClip(content, position, startPos, length);
+        if (!ret.isNull())
+            d->propagateLoopingRangeHint(content);
+        return ret;
     }
 
     void AudioSourceClipSeries::setClipStartPos(const AudioSourceClipSeries::ClipView &clip,
@@ -128,13 +137,17 @@ namespace talcs {
         Q_D(AudioSourceClipSeries);
         QMutexLocker locker(&d->mutex);
         d->setClipStartPos(clip, startPos);
+        d->propagateLoopingRangeHint(clip.content());
     }
 
     bool AudioSourceClipSeries::setClipRange(const AudioSourceClipSeries::ClipView &clip, qint64 position,
                                              qint64 length) {
         Q_D(AudioSourceClipSeries);
         QMutexLocker locker(&d->mutex);
-        return d->setClipRange(clip, position, length);
+        if (!d->setClipRange(clip, position, length))
+            return false;
+        d->propagateLoopingRangeHint(clip.content());
+        return true;
     }
 
     bool AudioSourceClipSeries::setClipContent(const AudioSourceClipSeries::ClipView &clip,
@@ -143,7 +156,43 @@ namespace talcs {
         QMutexLocker locker(&d->mutex);
         if (!d->preInsertClip(content))
             return false;
-        return d->setClipContent(clip, content);
+        auto oldContent = clip.content();
+        if (!d->setClipContent(clip, content))
+            return false;
+        if (oldContent != content)
+            d->forgetClip(oldContent);
+        d->propagateLoopingRangeHint(content);
+        return true;
+    }
+
+    void AudioSourceClipSeries::setClipFadeIn(const AudioSourceClipSeries::ClipView &clip, qint64 length, FadeCurve::Shape shape) {
+        Q_D(AudioSourceClipSeries);
+        QMutexLocker locker(&d->mutex);
+        d->setClipFadeIn(clip, length, shape);
+    }
+
+    void AudioSourceClipSeries::setClipFadeOut(const AudioSourceClipSeries::ClipView &clip, qint64 length, FadeCurve::Shape shape) {
+        Q_D(AudioSourceClipSeries);
+        QMutexLocker locker(&d->mutex);
+        d->setClipFadeOut(clip, length, shape);
+    }
+
+    void AudioSourceClipSeries::setClipGain(const AudioSourceClipSeries::ClipView &clip, float gain) {
+        Q_D(AudioSourceClipSeries);
+        QMutexLocker locker(&d->mutex);
+        d->setClipGain(clip, gain);
+    }
+
+    void AudioSourceClipSeries::setClipPan(const AudioSourceClipSeries::ClipView &clip, float pan) {
+        Q_D(AudioSourceClipSeries);
+        QMutexLocker locker(&d->mutex);
+        d->setClipPan(clip, pan);
+    }
+
+    void AudioSourceClipSeries::setClipMute(const AudioSourceClipSeries::ClipView &clip, bool isMute) {
+        Q_D(AudioSourceClipSeries);
+        QMutexLocker locker(&d->mutex);
+        d->setClipMute(clip, isMute);
     }
 
     AudioSourceClipSeries::ClipView
@@ -165,12 +214,14 @@ namespace talcs {
     void AudioSourceClipSeries::removeClip(const AudioSourceClipSeries::ClipView &clip) {
         Q_D(AudioSourceClipSeries);
         QMutexLocker locker(&d->mutex);
+        d->forgetClip(clip.content());
         d->removeClip(clip);
     }
 
     void AudioSourceClipSeries::removeAllClips() {
         Q_D(AudioSourceClipSeries);
         QMutexLocker locker(&d->mutex);
+        d->forgetAllClips();
         d->removeAllClips();
     }
 
@@ -187,4 +238,109 @@ namespace talcs {
         return d->effectiveLength();
     }
 
+    /**
+     * @copydoc PositionableAudioSource::nextNonEmptyPosition()
+     *
+     * The series is considered empty where there are no clips. Muted clips are still considered non-empty.
+     */
+    qint64 AudioSourceClipSeries::nextNonEmptyPosition(qint64 position) const {
+        Q_D(const AudioSourceClipSeries);
+        QMutexLocker locker(&d->mutex);
+        return d->nextClipPosition(position);
+    }
+
+    /**
+     * @copydoc PositionableAudioSource::contentVersion()
+     *
+     * The version changes when the clips change, or when the content of any clip changes.
+     */
+    quint64 AudioSourceClipSeries::contentVersion() const {
+        Q_D(const AudioSourceClipSeries);
+        QMutexLocker locker(&d->mutex);
+        return d->seriesContentVersion();
+    }
+
+    void AudioSourceClipSeries::setOverlapCrossfadeEnabled(bool enabled) {
+        Q_D(AudioSourceClipSeries);
+        QMutexLocker locker(&d->mutex);
+        d->setOverlapCrossfadeEnabled(enabled);
+    }
+
+    bool AudioSourceClipSeries::isOverlapCrossfadeEnabled() const {
+        Q_D(const AudioSourceClipSeries);
+        return d->overlapCrossfadeEnabled;
+    }
+
+    void AudioSourceClipSeries::setOverlapCrossfadeShape(FadeCurve::Shape shape) {
+        Q_D(AudioSourceClipSeries);
+        QMutexLocker locker(&d->mutex);
+        d->setOverlapCrossfadeShape(shape);
+    }
+
+    FadeCurve::Shape AudioSourceClipSeries::overlapCrossfadeShape() const {
+        Q_D(const AudioSourceClipSeries);
+        return d->overlapCrossfadeShape;
+    }
+
+    /**
+     * Sets the size of the window around the read position in which clips are kept open.
+     *
+     * By default (0), all clips are opened when the series is opened. If set to a positive value, only clips that
+     * overlap the range of @p size samples before and after the read position, or the beginning of the looping range
+     * hinted by setLoopingRangeHint(), are open. Clips entering the window are opened ahead of need and clips leaving it
+     * are closed by a worker thread of the series. The reading thread never opens a clip or waits for it: if a clip to
+     * read is not open yet, it is silent in that read, opened by the worker first, and counted in
+     * synchronousOpenCount().
+     *
+     * This bounds the file handles and memory held by clips in large series.
+     */
+    void AudioSourceClipSeries::setOpenWindowSize(qint64 size) {
+        Q_D(AudioSourceClipSeries);
+        QMutexLocker locker(&d->mutex);
+        d->setOpenWindowSize(size);
+        d->maintainOpenWindow(d->position);
+    }
+
+    /**
+     * Gets the size of the window in which clips are kept open.
+     * @see setOpenWindowSize()
+     */
+    qint64 AudioSourceClipSeries::openWindowSize() const {
+        Q_D(const AudioSourceClipSeries);
+        return d->openWindowSize;
+    }
+
+    /**
+     * Gets the number of clips that were not open yet when they were read, and thus were skipped.
+     *
+     * A growing count means that the open window is too small for the speed at which the read position moves.
+     * @see setOpenWindowSize()
+     */
+    qint64 AudioSourceClipSeries::synchronousOpenCount() const {
+        Q_D(const AudioSourceClipSeries);
+        return d->synchronousOpenCount.loadRelaxed();
+    }
+
+    /**
+     * Resets the number of clips skipped since they were not open to zero.
+     */
+    void AudioSourceClipSeries::resetSynchronousOpenCount() {
+        Q_D(AudioSourceClipSeries);
+        d->synchronousOpenCount.storeRelaxed(0);
+    }
+
+    /**
+     * @copydoc PositionableAudioSource::setLoopingRangeHint()
+     *
+     * Clips at the beginning of the looping range are kept open, and the range is propagated to the clip in which it
+     * starts.
+     * @see setOpenWindowSize()
+     */
+    void AudioSourceClipSeries::setLoopingRangeHint(qint64 l, qint64 r) {
+        Q_D(AudioSourceClipSeries);
+        QMutexLocker locker(&d->mutex);
+        d->setLoopingRangeHint(l, r);
+        d->maintainOpenWindow(d->position);
+    }
+
 }
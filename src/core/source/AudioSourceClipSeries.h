@@ -35,6 +35,8 @@ namespace talcs {
         AudioSourceClipSeries();
         ~AudioSourceClipSeries() override;
         qint64 length() const override;
+        qint64 nextNonEmptyPosition(qint64 position) const override;
+        quint64 contentVersion() const override;
         qint64 nextReadPosition() const override;
         void setNextReadPosition(qint64 pos) override;
         bool open(qint64 bufferSize, double sampleRate) override;
@@ -44,12 +46,28 @@ namespace talcs {
         void setClipStartPos(const ClipView &clip, qint64 startPos) override;
         bool setClipRange(const ClipView &clip, qint64 position, qint64 length) override;
         bool setClipContent(const ClipView &clip, PositionableAudioSource *content) override;
+        void setClipFadeIn(const ClipView &clip, qint64 length, FadeCurve::Shape shape) override;
+        void setClipFadeOut(const ClipView &clip, qint64 length, FadeCurve::Shape shape) override;
+        void setClipGain(const ClipView &clip, float gain) override;
+        void setClipPan(const ClipView &clip, float pan) override;
+        void setClipMute(const ClipView &clip, bool isMute) override;
         ClipView findClip(PositionableAudioSource *content) const override;
         QList<ClipView> findClip(qint64 position) const override;
         void removeClip(const ClipView &clip) override;
         void removeAllClips() override;
         QList<ClipView> clips() const override;
         qint64 effectiveLength() const override;
+        void setOverlapCrossfadeEnabled(bool enabled) override;
+        bool isOverlapCrossfadeEnabled() const override;
+        void setOverlapCrossfadeShape(FadeCurve::Shape shape) override;
+        FadeCurve::Shape overlapCrossfadeShape() const override;
+
+        void setOpenWindowSize(qint64 size);
+        qint64 openWindowSize() const;
+        qint64 synchronousOpenCount() const;
+        void resetSynchronousOpenCount();
+
+        void setLoopingRangeHint(qint64 l, qint64 r) override;
 
     protected:
         explicit AudioSourceClipSeries(AudioSourceClipSeriesPrivate &d);
@@ -21,12 +21,20 @@
 #define TALCS_AUDIOSOURCECLIPSERIES_P_H
 
 #include <algorithm>
+#include <limits>
 
+#include <QAtomicInteger>
+#include <QHash>
 #include <QMutex>
+#include <QSemaphore>
+#include <QThread>
+#include <QWaitCondition>
 
 #include <TalcsCore/AudioBuffer.h>
+#include <TalcsCore/FadeCurve.h>
 #include <TalcsCore/AudioSourceClipSeries.h>
 #include <TalcsCore/private/IClipSeries_p.h>
+#include <TalcsCore/private/IMixer_p.h>
 #include <TalcsCore/private/PositionableAudioSource_p.h>
 
 namespace talcs {
@@ -37,8 +45,34 @@ namespace talcs {
         explicit AudioSourceClipSeriesBase(SeriesClassPrivate *d): d(d) {
         }
 
+        ~AudioSourceClipSeriesBase() {
+            if (!openWorkerThread)
+                return;
+            isOpenWorkerQuitRequested = true;
+            openRequestSemaphore.release();
+            openWorkerThread->wait();
+            delete openWorkerThread;
+        }
+
         bool openAllClips(qint64 bufferSize, double sampleRate) {
             buf.resize(2, bufferSize);
+            {
+                QMutexLocker locker(&openStateMutex);
+                openBufferSize = bufferSize;
+                openSampleRate = sampleRate;
+            }
+            if (openWindowSize > 0) {
+                lastMaintainedPosition = d->position;
+                for (auto p = d->clips.begin(); p != d->clips.end(); p++) {
+                    if (!isInOpenWindow(p->interval(), d->position))
+                        continue;
+                    if (!static_cast<SourceClass *>(p->interval().content())->open(bufferSize, sampleRate))
+                        return false;
+                    QMutexLocker locker(&openStateMutex);
+                    clipOpenStates.insert(p->interval().content(), ClipOpen);
+                }
+                return true;
+            }
             for (auto p = d->clips.begin(); p != d->clips.end(); p++) {
                 if (!static_cast<SourceClass *>(p->interval().content())->open(bufferSize, sampleRate))
                     return false;
@@ -48,6 +82,16 @@ namespace talcs {
 
         void closeAllClips() {
             buf.resize(0, 0);
+            if (openWindowSize > 0) {
+                QMutexLocker locker(&openStateMutex);
+                drainOpenQueue();
+                for (auto it = clipOpenStates.cbegin(); it != clipOpenStates.cend(); it++) {
+                    if (it.value() == ClipOpen)
+                        static_cast<SourceClass *>(it.key())->close();
+                }
+                clipOpenStates.clear();
+                return;
+            }
             for (auto p = d->clips.begin(); p != d->clips.end(); p++) {
                 static_cast<SourceClass *>(p->interval().content())->close();
             }
@@ -55,6 +99,11 @@ namespace talcs {
 
         bool preInsertClip(SourceClass *src) {
             if (d->q_ptr->isOpen()) {
+                if (openWindowSize > 0) {
+                    // Opened by the next maintenance if the clip falls into the window
+                    lastMaintainedPosition = std::numeric_limits<qint64>::min();
+                    return true;
+                }
                 if (!src->open(d->q_ptr->bufferSize(), d->q_ptr->sampleRate())) {
                     return false;
                 }
@@ -62,6 +111,219 @@ namespace talcs {
             return true;
         }
 
+        enum ClipOpenState {
+            ClipOpening,
+            ClipOpen,
+            ClipClosing,
+        };
+
+        qint64 openWindowSize = 0;
+        qint64 lastMaintainedPosition = std::numeric_limits<qint64>::min();
+
+        QMutex openStateMutex;
+        QWaitCondition openStateChanged;
+        QHash<void *, ClipOpenState> clipOpenStates;
+        QList<void *> openQueue;
+        void *busyClip = nullptr;
+        qint64 openBufferSize = 0;
+        double openSampleRate = 0;
+        QAtomicInteger<qint64> synchronousOpenCount = 0;
+
+        // Clips are opened and closed by a worker thread of the series, which the reading thread only signals
+        QThread *openWorkerThread = nullptr;
+        QSemaphore openRequestSemaphore;
+        QAtomicInteger<bool> isOpenWorkerQuitRequested = false;
+
+        bool isInOpenWindow(const IClipSeriesPrivate::ClipInterval &clip, qint64 position) const {
+            auto clipEnd = clip.position() + clip.length();
+            auto overlaps = [&](qint64 l, qint64 r) {
+                return clip.position() < r && clipEnd > l;
+            };
+            if (overlaps(position - openWindowSize, position + openWindowSize))
+                return true;
+            if (d->loopingStartHint >= 0 && d->loopingEndHint > d->loopingStartHint)
+                return overlaps(d->loopingStartHint, qMin(d->loopingEndHint, d->loopingStartHint + openWindowSize));
+            return false;
+        }
+
+        void setOpenWindowSize(qint64 size) {
+            size = qMax(0ll, size);
+            if (size == openWindowSize)
+                return;
+            if (size > 0 && !openWorkerThread) {
+                openWorkerThread = QThread::create([this] { runOpenWorker(); });
+                openWorkerThread->start();
+            }
+            if (d->q_ptr->isOpen()) {
+                QMutexLocker locker(&openStateMutex);
+                if (openWindowSize == 0) {
+                    // All clips are open now. Those out of the window will be closed by the next maintenance.
+                    for (auto p = d->clips.begin(); p != d->clips.end(); p++)
+                        clipOpenStates.insert(p->interval().content(), ClipOpen);
+                } else if (size == 0) {
+                    drainOpenQueue();
+                    for (auto p = d->clips.begin(); p != d->clips.end(); p++) {
+                        auto content = p->interval().content();
+                        if (!clipOpenStates.contains(content))
+                            static_cast<SourceClass *>(content)->open(d->q_ptr->bufferSize(), d->q_ptr->sampleRate());
+                    }
+                    clipOpenStates.clear();
+                }
+            }
+            openWindowSize = size;
+            lastMaintainedPosition = std::numeric_limits<qint64>::min();
+        }
+
+        void setLoopingRangeHint(qint64 l, qint64 r) {
+            d->loopingStartHint = l;
+            d->loopingEndHint = r;
+            lastMaintainedPosition = std::numeric_limits<qint64>::min();
+            for (auto p = d->clips.begin(); p != d->clips.end(); p++)
+                propagateLoopingRangeHint(p->interval().content());
+        }
+
+        quint64 seriesContentVersion() const {
+            auto version = d->clipsVersion;
+            for (auto p = d->clips.begin(); p != d->clips.end(); p++)
+                version = combineContentVersion(version, static_cast<SourceClass *>(p->interval().content())->contentVersion());
+            return version;
+        }
+
+        // Maps the looping range into the clip, if the looping range starts within it
+        void propagateLoopingRangeHint(void *content) {
+            auto k = d->clipKeyDict.value(content);
+            auto clip = d->intervalLookup(d->clipPositionDict.value(k), content);
+            auto clipEnd = clip.position() + clip.length();
+            auto src = static_cast<SourceClass *>(content);
+            if (d->loopingStartHint < 0 || d->loopingStartHint < clip.position() || d->loopingStartHint >= clipEnd) {
+                src->setLoopingRangeHint(-1, -1);
+                return;
+            }
+            auto startPos = d->clipStartPosDict.value(k);
+            src->setLoopingRangeHint(startPos + d->loopingStartHint - clip.position(),
+                                     startPos + qMin(d->loopingEndHint, clipEnd) - clip.position());
+        }
+
+        void maintainOpenWindow(qint64 position) {
+            if (openWindowSize == 0 || !d->q_ptr->isOpen())
+                return;
+            if (lastMaintainedPosition != std::numeric_limits<qint64>::min() && qAbs(position - lastMaintainedPosition) < openWindowSize / 4)
+                return;
+            lastMaintainedPosition = position;
+            QMutexLocker locker(&openStateMutex);
+            for (auto it = clipOpenStates.begin(); it != clipOpenStates.end(); it++) {
+                if (it.value() != ClipOpen)
+                    continue;
+                auto k = d->clipKeyDict.value(it.key());
+                if (isInOpenWindow(d->intervalLookup(d->clipPositionDict.value(k), it.key()), position))
+                    continue;
+                it.value() = ClipClosing;
+                openQueue.append(it.key());
+            }
+            auto requestOpen = [&](const typename IClipSeriesPrivate::ClipIntervalTree::const_iterator &it) {
+                auto content = it->interval().content();
+                auto stateIt = clipOpenStates.find(content);
+                if (stateIt == clipOpenStates.end()) {
+                    clipOpenStates.insert(content, ClipOpening);
+                    openQueue.append(content);
+                } else if (stateIt.value() == ClipClosing && busyClip != content) {
+                    stateIt.value() = ClipOpen;
+                    openQueue.removeOne(content);
+                }
+                return true;
+            };
+            qAsConst(d->clips).overlap_find_all({nullptr, position - openWindowSize, 2 * openWindowSize}, requestOpen);
+            if (d->loopingStartHint >= 0 && d->loopingEndHint > d->loopingStartHint)
+                qAsConst(d->clips).overlap_find_all({nullptr, d->loopingStartHint, qMin(d->loopingEndHint - d->loopingStartHint, openWindowSize)}, requestOpen);
+            if (!openQueue.isEmpty())
+                openRequestSemaphore.release();
+        }
+
+        void runOpenWorker() {
+            for (;;) {
+                openRequestSemaphore.acquire(qMax(1, openRequestSemaphore.available()));
+                if (isOpenWorkerQuitRequested)
+                    return;
+                QMutexLocker locker(&openStateMutex);
+                while (!openQueue.isEmpty()) {
+                    auto content = openQueue.takeFirst();
+                    auto state = clipOpenStates.value(content);
+                    busyClip = content;
+                    auto bufferSize = openBufferSize;
+                    auto sampleRate = openSampleRate;
+                    locker.unlock();
+                    bool isOpen = false;
+                    if (state == ClipOpening)
+                        isOpen = static_cast<SourceClass *>(content)->open(bufferSize, sampleRate);
+                    else
+                        static_cast<SourceClass *>(content)->close();
+                    locker.relock();
+                    busyClip = nullptr;
+                    if (isOpen)
+                        clipOpenStates.insert(content, ClipOpen);
+                    else
+                        clipOpenStates.remove(content);
+                    openStateChanged.wakeAll();
+                }
+            }
+        }
+
+        // Runs on the reading thread, which neither opens a clip nor waits for it to be opened. A clip that is not open
+        // yet is moved to the front of the open queue, and skipped in this read.
+        bool ensureClipOpen(void *content) {
+            if (openWindowSize == 0)
+                return true;
+            QMutexLocker locker(&openStateMutex);
+            auto stateIt = clipOpenStates.find(content);
+            if (stateIt == clipOpenStates.end()) {
+                clipOpenStates.insert(content, ClipOpening);
+                openQueue.prepend(content);
+            } else if (busyClip != content) {
+                if (stateIt.value() == ClipOpen)
+                    return true;
+                openQueue.removeOne(content);
+                if (stateIt.value() == ClipClosing) {
+                    stateIt.value() = ClipOpen;
+                    return true;
+                }
+                openQueue.prepend(content);
+            }
+            openRequestSemaphore.release();
+            synchronousOpenCount.fetchAndAddRelaxed(1);
+            return false;
+        }
+
+        void forgetClip(void *content) {
+            if (openWindowSize == 0)
+                return;
+            QMutexLocker locker(&openStateMutex);
+            while (busyClip == content)
+                openStateChanged.wait(&openStateMutex);
+            openQueue.removeAll(content);
+            clipOpenStates.remove(content);
+        }
+
+        void forgetAllClips() {
+            if (openWindowSize == 0)
+                return;
+            QMutexLocker locker(&openStateMutex);
+            drainOpenQueue();
+            clipOpenStates.clear();
+        }
+
+        // openStateMutex must be locked
+        void drainOpenQueue() {
+            for (auto content : qAsConst(openQueue)) {
+                if (clipOpenStates.value(content) == ClipOpening)
+                    clipOpenStates.remove(content);
+                else
+                    clipOpenStates.insert(content, ClipOpen);
+            }
+            openQueue.clear();
+            while (busyClip)
+                openStateChanged.wait(&openStateMutex);
+        }
+
         QPair<qint64, AudioSourceReadData> calculateClipReadData(const IClipSeriesPrivate::ClipInterval &clip, qint64 seriesPosition,
                                                                         const AudioSourceReadData &seriesReadData) {
             auto contentLength = static_cast<SourceClass *>(clip.content())->length();
@@ -76,12 +338,43 @@ namespace talcs {
                 buf.resize(seriesReadData.buffer->channelCount(), -1);
             return {clipReadPosition, {
                     &buf,
-                    readStart + seriesReadData.startPos,
+                    readStart,
                     qMax(0ll, corrLen - headCut - tailCut),
                     seriesReadData.silentFlags,
             }};
         }
 
+        void mixClip(const IClipSeriesPrivate::ClipInterval &clip, const IClipSeriesPrivate::ClipAttributes &attributes,
+                     qint64 seriesPosition, const AudioSourceReadData &clipReadData,
+                     const AudioSourceReadData &seriesReadData) {
+            auto channelCount = seriesReadData.buffer->channelCount();
+            auto from = seriesPosition + clipReadData.startPos;
+            auto to = from + clipReadData.length;
+            if (attributes.fadeInLength > 0) {
+                auto fadeFrom = qMax(from, clip.position());
+                auto fadeTo = qMin(to, clip.position() + attributes.fadeInLength);
+                for (int ch = 0; fadeFrom < fadeTo && ch < channelCount; ch++)
+                    FadeCurve::multiply(buf.data(ch) + (fadeFrom - seriesPosition), fadeTo - fadeFrom,
+                                        double(fadeFrom - clip.position()) / double(attributes.fadeInLength),
+                                        1.0 / double(attributes.fadeInLength), attributes.fadeInShape);
+            }
+            if (attributes.fadeOutLength > 0) {
+                auto clipEnd = clip.position() + clip.length();
+                auto fadeFrom = qMax(from, clipEnd - attributes.fadeOutLength);
+                auto fadeTo = qMin(to, clipEnd);
+                for (int ch = 0; fadeFrom < fadeTo && ch < channelCount; ch++)
+                    FadeCurve::multiply(buf.data(ch) + (fadeFrom - seriesPosition), fadeTo - fadeFrom,
+                                        double(clipEnd - fadeFrom) / double(attributes.fadeOutLength),
+                                        -1.0 / double(attributes.fadeOutLength), attributes.fadeOutShape);
+            }
+            auto gainLeftRight = applyGainAndPan(attributes.gain, attributes.pan);
+            for (int ch = 0; ch < channelCount; ch++) {
+                auto gainCh = ch == 0 ? gainLeftRight.first : ch == 1 ? gainLeftRight.second : attributes.gain;
+                seriesReadData.buffer->addSampleRange(ch, seriesReadData.startPos + clipReadData.startPos,
+                                                      clipReadData.length, buf, ch, clipReadData.startPos, gainCh);
+            }
+        }
+
         AudioBuffer buf;
 
     private:
@@ -92,7 +385,7 @@ namespace talcs {
         Q_DECLARE_PUBLIC(AudioSourceClipSeries);
     public:
         AudioSourceClipSeriesPrivate();
-        QMutex mutex;
+        mutable QMutex mutex;
     };
     
 }
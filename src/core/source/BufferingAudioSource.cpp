@@ -20,14 +20,50 @@
 #include "BufferingAudioSource.h"
 #include "BufferingAudioSource_p.h"
 
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
 #include <QDebug>
+#include <QHash>
+#include <QThread>
 #include <QThreadPool>
 
+#include <TalcsCore/AudioCacheBudget.h>
+
 namespace talcs {
 
     /**
      * @class BufferingAudioSource
      * @brief Buffering when reading from a PositionableAudioSource
+     *
+     * The audio is read ahead by a buffering task in a thread pool, and stored in a single-producer/single-consumer ring
+     * buffer. Reading from the ring buffer does not wait for the buffering task unless the buffered data is not
+     * enough. Repositioning does not terminate the buffering task either: the buffered data is discarded and the
+     * source is repositioned by the buffering task itself.
+     *
+     * The reader never waits for the mutex of this object, which is held by the functions that change the settings or
+     * the source (and by AudioCacheBudget when it installs resized buffers, which are allocated without the mutex). If
+     * the mutex is held by another thread when a block is read, the block is treated as an underrun: it is silent and
+     * skipped, and the reader catches up on the next read. Only with the Wait underrun policy does the reader wait for
+     * the mutex instead. The buffering task never takes this mutex.
+     *
+     * The buffering tasks of all sources that use the same thread pool are scheduled together. The source closest to
+     * underrun, i.e. with the least buffered audio relative to its consumption rate, is always buffered first, and each
+     * turn reads a batch of consecutive blocks from the same source, followed by the other sources waiting in the same
+     * I/O group (see setIoGroup()). The reading thread hands a source over to the scheduler without locking, and a
+     * dispatcher thread of the scheduler starts the thread pool tasks. The thread pool must outlive the sources using it.
+     *
+     * Besides the ring buffer, the audio read is recorded into cache windows: one at the beginning of the looping range
+     * hinted by setLoopingRangeHint(), and the others after the most recent seeks. Seeking into a cache window costs
+     * nothing, since the audio is read from the window while the ring buffer is refilled from the end of the window.
+     * The windows are discarded once the content version of the source changes (see
+     * PositionableAudioSource::contentVersion()), so that changes to the source are not masked by the audio cached.
+     *
+     * The buffers are accounted by AudioCacheBudget::globalInstance(). Under a limited budget, the ring buffer and the
+     * cache windows of sources far from the playhead are shrunk. The ring buffer is resized on the next seek, so that the
+     * audio buffered is not discarded.
+     * @see schedulerStatistics(), setSeekCacheWindowCount()
      */
 
     /**
@@ -59,52 +95,78 @@ namespace talcs {
         d->readAheadSize = readAheadSize;
         d->autoBuffering = autoBuffering;
         d->threadPool = threadPool ? threadPool : BufferingAudioSource::threadPool();
+        d->scheduler = BufferingAudioSourceScheduler::of(d->threadPool);
 
         d->headPosition = 0;
         d->tailPosition = 0;
+        d->generation = 0;
+        d->bufferGeneration = 0;
+        d->seekPosition = 0;
+        d->effectiveReadAheadSize = readAheadSize;
+
+        AudioCacheBudget::globalInstance()->registerClient(this);
     }
 
     /**
      * Destructor.
      */
     BufferingAudioSource::~BufferingAudioSource() {
+        AudioCacheBudget::globalInstance()->unregisterClient(this);
         BufferingAudioSource::close();
     }
 
     qint64 BufferingAudioSource::processReading(const AudioSourceReadData &readData) {
         Q_D(BufferingAudioSource);
-        QMutexLocker locker(&d->mutex);
+        if (!d->mutex.tryLock()) {
+            if (d->underrunPolicy.loadRelaxed() != Wait) {
+                // The settings or the source are being changed. The block is skipped without touching them.
+                d->underrunCount.fetchAndAddRelaxed(1);
+                for (int ch = 0; ch < readData.buffer->channelCount(); ch++)
+                    readData.buffer->clear(ch, readData.startPos, readData.length);
+                d->skippedLength.fetchAndAddRelaxed(readData.length);
+                return readData.length;
+            }
+            d->mutex.lock();
+        }
+        std::unique_lock<QRecursiveMutex> locker(d->mutex, std::adopt_lock);
         Q_ASSERT(isOpen());
+        if (auto skippedLength = d->skippedLength.fetchAndStoreRelaxed(0))
+            d->skip(skippedLength);
         if (d->readAheadSize <= bufferSize()) {
             return d->src->read(readData);
         }
-        int channelCount = qMin(readData.buffer->channelCount(), d->channelCount);
-        {
-            QMutexLocker readLocker(&d->bufLock);
-            qint64 head = d->headPosition;
-            qint64 tail = d->tailPosition;
-            if (tail - head >= readData.length) {
-                readFromBuffer:
-                for (int ch = 0; ch < channelCount; ch++) {
-                    readData.buffer->setSampleRange(ch, readData.startPos, readData.length, d->buf, ch, head);
-                }
-                for (int ch = channelCount; ch < readData.buffer->channelCount(); ch++) {
-                    readData.buffer->clear(ch, readData.startPos, readData.length);
-                }
+        d->updateConsumptionRate(readData.length);
+        auto windowReadLength = d->readFromCacheWindow(readData);
+        if (windowReadLength == readData.length)
+            return readData.length;
+        AudioSourceReadData ringReadData(readData.buffer, readData.startPos + windowReadLength, readData.length - windowReadLength);
+        auto availableLength = d->bufferedLength();
+        if (availableLength < d->minimumBufferedLength.loadRelaxed())
+            d->minimumBufferedLength.storeRelaxed(availableLength);
+        d->adaptReadAheadSize(availableLength, availableLength < ringReadData.length);
+        if (availableLength < ringReadData.length) {
+            d->underrunCount.fetchAndAddRelaxed(1);
+            if (d->underrunPolicy.loadRelaxed() == Wait) {
+                d->waitForBufferedData(ringReadData.length);
             } else {
-                readLocker.unlock();
-                d->accelerateCurrentBufferingTaskAndWait();
-                readLocker.relock();
-                head = d->headPosition;
-                tail = d->tailPosition;
-                Q_ASSERT(tail - head >= readData.length);
-                goto readFromBuffer;
+                // Do not wait. The missing part is silent and skipped.
+                auto readLength = d->underrunPolicy.loadRelaxed() == PartialData ? availableLength : 0;
+                d->readFromBuffer(ringReadData, readLength);
+                d->recordToCacheWindows(ringReadData, d->position, readLength);
+                for (int ch = 0; ch < readData.buffer->channelCount(); ch++)
+                    readData.buffer->clear(ch, ringReadData.startPos + readLength, ringReadData.length - readLength);
+                d->position += ringReadData.length;
+                d->skipBuffer(ringReadData.length - readLength);
+                d->commitBufferingTask();
+                return readData.length;
             }
-            d->headPosition += readData.length;
         }
-        if (!d->currentBufferingTask)
-            d->commitBufferingTask(false);
-        d->position += readData.length;
+        d->readFromBuffer(ringReadData, ringReadData.length);
+        d->recordToCacheWindows(ringReadData, d->position, ringReadData.length);
+        auto targetLength = d->targetBufferedLength();
+        if (targetLength - d->bufferedLength() >= qMax(bufferSize(), targetLength / 4))
+            d->commitBufferingTask();
+        d->position += ringReadData.length;
         return readData.length;
     }
 
@@ -113,43 +175,90 @@ namespace talcs {
         return d->src->length();
     }
 
+    /**
+     * @copydoc PositionableAudioSource::contentVersion()
+     *
+     * The version changes when the source is replaced, or when the content of the source changes.
+     */
+    quint64 BufferingAudioSource::contentVersion() const {
+        Q_D(const BufferingAudioSource);
+        QMutexLocker locker(&d->mutex);
+        return combineContentVersion(d->contentVersion.loadRelaxed(), d->src->contentVersion());
+    }
+
     void BufferingAudioSource::setNextReadPosition(qint64 pos) {
         Q_D(BufferingAudioSource);
         QMutexLocker locker(&d->mutex);
+        // The blocks skipped before repositioning are not caught up on
+        d->skippedLength.storeRelaxed(0);
         if (pos == nextReadPosition())
             return;
+        PositionableAudioSource::setNextReadPosition(pos);
         if (isOpen() && d->readAheadSize > bufferSize()) {
-            flush();
-            d->src->setNextReadPosition(pos);
-            if (d->autoBuffering)
-                d->commitBufferingTask(false);
+            d->seek(pos);
         } else {
+            d->terminateCurrentBufferingTask();
             d->src->setNextReadPosition(pos);
         }
-        PositionableAudioSource::setNextReadPosition(pos);
+    }
+
+    /**
+     * @copydoc PositionableAudioSource::setLoopingRangeHint()
+     *
+     * The beginning of the looping range, up to readAheadSize(), is kept in a cache window once it has been played, so
+     * that wrapping around the loop does not wait for the source. The range is also propagated to the source.
+     */
+    void BufferingAudioSource::setLoopingRangeHint(qint64 l, qint64 r) {
+        Q_D(BufferingAudioSource);
+        QMutexLocker locker(&d->mutex);
+        d->src->setLoopingRangeHint(l, r);
+        if (l == d->loopingStartHint && r == d->loopingEndHint)
+            return;
+        PositionableAudioSource::setLoopingRangeHint(l, r);
+        if (isOpen() && d->readAheadSize > bufferSize()) {
+            d->allocateCacheWindows();
+            d->resetCacheWindow(0);
+            d->requestRebalance();
+        }
     }
 
     bool BufferingAudioSource::open(qint64 bufferSize, double sampleRate) {
         Q_D(BufferingAudioSource);
         QMutexLocker locker(&d->mutex);
         AudioSource::close();
-        flush();
+        d->terminateCurrentBufferingTask();
         if (!d->src->open(bufferSize, sampleRate))
             return false;
-        d->src->setNextReadPosition(d->position);
+        // The buffers are sized by the new buffer size, so this object is marked open first
+        if (!AudioSource::open(bufferSize, sampleRate))
+            return false;
+        d->skippedLength.storeRelaxed(0);
+        d->readTimer.start();
+        d->lastReadTime.storeRelaxed(-1);
+        d->consumptionRate = 0;
+        d->emptyLengthAhead.storeRelaxed(0);
         if (d->readAheadSize > bufferSize) {
-            d->buf.resize(d->channelCount, d->readAheadSize * 2);
+            d->allocateBuffer();
+            d->resetBuffer();
+            d->allocateCacheWindows();
+            d->invalidateCacheWindows();
             if (d->autoBuffering)
-                d->commitBufferingTask(false);
+                d->commitBufferingTask();
+        } else {
+            d->releaseBuffer();
+            d->src->setNextReadPosition(d->position);
         }
-        return AudioSource::open(bufferSize, sampleRate);
+        d->requestRebalance();
+        return true;
     }
 
     void BufferingAudioSource::close() {
         Q_D(BufferingAudioSource);
         QMutexLocker locker(&d->mutex);
-        flush();
+        d->terminateCurrentBufferingTask();
+        d->releaseBuffer();
         AudioSource::close();
+        d->requestRebalance();
     }
 
     /**
@@ -160,15 +269,19 @@ namespace talcs {
         QMutexLocker locker(&d->mutex);
         if (size == d->readAheadSize)
             return;
+        d->terminateCurrentBufferingTask();
+        d->readAheadSize = size;
         if (isOpen() && size > bufferSize()) {
-            flush();
-            d->readAheadSize = size;
-            d->buf.resize(d->channelCount, size * 2);
+            d->allocateBuffer();
+            d->resetBuffer();
+            d->allocateCacheWindows();
             if (d->autoBuffering)
-                d->commitBufferingTask(false);
+                d->commitBufferingTask();
         } else {
-            d->readAheadSize = size;
+            d->releaseBuffer();
+            d->src->setNextReadPosition(d->position);
         }
+        d->requestRebalance();
     }
 
     /**
@@ -188,11 +301,14 @@ namespace talcs {
         if (channelCount == d->channelCount)
             return;
         if (isOpen() && d->readAheadSize > bufferSize()) {
-            flush();
+            d->terminateCurrentBufferingTask();
             d->channelCount = channelCount;
-            d->buf.resize(channelCount, d->readAheadSize * 2);
+            d->allocateBuffer();
+            d->resetBuffer();
+            d->allocateCacheWindows();
             if (d->autoBuffering)
-                d->commitBufferingTask(false);
+                d->commitBufferingTask();
+            d->requestRebalance();
         } else {
             d->channelCount = channelCount;
         }
@@ -213,19 +329,24 @@ namespace talcs {
         Q_D(BufferingAudioSource);
         QMutexLocker locker(&d->mutex);
         if (isOpen() && d->readAheadSize > bufferSize()) {
-            flush();
+            d->terminateCurrentBufferingTask();
             if (!src->open(bufferSize(), sampleRate())) {
                 qWarning() << "BufferingAudioSource: Cannot open source";
                 return;
             }
             d->src = src;
             d->takeOwnership = takeOwnership;
-            d->src->setNextReadPosition(d->position);
+            d->contentVersion.fetchAndAddRelaxed(1);
+            src->setLoopingRangeHint(d->loopingStartHint, d->loopingEndHint);
+            d->resetBuffer();
+            d->invalidateCacheWindows();
             if (d->autoBuffering)
-                d->commitBufferingTask(false);
+                d->commitBufferingTask();
         } else {
             d->src = src;
             d->takeOwnership = takeOwnership;
+            d->contentVersion.fetchAndAddRelaxed(1);
+            src->setLoopingRangeHint(d->loopingStartHint, d->loopingEndHint);
         }
     }
 
@@ -253,6 +374,44 @@ namespace talcs {
 
     }
 
+    /**
+     * @struct BufferingAudioSource::SchedulerStatistics
+     * @brief The statistics of the buffering tasks scheduled in a thread pool.
+     *
+     * The slack of a source is the time left before it underruns, measured in seconds, when it is picked to buffer.
+     *
+     * @var BufferingAudioSource::SchedulerStatistics::queueDepth
+     * The number of sources waiting to be buffered.
+     *
+     * @var BufferingAudioSource::SchedulerStatistics::busyWorkerCount
+     * The number of sources being buffered.
+     *
+     * @var BufferingAudioSource::SchedulerStatistics::dispatchCount
+     * The number of times a source is picked to buffer since the last reset.
+     *
+     * @var BufferingAudioSource::SchedulerStatistics::minimumSlack
+     * The minimum slack since the last reset.
+     *
+     * @var BufferingAudioSource::SchedulerStatistics::averageSlack
+     * The average slack since the last reset.
+     */
+
+    /**
+     * Gets the statistics of the buffering tasks scheduled in the thread pool.
+     * @param threadPool the thread pool, or @c nullptr for the global thread pool
+     */
+    BufferingAudioSource::SchedulerStatistics BufferingAudioSource::schedulerStatistics(QThreadPool *threadPool) {
+        return BufferingAudioSourceScheduler::of(threadPool ? threadPool : BufferingAudioSource::threadPool())->statistics();
+    }
+
+    /**
+     * Resets the dispatch count and slack statistics of the thread pool.
+     * @param threadPool the thread pool, or @c nullptr for the global thread pool
+     */
+    void BufferingAudioSource::resetSchedulerStatistics(QThreadPool *threadPool) {
+        BufferingAudioSourceScheduler::of(threadPool ? threadPool : BufferingAudioSource::threadPool())->resetStatistics();
+    }
+
     /**
      * Waits for the current buffering task to finish.
      * @param deadline the deadline
@@ -261,99 +420,889 @@ namespace talcs {
     bool BufferingAudioSource::waitForBuffering(QDeadlineTimer deadline) {
         Q_D(BufferingAudioSource);
         QMutexLocker locker(&d->bufferingTaskMutex);
-        return d->bufferingFinished.wait(&d->bufferingTaskMutex, deadline);
+        while (d->isBufferingTaskRunning) {
+            if (!d->bufferingFinished.wait(&d->bufferingTaskMutex, deadline))
+                return false;
+        }
+        return true;
     }
 
     /**
      * Flushes the buffer.
+     *
+     * The buffered data, including the cache windows, is discarded and the source will be read again from the current
+     * position.
      */
     void BufferingAudioSource::flush() {
         Q_D(BufferingAudioSource);
         QMutexLocker locker(&d->mutex);
-        d->terminateCurrentBufferingTask();
-        d->src->setNextReadPosition(d->position);
-        QMutexLocker bufLocker(&d->bufLock);
-        d->buf.clear();
-        d->headPosition = 0;
-        d->tailPosition = 0;
+        if (isOpen() && d->readAheadSize > bufferSize()) {
+            d->invalidateCacheWindows();
+            d->requestSeek(d->position);
+        } else {
+            d->terminateCurrentBufferingTask();
+            d->src->setNextReadPosition(d->position);
+        }
+    }
+
+    /**
+     * Sets the number of cache windows that keep the audio after the most recent seeks. Each of them holds up to
+     * readAheadSize() of audio.
+     *
+     * The default value is 1.
+     * @see setLoopingRangeHint()
+     */
+    void BufferingAudioSource::setSeekCacheWindowCount(int count) {
+        Q_D(BufferingAudioSource);
+        QMutexLocker locker(&d->mutex);
+        count = qMax(0, count);
+        if (count == d->seekCacheWindowCount)
+            return;
+        d->seekCacheWindowCount = count;
+        if (isOpen() && d->readAheadSize > bufferSize()) {
+            d->allocateCacheWindows();
+            d->requestRebalance();
+        }
     }
 
-    BufferingAudioSourceTask::BufferingAudioSourceTask(BufferingAudioSourcePrivate *d) : d(d) {
+    /**
+     * Gets the number of cache windows that keep the audio after the most recent seeks.
+     */
+    int BufferingAudioSource::seekCacheWindowCount() const {
+        Q_D(const BufferingAudioSource);
+        return d->seekCacheWindowCount;
     }
 
-    void BufferingAudioSourceTask::run() {
-        qint64 head = d->headPosition;
-        qint64 tail = d->tailPosition;
-        if (head > d->readAheadSize) {
-            QMutexLocker locker(&d->bufLock);
-            head = d->headPosition;
-            tail = d->tailPosition;
-            for (int ch = 0; ch < d->channelCount; ch++) {
-                d->buf.setSampleRange(ch, 0, tail - head, d->buf, ch, head);
-            }
-            d->tailPosition -= head;
-            d->headPosition = 0;
-            head = d->headPosition;
-            tail = d->tailPosition;
+    /**
+     * Sets the I/O group of the source, usually the file from which the source reads.
+     *
+     * When a source is picked to buffer, the other sources waiting in the same group are buffered one after another in
+     * the same turn, so that reads from the same file are batched. Sources in the empty group, which is the default,
+     * are not batched.
+     */
+    void BufferingAudioSource::setIoGroup(const QString &ioGroup) {
+        Q_D(BufferingAudioSource);
+        d->scheduler->setIoGroup(d, ioGroup);
+    }
+
+    /**
+     * Gets the I/O group of the source.
+     */
+    QString BufferingAudioSource::ioGroup() const {
+        Q_D(const BufferingAudioSource);
+        return d->scheduler->ioGroup(d);
+    }
+
+    /**
+     * @enum BufferingAudioSource::UnderrunPolicy
+     * The behavior when the buffered data is not enough for a read.
+     *
+     * @var BufferingAudioSource::Wait
+     * Default policy. Waits for the buffering task, or buffers on the reading thread if no task is running.
+     *
+     * @var BufferingAudioSource::Silence
+     * Outputs silence for the whole block without waiting.
+     *
+     * @var BufferingAudioSource::PartialData
+     * Outputs the buffered data and silence for the rest of the block without waiting.
+     *
+     * With the non-blocking policies, the missing audio is skipped. The buffering task is not repositioned: it keeps
+     * reading and the audio that arrives late is dropped, unless it falls behind the reader by more than the ring
+     * buffer. This confines a slow source to a glitch of its own instead of stalling the whole audio callback. A block
+     * read while another thread is changing the settings or the source is skipped the same way.
+     */
+
+    /**
+     * Sets the underrun policy.
+     * @see underrunCount()
+     */
+    void BufferingAudioSource::setUnderrunPolicy(BufferingAudioSource::UnderrunPolicy policy) {
+        Q_D(BufferingAudioSource);
+        d->underrunPolicy.storeRelaxed(policy);
+    }
+
+    /**
+     * Gets the underrun policy.
+     */
+    BufferingAudioSource::UnderrunPolicy BufferingAudioSource::underrunPolicy() const {
+        Q_D(const BufferingAudioSource);
+        return static_cast<UnderrunPolicy>(d->underrunPolicy.loadRelaxed());
+    }
+
+    /**
+     * Gets the number of reads in which the buffered data was not enough since the last reset.
+     *
+     * This function can be called from any thread.
+     */
+    qint64 BufferingAudioSource::underrunCount() const {
+        Q_D(const BufferingAudioSource);
+        return d->underrunCount.loadRelaxed();
+    }
+
+    /**
+     * Resets the underrun count to zero.
+     */
+    void BufferingAudioSource::resetUnderrunCount() {
+        Q_D(BufferingAudioSource);
+        d->underrunCount.storeRelaxed(0);
+    }
+
+    /**
+     * Sets whether to adapt the read-ahead size to the throughput of the source.
+     *
+     * If enabled, the source buffers less than readAheadSize() when the buffering task comfortably keeps up with reading,
+     * and buffers more after underruns or slow fills. readAheadSize() is the upper bound of the adapted size.
+     * @see fillStatistics()
+     */
+    void BufferingAudioSource::setAdaptiveReadAheadEnabled(bool enabled) {
+        Q_D(BufferingAudioSource);
+        QMutexLocker locker(&d->mutex);
+        if (enabled == d->isAdaptiveReadAhead)
+            return;
+        d->isAdaptiveReadAhead = enabled;
+        d->resetEffectiveReadAheadSize();
+        if (isOpen() && d->readAheadSize > bufferSize())
+            d->commitBufferingTask();
+    }
+
+    /**
+     * Gets whether to adapt the read-ahead size.
+     */
+    bool BufferingAudioSource::isAdaptiveReadAheadEnabled() const {
+        Q_D(const BufferingAudioSource);
+        return d->isAdaptiveReadAhead;
+    }
+
+    /**
+     * @struct BufferingAudioSource::FillStatistics
+     * @brief The statistics of the buffer.
+     *
+     * @var BufferingAudioSource::FillStatistics::effectiveReadAheadSize
+     * The current read-ahead size, which differs from readAheadSize() if adaptive read-ahead is enabled.
+     *
+     * @var BufferingAudioSource::FillStatistics::bufferedLength
+     * The length of audio currently buffered.
+     *
+     * @var BufferingAudioSource::FillStatistics::minimumBufferedLength
+     * The minimum length of audio buffered before a read since the last reset.
+     *
+     * @var BufferingAudioSource::FillStatistics::underrunCount
+     * The same as underrunCount().
+     */
+
+    /**
+     * Gets the statistics of the buffer.
+     *
+     * This function can be called from any thread.
+     */
+    BufferingAudioSource::FillStatistics BufferingAudioSource::fillStatistics() const {
+        Q_D(const BufferingAudioSource);
+        auto minimumBufferedLength = d->minimumBufferedLength.loadRelaxed();
+        return {
+            d->effectiveReadAheadSize.loadRelaxed(),
+            d->bufferedLength(),
+            minimumBufferedLength == std::numeric_limits<qint64>::max() ? 0 : minimumBufferedLength,
+            d->underrunCount.loadRelaxed(),
+        };
+    }
+
+    /**
+     * Resets the minimum buffered length and the underrun count.
+     */
+    void BufferingAudioSource::resetFillStatistics() {
+        Q_D(BufferingAudioSource);
+        d->minimumBufferedLength.storeRelaxed(std::numeric_limits<qint64>::max());
+        d->underrunCount.storeRelaxed(0);
+    }
+
+    /**
+     * @copydoc IAudioCacheClient::cacheMemoryUsage()
+     */
+    qint64 BufferingAudioSource::cacheMemoryUsage() const {
+        Q_D(const BufferingAudioSource);
+        return d->ringMemoryUsage.loadRelaxed() + d->windowMemoryUsage.loadRelaxed();
+    }
+
+    /**
+     * Gets the memory of the ring buffer of readAheadSize() and all cache windows in bytes, or zero if the source is
+     * not buffered.
+     */
+    qint64 BufferingAudioSource::preferredCacheMemory() const {
+        Q_D(const BufferingAudioSource);
+        return d->preferredMemory.loadRelaxed();
+    }
+
+    /**
+     * Gets the memory of the ring buffer of the minimum adaptive read-ahead size in bytes, or zero if the source is not
+     * buffered.
+     * @see setAdaptiveReadAheadEnabled()
+     */
+    qint64 BufferingAudioSource::minimumCacheMemory() const {
+        Q_D(const BufferingAudioSource);
+        return d->minimumMemory.loadRelaxed();
+    }
+
+    /**
+     * Estimates the distance from the playhead by the time since the last read, plus the length of silence the source
+     * is going to produce after the buffered audio, which the buffering task looks up after each fill.
+     * @see PositionableAudioSource::nextNonEmptyPosition()
+     */
+    qint64 BufferingAudioSource::playheadDistance() const {
+        Q_D(const BufferingAudioSource);
+        if (!isOpen())
+            return std::numeric_limits<qint64>::max();
+        auto currentTime = d->readTimer.nsecsElapsed();
+        auto lastReadTime = d->lastReadTime.loadRelaxed();
+        auto idleTime = lastReadTime >= 0 ? currentTime - lastReadTime : currentTime;
+        auto idleLength = qint64(double(idleTime) * sampleRate() / 1e9);
+        auto emptyLength = d->emptyLengthAhead.loadRelaxed();
+        if (emptyLength <= 0)
+            return idleLength;
+        if (emptyLength >= std::numeric_limits<qint64>::max() - idleLength - d->bufferedLength())
+            return std::numeric_limits<qint64>::max();
+        return idleLength + d->bufferedLength() + emptyLength;
+    }
+
+    /**
+     * @copydoc IAudioCacheClient::setCacheMemoryLimit()
+     *
+     * The buffers are allocated without locking the reader out. A cache window whose size changes is emptied. The ring
+     * buffer keeps the buffered audio: the resized one replaces it when the buffered data is discarded anyway, i.e. on
+     * the next seek or flush(), and cacheMemoryUsage() changes by then.
+     */
+    void BufferingAudioSource::setCacheMemoryLimit(qint64 bytes) {
+        Q_D(BufferingAudioSource);
+        QMutexLocker locker(&d->mutex);
+        d->memoryLimit = bytes;
+        if (!isOpen() || d->readAheadSize <= bufferSize())
+            return;
+        auto channelCount = d->channelCount;
+        auto capacity = d->ringCapacity();
+        auto windowCapacities = d->cacheWindowCapacities();
+        bool isRingResized = capacity != d->bufferCapacity.loadRelaxed();
+        QVector<int> resizedWindows;
+        for (int i = 0; i < windowCapacities.size(); i++) {
+            if (i >= d->cacheWindows.size() || d->cacheWindows[i].buf.channelCount() != channelCount || d->cacheWindows[i].buf.sampleCount() != windowCapacities[i])
+                resizedWindows.append(i);
         }
-        readByFrame(tail, d->readAheadSize - (tail - head));
-        {
-            QMutexLocker locker(&d->bufferingTaskMutex);
-            d->currentBufferingTask = nullptr;
-            d->bufferingFinished.wakeAll();
+        locker.unlock();
+
+        std::unique_ptr<AudioBuffer> newBuffer(isRingResized ? new AudioBuffer(channelCount, capacity) : nullptr);
+        QVector<AudioBuffer> newWindowBuffers;
+        for (auto i : resizedWindows)
+            newWindowBuffers.append(AudioBuffer(channelCount, windowCapacities[i]));
+
+        locker.relock();
+        // If the settings have changed meanwhile, the buffers have been allocated by the setter with the new limit
+        if (!isOpen() || d->readAheadSize <= bufferSize() || d->channelCount != channelCount ||
+            d->ringCapacity() != capacity || d->cacheWindowCapacities() != windowCapacities ||
+            d->cacheWindows.size() != windowCapacities.size())
+            return;
+        if (!newBuffer && d->bufferCapacity.loadRelaxed() != capacity)
+            newBuffer.reset(new AudioBuffer(channelCount, capacity));
+        if (newBuffer)
+            delete d->pendingBuffer.fetchAndStoreAcquire(newBuffer.release());
+        else
+            d->discardPendingBuffer();
+        for (int j = 0; j < resizedWindows.size(); j++) {
+            d->cacheWindows[resizedWindows[j]].buf = std::move(newWindowBuffers[j]);
+            d->resetCacheWindow(resizedWindows[j]);
         }
+        d->updateMemoryUsage();
+    }
+
+    BufferingAudioSourceScheduler::BufferingAudioSourceScheduler(QThreadPool *threadPool) : threadPool(threadPool) {
+        dispatcherThread = QThread::create([this] { runDispatcher(); });
+        dispatcherThread->start(QThread::HighPriority);
+    }
+
+    BufferingAudioSourceScheduler::~BufferingAudioSourceScheduler() {
+        isQuitRequested = true;
+        requestSemaphore.release();
+        dispatcherThread->wait();
+        delete dispatcherThread;
     }
 
-    void BufferingAudioSourceTask::readByFrame(qint64 startPos, qint64 length) const {
-        if (d->src->length() - d->src->nextReadPosition() < length) {
-            for (int ch = 0; ch < d->channelCount; ch++)
-                d->buf.clear(ch, startPos + d->src->length() - d->src->nextReadPosition(), length + d->src->nextReadPosition() - d->src->length());
-            length = d->src->length() - d->src->nextReadPosition();
+    // The scheduler of a thread pool is deleted when the thread pool is destroyed, so sources must not outlive the
+    // thread pool they use
+    BufferingAudioSourceScheduler *BufferingAudioSourceScheduler::of(QThreadPool *threadPool) {
+        static QHash<QThreadPool *, BufferingAudioSourceScheduler *> schedulers;
+        static QMutex globalMtx;
+        QMutexLocker locker(&globalMtx);
+        auto &scheduler = schedulers[threadPool];
+        if (!scheduler) {
+            scheduler = new BufferingAudioSourceScheduler(threadPool);
+            QObject::connect(threadPool, &QObject::destroyed, [threadPool] {
+                QMutexLocker locker(&globalMtx);
+                delete schedulers.take(threadPool);
+            });
         }
-        if (length <= 0)
+        return scheduler;
+    }
+
+    // Called by the reader. Only pushes onto the request stack and wakes up the dispatcher thread, so that the reader
+    // neither locks the mutex shared with the workers nor starts a thread pool task, which allocates.
+    void BufferingAudioSourceScheduler::schedule(BufferingAudioSourcePrivate *d) {
+        auto head = requestStack.loadRelaxed();
+        do {
+            d->nextScheduleRequest = head;
+        } while (!requestStack.testAndSetRelease(head, d, head));
+        requestSemaphore.release();
+    }
+
+    bool BufferingAudioSourceScheduler::cancel(BufferingAudioSourcePrivate *d) {
+        QMutexLocker locker(&mutex);
+        collectRequests();
+        return pendingList.removeOne(d);
+    }
+
+    void BufferingAudioSourceScheduler::setIoGroup(BufferingAudioSourcePrivate *d, const QString &ioGroup) {
+        QMutexLocker locker(&mutex);
+        d->ioGroup = ioGroup;
+    }
+
+    QString BufferingAudioSourceScheduler::ioGroup(const BufferingAudioSourcePrivate *d) {
+        QMutexLocker locker(&mutex);
+        return d->ioGroup;
+    }
+
+    BufferingAudioSource::SchedulerStatistics BufferingAudioSourceScheduler::statistics() {
+        QMutexLocker locker(&mutex);
+        collectRequests();
+        return {
+            int(pendingList.size()),
+            busyWorkerCount,
+            dispatchCount,
+            dispatchCount ? minimumSlack : 0.0,
+            dispatchCount ? totalSlack / double(dispatchCount) : 0.0,
+        };
+    }
+
+    void BufferingAudioSourceScheduler::resetStatistics() {
+        QMutexLocker locker(&mutex);
+        dispatchCount = 0;
+        totalSlack = 0;
+        minimumSlack = std::numeric_limits<double>::infinity();
+    }
+
+    // The mutex must be locked
+    void BufferingAudioSourceScheduler::collectRequests() {
+        auto d = requestStack.fetchAndStoreAcquire(nullptr);
+        if (!d)
             return;
-        qint64 frameLength = qMin(d->src->bufferSize(), length);
-        length = length - (length % frameLength);
-        for (qint64 offset = 0; offset < length; offset += frameLength) {
-            if (d->isTerminateRequested)
+        // The stack is in the reverse order of scheduling
+        int index = pendingList.size();
+        for (; d; d = d->nextScheduleRequest)
+            pendingList.insert(index, d);
+    }
+
+    // The mutex must be locked
+    void BufferingAudioSourceScheduler::startWorkers(int count) {
+        for (; count > 0 && workerCount < qMax(1, threadPool->maxThreadCount()); count--) {
+            workerCount++;
+            threadPool->start([this] { runWorker(); });
+        }
+    }
+
+    void BufferingAudioSourceScheduler::runDispatcher() {
+        for (;;) {
+            requestSemaphore.acquire(qMax(1, requestSemaphore.available()));
+            if (isQuitRequested)
                 return;
-            d->src->read(AudioSourceReadData(&d->buf, startPos + offset, frameLength));
-            d->tailPosition += frameLength;
+            QMutexLocker locker(&mutex);
+            collectRequests();
+            startWorkers(pendingList.size());
         }
     }
 
+    void BufferingAudioSourceScheduler::runWorker() {
+        QMutexLocker locker(&mutex);
+        QVector<QPair<double, BufferingAudioSourcePrivate *>> batch;
+        for (;;) {
+            collectRequests();
+            if (pendingList.isEmpty())
+                break;
+            // Earliest deadline first
+            auto it = pendingList.begin();
+            double slack = (*it)->slack();
+            for (auto p = it + 1; p != pendingList.end(); p++) {
+                auto pSlack = (*p)->slack();
+                if (pSlack < slack) {
+                    it = p;
+                    slack = pSlack;
+                }
+            }
+            // The other pending sources in the same I/O group are buffered in the same turn
+            batch.clear();
+            batch.append({slack, *it});
+            auto ioGroup = (*it)->ioGroup;
+            pendingList.erase(it);
+            if (!ioGroup.isEmpty()) {
+                for (auto p = pendingList.begin(); p != pendingList.end();) {
+                    if ((*p)->ioGroup == ioGroup) {
+                        batch.append({(*p)->slack(), *p});
+                        p = pendingList.erase(p);
+                    } else {
+                        p++;
+                    }
+                }
+                std::stable_sort(batch.begin() + 1, batch.end(), [](const auto &a, const auto &b) {
+                    return a.first < b.first;
+                });
+            }
+            for (const auto &item : qAsConst(batch)) {
+                dispatchCount++;
+                totalSlack += item.first;
+                minimumSlack = qMin(minimumSlack, item.first);
+            }
+            busyWorkerCount += batch.size();
+            locker.unlock();
 
-    void BufferingAudioSourcePrivate::commitBufferingTask(bool isCritical) {
-        currentBufferingTask = new BufferingAudioSourceTask(this);
-        if (isCritical) {
-            QScopedPointer<QRunnable> p(currentBufferingTask);
-            currentBufferingTask->run();
-        } else {
-            threadPool->start(currentBufferingTask);
+            for (const auto &item : qAsConst(batch)) {
+                auto d = item.second;
+                qint64 targetLength = d->targetBufferedLength();
+                qint64 batchLength = qMax(targetLength / 4, d->src->bufferSize());
+                d->fillBuffer(qMin(targetLength, d->bufferedLength() + batchLength));
+                bool isFinished = d->isTerminateRequested || d->bufferedLength() >= d->targetBufferedLength();
+
+                locker.relock();
+                busyWorkerCount--;
+                if (isFinished) {
+                    locker.unlock();
+                    d->finishBufferingTask();
+                } else {
+                    pendingList.append(d);
+                    locker.unlock();
+                }
+            }
+            locker.relock();
         }
+        workerCount--;
     }
 
-    void BufferingAudioSourcePrivate::terminateCurrentBufferingTask() {
+    qint64 BufferingAudioSourcePrivate::bufferedLength() const {
+        if (bufferGeneration.loadAcquire() != generation.loadRelaxed())
+            return 0;
+        // The head is ahead of the tail after an underrun is skipped
+        return qMax(0ll, tailPosition.loadAcquire() - headPosition.loadRelaxed());
+    }
+
+    void BufferingAudioSourcePrivate::readFromBuffer(const AudioSourceReadData &readData, qint64 length) {
+        if (length <= 0)
+            return;
+        int channelCount_ = qMin(readData.buffer->channelCount(), channelCount);
+        qint64 capacity = buf.sampleCount();
+        qint64 head = headPosition.loadRelaxed();
+        qint64 offset = head % capacity;
+        qint64 firstLength = qMin(length, capacity - offset);
+        for (int ch = 0; ch < channelCount_; ch++) {
+            readData.buffer->setSampleRange(ch, readData.startPos, firstLength, buf, ch, offset);
+            if (firstLength < length)
+                readData.buffer->setSampleRange(ch, readData.startPos + firstLength, length - firstLength, buf, ch, 0);
+        }
+        for (int ch = channelCount_; ch < readData.buffer->channelCount(); ch++) {
+            readData.buffer->clear(ch, readData.startPos, length);
+        }
+        headPosition.storeRelease(head + length);
+    }
+
+    // Runs on the reader side. Moves the head over audio that is not buffered yet, which the buffering task drops when
+    // it arrives. If the buffering task falls behind by more than the ring buffer, it is repositioned instead.
+    void BufferingAudioSourcePrivate::skipBuffer(qint64 length) {
+        if (length <= 0)
+            return;
+        if (bufferGeneration.loadAcquire() != generation.loadRelaxed()) {
+            // A seek is pending and its position is outdated now
+            requestSeek(position);
+            return;
+        }
+        qint64 head = headPosition.loadRelaxed() + length;
+        if (head - tailPosition.loadAcquire() > buf.sampleCount()) {
+            requestSeek(position);
+            return;
+        }
+        headPosition.storeRelease(head);
+    }
+
+    // Runs on the reader side. Catches up on the blocks that were output as silence while the mutex was held by
+    // another thread.
+    void BufferingAudioSourcePrivate::skip(qint64 length) {
         Q_Q(BufferingAudioSource);
-        if (threadPool->tryTake(currentBufferingTask)) {
-            delete currentBufferingTask;
-            currentBufferingTask = nullptr;
+        if (readAheadSize <= q->bufferSize()) {
+            src->setNextReadPosition(src->nextReadPosition() + length);
             return;
         }
-        {
-            QMutexLocker locker(&bufferingTaskMutex);
-            if (!currentBufferingTask)
+        if (currentCacheWindow >= 0) {
+            const auto &window = cacheWindows[currentCacheWindow];
+            qint64 windowLength = qMin(length, window.position + window.length - position);
+            position += windowLength;
+            length -= windowLength;
+            if (position == window.position + window.length)
+                currentCacheWindow = -1;
+        }
+        position += length;
+        skipBuffer(length);
+    }
+
+    // Runs on the producer side. Only one thread runs this at a time, guarded by isBufferingTaskRunning.
+    void BufferingAudioSourcePrivate::fillBuffer(qint64 requiredLength) {
+        for (;;) {
+            if (isTerminateRequested)
+                return;
+            auto currentGeneration = generation.loadAcquire();
+            if (currentGeneration != bufferGeneration.loadRelaxed()) {
+                // The reader neither moves the head nor reads the ring buffer while the generation is outdated
+                installPendingBuffer();
+                tailPosition.storeRelease(headPosition.loadAcquire());
+                src->setNextReadPosition(seekPosition.loadRelaxed());
+                bufferGeneration.storeRelease(currentGeneration);
+            }
+            qint64 head = headPosition.loadAcquire();
+            qint64 tail = tailPosition.loadRelaxed();
+            if (tail - head >= requiredLength) {
+                auto nextPosition = src->nextReadPosition();
+                emptyLengthAhead.storeRelaxed(src->nextNonEmptyPosition(nextPosition) - nextPosition);
                 return;
-            isTerminateRequested = true;
+            }
+            qint64 capacity = buf.sampleCount();
+            qint64 offset = tail % capacity;
+            // If the tail is behind the head, the audio before the head is written to free space and dropped
+            qint64 length = qMin(qMin(src->bufferSize(), capacity - qMax(0ll, tail - head)), capacity - offset);
+            qint64 readLength = qBound(0ll, src->length() - src->nextReadPosition(), length);
+            if (readLength > 0)
+                src->read(AudioSourceReadData(&buf, offset, readLength));
+            if (readLength < length) {
+                // Beyond the end of the source is silence
+                for (int ch = 0; ch < channelCount; ch++)
+                    buf.clear(ch, offset + readLength, length - readLength);
+            }
+            tailPosition.storeRelease(tail + length);
+            if (isDataRequired) {
+                QMutexLocker locker(&bufferingTaskMutex);
+                bufferingProgressed.wakeAll();
+            }
+        }
+    }
+
+    void BufferingAudioSourcePrivate::finishBufferingTask() {
+        QMutexLocker locker(&bufferingTaskMutex);
+        isBufferingTaskRunning = false;
+        bufferingFinished.wakeAll();
+        bufferingProgressed.wakeAll();
+    }
+
+    void BufferingAudioSourcePrivate::commitBufferingTask() {
+        if (!isBufferingTaskRunning.testAndSetOrdered(false, true))
+            return;
+        scheduler->schedule(this);
+    }
+
+    void BufferingAudioSourcePrivate::terminateCurrentBufferingTask() {
+        if (!isBufferingTaskRunning)
+            return;
+        if (scheduler->cancel(this)) {
+            finishBufferingTask();
+            return;
+        }
+        QMutexLocker locker(&bufferingTaskMutex);
+        isTerminateRequested = true;
+        while (isBufferingTaskRunning)
             bufferingFinished.wait(&bufferingTaskMutex);
-            isTerminateRequested = false;
+        isTerminateRequested = false;
+    }
+
+    void BufferingAudioSourcePrivate::waitForBufferedData(qint64 length) {
+        for (;;) {
+            if (isBufferingTaskRunning.testAndSetOrdered(false, true) || scheduler->cancel(this)) {
+                // No buffering task is running, so buffer on the current thread
+                fillBuffer(length);
+                finishBufferingTask();
+                return;
+            }
+            QMutexLocker locker(&bufferingTaskMutex);
+            isDataRequired = true;
+            if (bufferedLength() >= length)
+                break;
+            if (isBufferingTaskRunning)
+                bufferingProgressed.wait(&bufferingTaskMutex);
+        }
+        isDataRequired = false;
+    }
+
+    void BufferingAudioSourcePrivate::updateConsumptionRate(qint64 length) {
+        auto currentTime = readTimer.nsecsElapsed();
+        auto lastReadTime_ = lastReadTime.loadRelaxed();
+        if (lastReadTime_ >= 0 && currentTime > lastReadTime_) {
+            auto currentRate = qint64(double(length) * 1e9 / double(currentTime - lastReadTime_));
+            consumptionRate.storeRelaxed((consumptionRate.loadRelaxed() * 7 + currentRate) / 8);
         }
+        lastReadTime.storeRelaxed(currentTime);
+    }
+
+    // The time left before underrun in seconds, assuming the source is read at least in real time
+    double BufferingAudioSourcePrivate::slack() const {
+        Q_Q(const BufferingAudioSource);
+        auto rate = qMax(double(consumptionRate.loadRelaxed()), q->sampleRate());
+        if (rate <= 0)
+            return 0;
+        return double(bufferedLength()) / rate;
+    }
+
+    void BufferingAudioSourcePrivate::requestSeek(qint64 pos) {
+        seekPosition.storeRelaxed(pos);
+        generation.fetchAndAddRelease(1);
+        if (autoBuffering)
+            commitBufferingTask();
+    }
+
+    qint64 BufferingAudioSourcePrivate::targetBufferedLength() const {
+        return qMin(effectiveReadAheadSize.loadRelaxed(), bufferCapacity.loadRelaxed());
+    }
+
+    qint64 BufferingAudioSourcePrivate::minimumAdaptiveReadAheadSize() const {
+        Q_Q(const BufferingAudioSource);
+        return qMin(readAheadSize, qMax(2 * q->bufferSize(), readAheadSize / 16));
+    }
+
+    void BufferingAudioSourcePrivate::resetEffectiveReadAheadSize() {
+        Q_Q(BufferingAudioSource);
+        comfortableReadLength = 0;
+        if (isAdaptiveReadAhead && q->isOpen())
+            effectiveReadAheadSize.storeRelaxed(qBound(minimumAdaptiveReadAheadSize(), readAheadSize / 4, readAheadSize));
+        else
+            effectiveReadAheadSize.storeRelaxed(readAheadSize);
     }
 
-    void BufferingAudioSourcePrivate::accelerateCurrentBufferingTaskAndWait() {
+    // Runs on the reader side
+    void BufferingAudioSourcePrivate::adaptReadAheadSize(qint64 bufferedLength_, bool isUnderrun) {
         Q_Q(BufferingAudioSource);
-        terminateCurrentBufferingTask();
-        commitBufferingTask(true);
+        if (!isAdaptiveReadAhead)
+            return;
+        auto size = effectiveReadAheadSize.loadRelaxed();
+        auto minimumSize = minimumAdaptiveReadAheadSize();
+        if (isUnderrun) {
+            size *= 2;
+            comfortableReadLength = 0;
+        } else if (bufferedLength_ < size / 4) {
+            // The buffering task hardly keeps up
+            size += size / 2;
+            comfortableReadLength = 0;
+        } else if (bufferedLength_ >= size / 2) {
+            // Shrink after the buffer stays at least half full for 10 seconds
+            comfortableReadLength += q->bufferSize();
+            if (comfortableReadLength >= qint64(q->sampleRate() * 10)) {
+                size -= size / 8;
+                comfortableReadLength = 0;
+            }
+        } else {
+            comfortableReadLength = 0;
+        }
+        effectiveReadAheadSize.storeRelaxed(qBound(minimumSize, size, readAheadSize));
+    }
+
+    // The first window is reserved for the looping range, and is empty if there is no hint
+    qint64 BufferingAudioSourcePrivate::preferredCacheWindowSize(int index) const {
+        if (index != 0)
+            return readAheadSize;
+        qint64 loopingLength = loopingStartHint >= 0 && loopingEndHint > loopingStartHint ? loopingEndHint - loopingStartHint : 0;
+        return qMin(readAheadSize, loopingLength);
+    }
+
+    // The windows get the memory left by the ring buffer of its planned capacity
+    QVector<qint64> BufferingAudioSourcePrivate::cacheWindowCapacities() const {
+        QVector<qint64> capacities(1 + seekCacheWindowCount);
+        qint64 remainingLength = memoryLimit < 0 || frameBytes() == 0 ? std::numeric_limits<qint64>::max() : qMax(0ll, memoryLimit / frameBytes() - ringCapacity());
+        for (int i = 0; i < capacities.size(); i++) {
+            capacities[i] = qMin(remainingLength, preferredCacheWindowSize(i));
+            remainingLength -= capacities[i];
+        }
+        return capacities;
+    }
+
+    // Windows are reallocated only if their sizes change, so the cached audio survives unrelated changes
+    void BufferingAudioSourcePrivate::allocateCacheWindows() {
+        auto capacities = cacheWindowCapacities();
+        cacheWindows.resize(capacities.size());
+        if (currentCacheWindow >= cacheWindows.size())
+            currentCacheWindow = -1;
+        for (int i = 0; i < cacheWindows.size(); i++) {
+            auto &window = cacheWindows[i];
+            if (window.buf.channelCount() == channelCount && window.buf.sampleCount() == capacities[i])
+                continue;
+            window.buf = AudioBuffer(channelCount, capacities[i]);
+            resetCacheWindow(i);
+        }
+        updateMemoryUsage();
+    }
+
+    void BufferingAudioSourcePrivate::resetCacheWindow(int index) {
+        auto &window = cacheWindows[index];
+        window.position = index == 0 && window.buf.sampleCount() ? loopingStartHint : -1;
+        window.length = 0;
+        if (currentCacheWindow == index)
+            currentCacheWindow = -1;
+    }
+
+    void BufferingAudioSourcePrivate::invalidateCacheWindows() {
+        for (int i = 0; i < cacheWindows.size(); i++)
+            resetCacheWindow(i);
+        cacheContentVersion = src->contentVersion();
+    }
+
+    // The windows hold the audio of the source at the time they were recorded, so they are dropped once it changes
+    void BufferingAudioSourcePrivate::validateCacheWindows() {
+        if (src->contentVersion() != cacheContentVersion)
+            invalidateCacheWindows();
+    }
+
+    qint64 BufferingAudioSourcePrivate::frameBytes() const {
+        return qint64(channelCount) * qint64(sizeof(float));
+    }
+
+    qint64 BufferingAudioSourcePrivate::ringCapacity() const {
+        if (memoryLimit < 0 || frameBytes() == 0)
+            return readAheadSize;
+        return qBound(minimumAdaptiveReadAheadSize(), memoryLimit / frameBytes(), readAheadSize);
+    }
+
+    // The buffering task must not be running
+    void BufferingAudioSourcePrivate::allocateBuffer() {
+        discardPendingBuffer();
+        auto capacity = ringCapacity();
+        if (buf.channelCount() != channelCount || buf.sampleCount() != capacity)
+            replaceBuffer(AudioBuffer(channelCount, capacity));
+    }
+
+    // The buffering task must not be running
+    void BufferingAudioSourcePrivate::releaseBuffer() {
+        discardPendingBuffer();
+        replaceBuffer(AudioBuffer());
+        cacheWindows.clear();
+        currentCacheWindow = -1;
+        updateMemoryUsage();
+    }
+
+    // The buffering task must not be running, or the reader must not be reading the ring buffer
+    void BufferingAudioSourcePrivate::replaceBuffer(AudioBuffer &&newBuf) {
+        buf = std::move(newBuf);
+        bufferCapacity.storeRelaxed(buf.sampleCount());
+        ringMemoryUsage.storeRelaxed(buf.sampleCount() * buf.channelCount() * qint64(sizeof(float)));
+    }
+
+    void BufferingAudioSourcePrivate::updateMemoryUsage() {
+        qint64 length = 0;
+        for (const auto &window : cacheWindows)
+            length += window.buf.sampleCount();
+        windowMemoryUsage.storeRelaxed(length * frameBytes());
+    }
+
+    void BufferingAudioSourcePrivate::discardPendingBuffer() {
+        delete pendingBuffer.fetchAndStoreAcquire(nullptr);
+    }
+
+    // Runs on the producer side
+    void BufferingAudioSourcePrivate::installPendingBuffer() {
+        auto newBuf = pendingBuffer.fetchAndStoreAcquire(nullptr);
+        if (!newBuf)
+            return;
+        replaceBuffer(std::move(*newBuf));
+        delete newBuf;
+    }
+
+    // Updates the snapshots of the memory demand before AudioCacheBudget reads them
+    void BufferingAudioSourcePrivate::requestRebalance() {
+        Q_Q(BufferingAudioSource);
+        if (!q->isOpen() || readAheadSize <= q->bufferSize()) {
+            preferredMemory.storeRelaxed(0);
+            minimumMemory.storeRelaxed(0);
+        } else {
+            qint64 length = readAheadSize;
+            for (int i = 0; i <= seekCacheWindowCount; i++)
+                length += preferredCacheWindowSize(i);
+            preferredMemory.storeRelaxed(length * frameBytes());
+            minimumMemory.storeRelaxed(minimumAdaptiveReadAheadSize() * frameBytes());
+        }
+        AudioCacheBudget::globalInstance()->requestRebalance();
+    }
+
+    // Runs on the reader side. Returns the length read from the current window.
+    qint64 BufferingAudioSourcePrivate::readFromCacheWindow(const AudioSourceReadData &readData) {
+        if (currentCacheWindow < 0)
+            return 0;
+        const auto &window = cacheWindows[currentCacheWindow];
+        qint64 offset = position - window.position;
+        qint64 length = qMin(readData.length, window.length - offset);
+        int channelCount_ = qMin(readData.buffer->channelCount(), channelCount);
+        for (int ch = 0; ch < channelCount_; ch++)
+            readData.buffer->setSampleRange(ch, readData.startPos, length, window.buf, ch, offset);
+        for (int ch = channelCount_; ch < readData.buffer->channelCount(); ch++)
+            readData.buffer->clear(ch, readData.startPos, length);
+        position += length;
+        if (position == window.position + window.length)
+            currentCacheWindow = -1;
+        return length;
+    }
+
+    // Runs on the reader side. Appends the audio read from the ring buffer to the windows that end within it.
+    void BufferingAudioSourcePrivate::recordToCacheWindows(const AudioSourceReadData &readData, qint64 position_, qint64 length) {
+        for (auto &window : cacheWindows) {
+            if (window.position < 0)
+                continue;
+            qint64 windowEnd = window.position + window.length;
+            if (windowEnd < position_ || windowEnd >= position_ + length)
+                continue;
+            qint64 offset = windowEnd - position_;
+            qint64 recordLength = qMin(length - offset, window.buf.sampleCount() - window.length);
+            if (recordLength <= 0)
+                continue;
+            int channelCount_ = qMin(readData.buffer->channelCount(), channelCount);
+            for (int ch = 0; ch < channelCount_; ch++)
+                window.buf.setSampleRange(ch, window.length, recordLength, *readData.buffer, ch, readData.startPos + offset);
+            for (int ch = channelCount_; ch < channelCount; ch++)
+                window.buf.clear(ch, window.length, recordLength);
+            window.length += recordLength;
+        }
+    }
+
+    // Runs on the reader side
+    void BufferingAudioSourcePrivate::seek(qint64 pos) {
+        Q_Q(BufferingAudioSource);
+        validateCacheWindows();
+        currentCacheWindow = -1;
+        bool isRecording = false;
+        for (int i = 0; i < cacheWindows.size(); i++) {
+            auto &window = cacheWindows[i];
+            if (window.position < 0 || pos < window.position || pos > window.position + window.length)
+                continue;
+            if (window.position + window.length - pos >= q->bufferSize()) {
+                window.lastUsed = ++cacheWindowUseCounter;
+                currentCacheWindow = i;
+                requestSeek(window.position + window.length);
+                return;
+            }
+            if (window.position + window.length == pos)
+                isRecording = true;
+        }
+        requestSeek(pos);
+        if (isRecording || cacheWindows.size() <= 1)
+            return;
+        // Records from the new position into the least recently used seek window
+        auto lruWindow = std::min_element(cacheWindows.begin() + 1, cacheWindows.end(), [](const CacheWindow &a, const CacheWindow &b) {
+            return a.lastUsed < b.lastUsed;
+        });
+        lruWindow->position = pos;
+        lruWindow->length = 0;
+        lruWindow->lastUsed = ++cacheWindowUseCounter;
+    }
+
+    // The buffering task must not be running
+    void BufferingAudioSourcePrivate::resetBuffer() {
+        installPendingBuffer();
+        resetEffectiveReadAheadSize();
+        src->setNextReadPosition(position);
+        headPosition = 0;
+        tailPosition = 0;
+        bufferGeneration.storeRelease(generation.loadRelaxed());
     }
 
 
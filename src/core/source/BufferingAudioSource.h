@@ -21,7 +21,9 @@
 #define TALCS_BUFFERINGAUDIOSOURCE_H
 
 #include <QDeadlineTimer>
+#include <QString>
 
+#include <TalcsCore/IAudioCacheClient.h>
 #include <TalcsCore/PositionableAudioSource.h>
 
 class QThreadPool;
@@ -30,7 +32,7 @@ namespace talcs {
 
     class BufferingAudioSourcePrivate;
 
-    class TALCSCORE_EXPORT BufferingAudioSource : public PositionableAudioSource {
+    class TALCSCORE_EXPORT BufferingAudioSource : public PositionableAudioSource, public IAudioCacheClient {
         Q_DECLARE_PRIVATE(BufferingAudioSource)
     public:
         explicit BufferingAudioSource(PositionableAudioSource *src, int channelCount, qint64 readAheadSize,
@@ -42,6 +44,8 @@ namespace talcs {
 
         qint64 length() const override;
         void setNextReadPosition(qint64 pos) override;
+        void setLoopingRangeHint(qint64 l, qint64 r) override;
+        quint64 contentVersion() const override;
 
         bool open(qint64 bufferSize, double sampleRate) override;
         void close() override;
@@ -59,8 +63,53 @@ namespace talcs {
 
         void flush();
 
+        void setSeekCacheWindowCount(int count);
+        int seekCacheWindowCount() const;
+
+        void setIoGroup(const QString &ioGroup);
+        QString ioGroup() const;
+
+        enum UnderrunPolicy {
+            Wait,
+            Silence,
+            PartialData,
+        };
+        void setUnderrunPolicy(UnderrunPolicy policy);
+        UnderrunPolicy underrunPolicy() const;
+
+        qint64 underrunCount() const;
+        void resetUnderrunCount();
+
+        void setAdaptiveReadAheadEnabled(bool enabled);
+        bool isAdaptiveReadAheadEnabled() const;
+
+        struct FillStatistics {
+            qint64 effectiveReadAheadSize;
+            qint64 bufferedLength;
+            qint64 minimumBufferedLength;
+            qint64 underrunCount;
+        };
+        FillStatistics fillStatistics() const;
+        void resetFillStatistics();
+
+        qint64 cacheMemoryUsage() const override;
+        qint64 preferredCacheMemory() const override;
+        qint64 minimumCacheMemory() const override;
+        qint64 playheadDistance() const override;
+        void setCacheMemoryLimit(qint64 bytes) override;
+
         static QThreadPool *threadPool();
 
+        struct SchedulerStatistics {
+            int queueDepth;
+            int busyWorkerCount;
+            qint64 dispatchCount;
+            double minimumSlack;
+            double averageSlack;
+        };
+        static SchedulerStatistics schedulerStatistics(QThreadPool *threadPool = nullptr);
+        static void resetSchedulerStatistics(QThreadPool *threadPool = nullptr);
+
     protected:
         explicit BufferingAudioSource(BufferingAudioSourcePrivate &d);
         qint64 processReading(const AudioSourceReadData &readData) override;
@@ -20,8 +20,14 @@
 #ifndef TALCS_BUFFERINGAUDIOSOURCE_P_H
 #define TALCS_BUFFERINGAUDIOSOURCE_P_H
 
+#include <limits>
+
+#include <QAtomicPointer>
+#include <QElapsedTimer>
+#include <QList>
 #include <QMutex>
-#include <QRunnable>
+#include <QSemaphore>
+#include <QVector>
 #include <QWaitCondition>
 
 #include <TalcsCore/AudioBuffer.h>
@@ -30,12 +36,43 @@
 
 namespace talcs {
 
-    class BufferingAudioSourceTask : public QRunnable {
+    class BufferingAudioSourceScheduler {
     public:
-        explicit BufferingAudioSourceTask(BufferingAudioSourcePrivate *d);
-        void run() override;
-        void readByFrame(qint64 startPos, qint64 length) const;
-        BufferingAudioSourcePrivate *d;
+        explicit BufferingAudioSourceScheduler(QThreadPool *threadPool);
+        ~BufferingAudioSourceScheduler();
+        static BufferingAudioSourceScheduler *of(QThreadPool *threadPool);
+
+        void schedule(BufferingAudioSourcePrivate *d);
+        bool cancel(BufferingAudioSourcePrivate *d);
+
+        void setIoGroup(BufferingAudioSourcePrivate *d, const QString &ioGroup);
+        QString ioGroup(const BufferingAudioSourcePrivate *d);
+
+        BufferingAudioSource::SchedulerStatistics statistics();
+        void resetStatistics();
+
+    private:
+        QThreadPool *threadPool;
+        QMutex mutex;
+        QList<BufferingAudioSourcePrivate *> pendingList;
+        int workerCount = 0;
+        int busyWorkerCount = 0;
+
+        qint64 dispatchCount = 0;
+        double totalSlack = 0;
+        double minimumSlack = std::numeric_limits<double>::infinity();
+
+        // Sources scheduled by the readers are pushed onto this stack without locking, and moved to the pending list by
+        // the dispatcher thread or a worker
+        QAtomicPointer<BufferingAudioSourcePrivate> requestStack;
+        QSemaphore requestSemaphore;
+        QThread *dispatcherThread;
+        QAtomicInteger<bool> isQuitRequested = false;
+
+        void collectRequests();
+        void startWorkers(int count);
+        void runDispatcher();
+        void runWorker();
     };
 
     class BufferingAudioSourcePrivate : public PositionableAudioSourcePrivate {
@@ -50,18 +87,111 @@ namespace talcs {
 
         QRecursiveMutex mutex;
 
-        QMutex bufLock;
+        // Single-producer/single-consumer ring buffer. The head is only moved by the reader and the tail is only moved
+        // by the buffering task. Both of them increase monotonically and are mapped into the ring by modulo. The head may
+        // run ahead of the tail when an underrun is skipped.
         AudioBuffer buf;
         QAtomicInteger<qint64> headPosition;
         QAtomicInteger<qint64> tailPosition;
 
+        // A seek increases the generation. The buffering task discards the buffered data and repositions the source
+        // when it finds that the generation of the buffered data is outdated.
+        QAtomicInteger<quint64> generation;
+        QAtomicInteger<quint64> bufferGeneration;
+        QAtomicInteger<qint64> seekPosition;
+
         QWaitCondition bufferingFinished;
+        QWaitCondition bufferingProgressed;
         QMutex bufferingTaskMutex;
-        QRunnable *currentBufferingTask = nullptr;
+        BufferingAudioSourceScheduler *scheduler;
+        BufferingAudioSourcePrivate *nextScheduleRequest = nullptr;
+        QString ioGroup;
+        QAtomicInteger<bool> isBufferingTaskRunning = false;
         QAtomicInteger<bool> isTerminateRequested = false;
-        void commitBufferingTask(bool isCritical);
+        QAtomicInteger<bool> isDataRequired = false;
+
+        QAtomicInteger<int> underrunPolicy = BufferingAudioSource::Wait;
+        QAtomicInteger<qint64> underrunCount = 0;
+
+        // The length output as silence by the reader while the mutex was held by another thread, which is skipped by the
+        // next read that locks the mutex, unless the source is repositioned in the meantime
+        QAtomicInteger<qint64> skippedLength = 0;
+        void skip(qint64 length);
+
+        bool isAdaptiveReadAhead = false;
+        QAtomicInteger<qint64> effectiveReadAheadSize = 0;
+        QAtomicInteger<qint64> minimumBufferedLength = std::numeric_limits<qint64>::max();
+        qint64 comfortableReadLength = 0;
+        qint64 targetBufferedLength() const;
+        qint64 minimumAdaptiveReadAheadSize() const;
+        void resetEffectiveReadAheadSize();
+        void adaptReadAheadSize(qint64 bufferedLength_, bool isUnderrun);
+
+        // Audio recorded by the reader besides the ring buffer. The first window caches the beginning of the hinted
+        // looping range, and the others cache the audio after recent seeks. A seek into a window is served from the
+        // window while the ring buffer is refilled from the end of the window.
+        struct CacheWindow {
+            AudioBuffer buf;
+            qint64 position = -1;
+            qint64 length = 0;
+            quint64 lastUsed = 0;
+        };
+        QVector<CacheWindow> cacheWindows;
+        int seekCacheWindowCount = 1;
+        int currentCacheWindow = -1;
+        quint64 cacheWindowUseCounter = 0;
+        qint64 preferredCacheWindowSize(int index) const;
+        QVector<qint64> cacheWindowCapacities() const;
+        void allocateCacheWindows();
+        void resetCacheWindow(int index);
+        quint64 cacheContentVersion = 0;
+        void invalidateCacheWindows();
+        void validateCacheWindows();
+        qint64 readFromCacheWindow(const AudioSourceReadData &readData);
+        void recordToCacheWindows(const AudioSourceReadData &readData, qint64 position_, qint64 length);
+        void seek(qint64 pos);
+
+        // The limit set by AudioCacheBudget in bytes. The ring buffer is shrunk first down to the minimum adaptive
+        // read-ahead size, and the cache windows get what is left.
+        qint64 memoryLimit = -1;
+        qint64 frameBytes() const;
+        qint64 ringCapacity() const;
+        void allocateBuffer();
+        void releaseBuffer();
+        void replaceBuffer(AudioBuffer &&newBuf);
+        void updateMemoryUsage();
+
+        // A ring buffer resized by the budget is installed by the buffering task when it discards the buffered data on
+        // the next seek, since the reader does not touch the ring buffer then
+        QAtomicPointer<AudioBuffer> pendingBuffer = nullptr;
+        QAtomicInteger<qint64> bufferCapacity = 0;
+        void discardPendingBuffer();
+        void installPendingBuffer();
+
+        // Snapshots read by AudioCacheBudget without locking the mutex
+        QAtomicInteger<qint64> ringMemoryUsage = 0;
+        QAtomicInteger<qint64> windowMemoryUsage = 0;
+        QAtomicInteger<qint64> preferredMemory = 0;
+        QAtomicInteger<qint64> minimumMemory = 0;
+        QAtomicInteger<qint64> emptyLengthAhead = 0;
+        void requestRebalance();
+
+        QElapsedTimer readTimer;
+        QAtomicInteger<qint64> lastReadTime = -1;
+        QAtomicInteger<qint64> consumptionRate = 0;
+        void updateConsumptionRate(qint64 length);
+        double slack() const;
+
+        qint64 bufferedLength() const;
+        void readFromBuffer(const AudioSourceReadData &readData, qint64 length);
+        void skipBuffer(qint64 length);
+        void fillBuffer(qint64 requiredLength);
+        void finishBufferingTask();
+        void commitBufferingTask();
         void terminateCurrentBufferingTask();
-        void accelerateCurrentBufferingTaskAndWait();
+        void waitForBufferedData(qint64 length);
+        void requestSeek(qint64 pos);
+        void resetBuffer();
     };
 
 }
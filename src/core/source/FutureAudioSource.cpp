@@ -24,20 +24,33 @@
 
 namespace talcs {
 
+    static constexpr unsigned long PROGRESS_POLLING_INTERVAL = 40;
+
     void FutureAudioSourcePrivate::_q_statusChanged(FutureAudioSource::Status status) {
         Q_Q(FutureAudioSource);
         if (status == FutureAudioSource::Ready) {
             auto src_ = futureWatcher->result();
+            QMutexLocker locker(&mutex);
             if (q->isOpen()) {
                 auto result = src_->open(q->bufferSize(), q->sampleRate());
                 Q_ASSERT(result);
                 src_->setNextReadPosition(position);
+                if (streamingSource)
+                    streamingSource->close();
             }
             src = src_;
+            contentVersion.fetchAndAddRelaxed(1);
         }
+        // Wake up the waiters before emitting the signal, since the slots may lock a mutex held by a waiter
+        notifyLengthAvailableChanged();
         emit q->statusChanged(status);
     }
 
+    void FutureAudioSourcePrivate::notifyLengthAvailableChanged() {
+        QMutexLocker locker(&lengthAvailableMutex);
+        lengthAvailableChanged.wakeAll();
+    }
+
     /**
      * @class FutureAudioSource
      * @brief The class takes an PositionableAudioSource object as the result of a asynchronous process.
@@ -63,6 +76,11 @@ namespace talcs {
      *
      * - Once finished or cancelled, it should not be started again.
      *
+     * If the process produces audio progressively, the audio rendered so far can be published with a streaming source
+     * (see setStreamingSource()). In this case, the progress value of the future also works as the watermark of samples
+     * available: the samples before it should be readable from the streaming source by the time the progress value is
+     * reported. Before the source is ready, the available part is read from the streaming source and the rest is silent.
+     *
      * @see [QFuture](https://doc.qt.io/qt-5/qfuture.html), [QFutureWatcher](https://doc.qt.io/qt-5/qfuturewatcher.html), QFutureInterface
      */
 
@@ -101,7 +119,12 @@ namespace talcs {
                 [=]() { d->_q_statusChanged(Cancelled); });
         connect(d->futureWatcher, &QFutureWatcher<PositionableAudioSource *>::finished, this, [=]() { d->_q_statusChanged(Ready); });
         connect(d->futureWatcher, &QFutureWatcher<PositionableAudioSource *>::progressValueChanged, this,
-                [=](int progressValue) { emit progressChanged(progressValue); });
+                [=](int progressValue) {
+                    if (d->streamingSource)
+                        d->contentVersion.fetchAndAddRelaxed(1);
+                    d->notifyLengthAvailableChanged();
+                    emit progressChanged(progressValue);
+                });
         d->futureWatcher->setFuture(future);
     }
 
@@ -132,6 +155,7 @@ namespace talcs {
             }
         }
         d->src = nullptr;
+        d->contentVersion.fetchAndAddRelaxed(1);
         d->futureWatcher->setFuture(future);
     }
 
@@ -147,6 +171,13 @@ namespace talcs {
                 readData.buffer->clear(ch, readData.startPos, readData.length);
             }
             auto readLength = qMin(readData.length, length() - d->position);
+            if (d->streamingSource) {
+                auto availableReadLength = qBound(0ll, lengthAvailable() - d->position, readLength);
+                if (availableReadLength > 0) {
+                    d->streamingSource->setNextReadPosition(d->position);
+                    d->streamingSource->read({readData.buffer, readData.startPos, availableReadLength, readData.silentFlags});
+                }
+            }
             d->position += readLength;
             return readLength;
         }
@@ -159,6 +190,21 @@ namespace talcs {
         return d->futureWatcher->progressMaximum();
     }
 
+    /**
+     * @copydoc PositionableAudioSource::contentVersion()
+     *
+     * Before the source is ready, the version changes whenever more audio is available from the streaming source. It
+     * also changes when the source gets ready.
+     */
+    quint64 FutureAudioSource::contentVersion() const {
+        Q_D(const FutureAudioSource);
+        QMutexLocker locker(&d->mutex);
+        auto version = d->contentVersion.loadRelaxed();
+        if (d->src)
+            version = combineContentVersion(version, d->src->contentVersion());
+        return version;
+    }
+
     qint64 FutureAudioSource::nextReadPosition() const {
         return PositionableAudioSource::nextReadPosition();
     }
@@ -179,6 +225,7 @@ namespace talcs {
             case Running:
             case Paused:
                 return d->callbacks.preloadingOpen(bufferSize, sampleRate) &&
+                       (!d->streamingSource || d->streamingSource->open(bufferSize, sampleRate)) &&
                        AudioSource::open(bufferSize, sampleRate);
             case Cancelled:
                 return false;
@@ -200,6 +247,8 @@ namespace talcs {
             case Running:
             case Paused:
                 d->callbacks.preloadingClose();
+                if (d->streamingSource)
+                    d->streamingSource->close();
                 break;
             case Cancelled:
                 break;
@@ -219,6 +268,58 @@ namespace talcs {
         return d->futureWatcher->progressValue();
     }
 
+    /**
+     * Sets the streaming source, from which the audio rendered so far is read before the source is ready.
+     *
+     * Only the samples before lengthAvailable() are read from it. If this object is open, the streaming source is opened
+     * until the source is ready.
+     *
+     * A StreamingAudioBuffer wrapped in a MemoryAudioSource can be used as the streaming source: the process appends the
+     * audio rendered to the buffer, and then reports the progress value.
+     *
+     * Note that this function does not take the ownership of the streaming source.
+     * @see StreamingAudioBuffer
+     */
+    void FutureAudioSource::setStreamingSource(PositionableAudioSource *streamingSource) {
+        Q_D(FutureAudioSource);
+        QMutexLocker locker(&d->mutex);
+        if (d->streamingSource == streamingSource)
+            return;
+        bool isStreaming = isOpen() && !d->src;
+        if (isStreaming && streamingSource && !streamingSource->open(bufferSize(), sampleRate())) {
+            qWarning() << "FutureAudioSource: Cannot open streaming source.";
+            return;
+        }
+        if (isStreaming && d->streamingSource)
+            d->streamingSource->close();
+        d->streamingSource = streamingSource;
+        d->contentVersion.fetchAndAddRelaxed(1);
+    }
+
+    /**
+     * Gets the streaming source.
+     * @see setStreamingSource()
+     */
+    PositionableAudioSource *FutureAudioSource::streamingSource() const {
+        Q_D(const FutureAudioSource);
+        return d->streamingSource;
+    }
+
+    /**
+     * Gets the length of audio from the beginning that can be read.
+     *
+     * This is the length of the source if it is ready, or the progress value if a streaming source is set, otherwise
+     * 0.
+     */
+    qint64 FutureAudioSource::lengthAvailable() const {
+        Q_D(const FutureAudioSource);
+        if (d->src)
+            return d->src->length();
+        if (d->streamingSource)
+            return d->futureWatcher->progressValue();
+        return 0;
+    }
+
     /**
      * Pauses the preparation.
      */
@@ -280,9 +381,37 @@ namespace talcs {
     void FutureAudioSource::wait() {
         Q_D(FutureAudioSource);
         d->futureWatcher->waitForFinished();
-        if (d->futureWatcher->isFinished())
-            while (!d->src) {
+        QMutexLocker locker(&d->lengthAvailableMutex);
+        while (!d->src && status() == Ready)
+            d->lengthAvailableChanged.wait(&d->lengthAvailableMutex);
+    }
+
+    /**
+     * Waits until audio of the specified length from the beginning can be read.
+     *
+     * If no streaming source is set, this function waits for the preparation to finish. The thread sleeps until the
+     * progress or the status changes, which is notified by the event loop of the thread this object lives in.
+     * @see lengthAvailable()
+     */
+    void FutureAudioSource::waitForLengthAvailable(qint64 length) {
+        Q_D(FutureAudioSource);
+        if (!d->streamingSource) {
+            wait();
+            return;
+        }
+        QMutexLocker locker(&d->lengthAvailableMutex);
+        while (lengthAvailable() < length) {
+            auto currentStatus = status();
+            if (currentStatus == Cancelled)
+                return;
+            if (currentStatus == Ready) {
+                locker.unlock();
+                wait();
+                return;
             }
+            // Qt 5 throttles the progress notifications of a future, so the progress value is also checked periodically
+            d->lengthAvailableChanged.wait(&d->lengthAvailableMutex, PROGRESS_POLLING_INTERVAL);
+        }
     }
 
     /**
@@ -53,9 +53,14 @@ namespace talcs {
         void setNextReadPosition(qint64 pos) override;
         bool open(qint64 bufferSize, double sampleRate) override;
         void close() override;
+        quint64 contentVersion() const override;
 
         int progress() const;
 
+        void setStreamingSource(PositionableAudioSource *streamingSource);
+        PositionableAudioSource *streamingSource() const;
+        qint64 lengthAvailable() const;
+
         void pause();
         void resume();
         void cancel();
@@ -69,6 +74,7 @@ namespace talcs {
         Status status() const;
 
         void wait();
+        void waitForLengthAvailable(qint64 length);
         PositionableAudioSource *source() const;
 
     signals:
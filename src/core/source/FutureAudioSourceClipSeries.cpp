@@ -21,10 +21,16 @@
 #include "FutureAudioSourceClipSeries_p.h"
 #include "FutureAudioSource.h"
 
+#include <algorithm>
+
+#include <QVector>
+
 #include <TalcsCore/TransportAudioSource.h>
 
 namespace talcs {
 
+    static constexpr int PRIORITIZING_INTERVAL = 250;
+
     FutureAudioSourceClipSeriesPrivate::FutureAudioSourceClipSeriesPrivate() : AudioSourceClipSeriesBase(this) {
     }
 
@@ -41,6 +47,7 @@ namespace talcs {
             cachedLengthLoaded += (value - clipLengthLoadedDict[clip.position()]);
             clipLengthLoadedDict[clip.position()] = value;
             emitProgressChanged();
+            checkAndNotify(Resume);
         });
         QObject::connect(static_cast<FutureAudioSource *>(clip.content()), &FutureAudioSource::statusChanged, q, [=](FutureAudioSource::Status status) {
             if (status == FutureAudioSource::Ready) {
@@ -48,6 +55,8 @@ namespace talcs {
                 clipLengthCachedDict[clip.position()] = true;
                 emitProgressChanged();
                 checkAndNotify(Resume);
+                QMutexLocker locker(&mutex);
+                prioritizeRendering(position, true);
             }
         });
     }
@@ -88,6 +97,8 @@ namespace talcs {
         if (readMode != FutureAudioSourceClipSeries::Notify)
             return;
         if (!q->canRead(position + length, length)) {
+            // The position stops while the transport is paused, so the ranking is refreshed regardless of the distance
+            lastPrioritizedPosition = std::numeric_limits<qint64>::min();
             if (purpose == Pause)
                 notifyPause();
         } else {
@@ -100,6 +111,60 @@ namespace talcs {
         checkAndNotify(position, q->bufferSize(), purpose);
     }
 
+    // The distance before the clip is going to be read. Clips behind the read position come after all clips ahead of
+    // it, unless they are in the hinted looping range, in which case they are read after the loop wraps.
+    qint64 FutureAudioSourceClipSeriesPrivate::renderDistance(const ClipInterval &clip, qint64 position_) const {
+        auto clipEnd = clip.position() + clip.length();
+        if (clip.position() <= position_ && position_ < clipEnd)
+            return 0;
+        if (clip.position() > position_)
+            return clip.position() - position_;
+        if (loopingStartHint >= 0 && loopingEndHint > loopingStartHint && position_ < loopingEndHint && clipEnd > loopingStartHint)
+            return loopingEndHint - position_ + qMax(0ll, clip.position() - loopingStartHint);
+        return std::numeric_limits<qint64>::max() / 2 + (position_ - clipEnd);
+    }
+
+    void FutureAudioSourceClipSeriesPrivate::prioritizeRendering(qint64 position_, bool force) {
+        Q_Q(FutureAudioSourceClipSeries);
+        if (maxConcurrentRenderCount <= 0)
+            return;
+        // Re-ranks at most once per second of playback
+        if (!force && lastPrioritizedPosition != std::numeric_limits<qint64>::min() && qAbs(position_ - lastPrioritizedPosition) < qMax(q->bufferSize(), qint64(q->sampleRate())))
+            return;
+        lastPrioritizedPosition = position_;
+        QVector<QPair<qint64, FutureAudioSource *>> pendingList;
+        for (auto p = clips.cbegin(); p != clips.cend(); p++) {
+            auto content = static_cast<FutureAudioSource *>(p->interval().content());
+            auto status = content->status();
+            if (status == FutureAudioSource::Running || status == FutureAudioSource::Paused)
+                pendingList.append({renderDistance(p->interval(), position_), content});
+        }
+        std::stable_sort(pendingList.begin(), pendingList.end(), [](const auto &a, const auto &b) {
+            return a.first < b.first;
+        });
+        // Clips read by the next block are never paused, even beyond the limit, since the reader may wait for them
+        for (int i = 0; i < pendingList.size(); i++) {
+            auto content = pendingList[i].second;
+            auto status = content->status();
+            bool isRunningRequired = i < maxConcurrentRenderCount || pendingList[i].first < q->bufferSize();
+            if (isRunningRequired && status == FutureAudioSource::Paused)
+                content->resume();
+            else if (!isRunningRequired && status == FutureAudioSource::Running)
+                content->pause();
+        }
+    }
+
+    // Resumes a clip paused by prioritizeRendering() before the series lets go of it
+    void FutureAudioSourceClipSeriesPrivate::releaseRendering(FutureAudioSource *content) const {
+        if (maxConcurrentRenderCount > 0 && content->status() == FutureAudioSource::Paused)
+            content->resume();
+    }
+
+    void FutureAudioSourceClipSeriesPrivate::releaseAllRendering() const {
+        for (auto p = clips.cbegin(); p != clips.cend(); p++)
+            releaseRendering(static_cast<FutureAudioSource *>(p->interval().content()));
+    }
+
     /**
      * @class FutureAudioSourceClipSeries
      * @brief An AudioClipsSeriesBase object that uses FutureAudioSource
@@ -110,12 +175,21 @@ namespace talcs {
      */
     FutureAudioSourceClipSeries::FutureAudioSourceClipSeries(QObject *parent)
         : QObject(parent), PositionableAudioSource(*new FutureAudioSourceClipSeriesPrivate) {
+        Q_D(FutureAudioSourceClipSeries);
+        d->prioritizingTimer = new QTimer(this);
+        d->prioritizingTimer->setInterval(PRIORITIZING_INTERVAL);
+        connect(d->prioritizingTimer, &QTimer::timeout, this, [=] {
+            QMutexLocker locker(&d->mutex);
+            d->prioritizeRendering(d->position);
+        });
     }
 
     /**
      * Destructor.
      */
     FutureAudioSourceClipSeries::~FutureAudioSourceClipSeries() {
+        Q_D(FutureAudioSourceClipSeries);
+        d->releaseAllRendering();
         FutureAudioSourceClipSeries::close();
     }
 
@@ -127,17 +201,27 @@ namespace talcs {
         for (int ch = 0; ch < readData.buffer->channelCount(); ch++) {
             readData.buffer->clear(ch, readData.startPos, readData.length);
         }
+        d->maintainOpenWindow(d->position);
         qAsConst(d->clips).overlap_find_all(
             readDataInterval, [=](const decltype(d->clips)::const_iterator &it) {
                 auto clip = it->interval();
+                auto attributes = d->effectiveClipAttributes(clip);
+                if (attributes.isMute)
+                    return true;
+                if (!d->ensureClipOpen(clip.content()))
+                    return true;
                 auto [clipReadPosition, clipReadData] = d->calculateClipReadData(clip, d->position, readData);
                 auto clipSrc = static_cast<FutureAudioSource *>(clip.content());
                 clipSrc->setNextReadPosition(clipReadPosition);
-                if (d->readMode == Block)
-                    clipSrc->wait();
+                // A paused clip cannot be resumed while the mutex is held, so it is read as in Skip mode instead of
+                // being waited for, and the timer is left to re-rank it
+                bool isPaused = clipSrc->status() == FutureAudioSource::Paused;
+                if (isPaused)
+                    d->lastPrioritizedPosition = std::numeric_limits<qint64>::min();
+                if (d->readMode == Block && !isPaused)
+                    clipSrc->waitForLengthAvailable(clipReadPosition + clipReadData.length);
                 clipSrc->read(clipReadData);
-                for (int ch = 0; ch < readData.buffer->channelCount(); ch++)
-                    readData.buffer->addSampleRange(ch, readData.startPos, readData.length, d->buf, ch, 0);
+                d->mixClip(clip, attributes, d->position, clipReadData, readData);
                 return true;
             });
         d->position += readData.length;
@@ -157,6 +241,7 @@ namespace talcs {
         QMutexLocker locker(&d->mutex);
         if (d->position != pos) {
             d->position = pos;
+            d->maintainOpenWindow(pos);
             d->checkAndNotify(FutureAudioSourceClipSeriesPrivate::Resume);
         }
     }
@@ -187,7 +272,9 @@ namespace talcs {
             return {};
         auto ret = d->insertClip(content, position, startPos, length);
         if (!ret.isNull()) {
+            d->propagateLoopingRangeHint(content);
             d->postAddClip(d->intervalLookup(ret.position(), ret.content()));
+            d->prioritizeRendering(d->position, true);
             d->checkAndNotify(FutureAudioSourceClipSeriesPrivate::Resume);
         }
         return ret;
@@ -197,6 +284,7 @@ namespace talcs {
                                                       qint64 startPos) {
         Q_D(FutureAudioSourceClipSeries);
         d->setClipStartPos(clip, startPos);
+        d->propagateLoopingRangeHint(clip.content());
     }
 
     bool
@@ -208,6 +296,8 @@ namespace talcs {
         if (d->setClipRange(ClipViewPrivate::ClipViewImpl(clip), position, length)) {
             d->postRemoveClip(oldInterval, false);
             d->postAddClip({clip.content(), position, length});
+            d->propagateLoopingRangeHint(clip.content());
+            d->prioritizeRendering(d->position, true);
             return true;
         }
         return false;
@@ -224,13 +314,47 @@ namespace talcs {
         auto oldContent = clip.content();
         auto ret = d->setClipContent(clip, content);
         if (ret) {
+            d->forgetClip(oldContent);
+            d->releaseRendering(oldContent);
+            d->propagateLoopingRangeHint(content);
             d->postRemoveClip({oldContent, clip.position(), clip.length()}, false);
             d->postAddClip({content, clip.position(), clip.length()});
+            d->prioritizeRendering(d->position, true);
             d->checkAndNotify(FutureAudioSourceClipSeriesPrivate::Resume);
         }
         return ret;
     }
 
+    void FutureAudioSourceClipSeries::setClipFadeIn(const FutureAudioSourceClipSeries::ClipView &clip, qint64 length, FadeCurve::Shape shape) {
+        Q_D(FutureAudioSourceClipSeries);
+        QMutexLocker locker(&d->mutex);
+        d->setClipFadeIn(clip, length, shape);
+    }
+
+    void FutureAudioSourceClipSeries::setClipFadeOut(const FutureAudioSourceClipSeries::ClipView &clip, qint64 length, FadeCurve::Shape shape) {
+        Q_D(FutureAudioSourceClipSeries);
+        QMutexLocker locker(&d->mutex);
+        d->setClipFadeOut(clip, length, shape);
+    }
+
+    void FutureAudioSourceClipSeries::setClipGain(const FutureAudioSourceClipSeries::ClipView &clip, float gain) {
+        Q_D(FutureAudioSourceClipSeries);
+        QMutexLocker locker(&d->mutex);
+        d->setClipGain(clip, gain);
+    }
+
+    void FutureAudioSourceClipSeries::setClipPan(const FutureAudioSourceClipSeries::ClipView &clip, float pan) {
+        Q_D(FutureAudioSourceClipSeries);
+        QMutexLocker locker(&d->mutex);
+        d->setClipPan(clip, pan);
+    }
+
+    void FutureAudioSourceClipSeries::setClipMute(const FutureAudioSourceClipSeries::ClipView &clip, bool isMute) {
+        Q_D(FutureAudioSourceClipSeries);
+        QMutexLocker locker(&d->mutex);
+        d->setClipMute(clip, isMute);
+    }
+
     FutureAudioSourceClipSeries::ClipView FutureAudioSourceClipSeries::findClip(FutureAudioSource *content) const {
         Q_D(const FutureAudioSourceClipSeries);
         return d->findClipByContent(content);
@@ -250,14 +374,19 @@ namespace talcs {
         Q_D(FutureAudioSourceClipSeries);
         QMutexLocker locker(&d->mutex);
         auto clipInterval = d->intervalLookup(clip.position(), clip.content());
+        d->forgetClip(clip.content());
+        d->releaseRendering(clip.content());
         d->removeClip(clip);
         d->postRemoveClip(clipInterval);
+        d->prioritizeRendering(d->position, true);
         d->checkAndNotify(FutureAudioSourceClipSeriesPrivate::Resume);
     }
 
     void FutureAudioSourceClipSeries::removeAllClips() {
         Q_D(FutureAudioSourceClipSeries);
         QMutexLocker locker(&d->mutex);
+        d->forgetAllClips();
+        d->releaseAllRendering();
         d->removeAllClips();
         d->preRemoveAllClips();
         d->checkAndNotify(FutureAudioSourceClipSeriesPrivate::Resume);
@@ -276,6 +405,113 @@ namespace talcs {
         return d->effectiveLength();
     }
 
+    /**
+     * @copydoc PositionableAudioSource::nextNonEmptyPosition()
+     *
+     * The series is considered empty where there are no clips. Muted clips are still considered non-empty.
+     */
+    qint64 FutureAudioSourceClipSeries::nextNonEmptyPosition(qint64 position) const {
+        Q_D(const FutureAudioSourceClipSeries);
+        QMutexLocker locker(&d->mutex);
+        return d->nextClipPosition(position);
+    }
+
+    /**
+     * @copydoc PositionableAudioSource::contentVersion()
+     *
+     * The version changes when the clips change, or when the content of any clip changes.
+     */
+    quint64 FutureAudioSourceClipSeries::contentVersion() const {
+        Q_D(const FutureAudioSourceClipSeries);
+        QMutexLocker locker(&d->mutex);
+        return d->seriesContentVersion();
+    }
+
+    void FutureAudioSourceClipSeries::setOverlapCrossfadeEnabled(bool enabled) {
+        Q_D(FutureAudioSourceClipSeries);
+        QMutexLocker locker(&d->mutex);
+        d->setOverlapCrossfadeEnabled(enabled);
+    }
+
+    bool FutureAudioSourceClipSeries::isOverlapCrossfadeEnabled() const {
+        Q_D(const FutureAudioSourceClipSeries);
+        return d->overlapCrossfadeEnabled;
+    }
+
+    void FutureAudioSourceClipSeries::setOverlapCrossfadeShape(FadeCurve::Shape shape) {
+        Q_D(FutureAudioSourceClipSeries);
+        QMutexLocker locker(&d->mutex);
+        d->setOverlapCrossfadeShape(shape);
+    }
+
+    FadeCurve::Shape FutureAudioSourceClipSeries::overlapCrossfadeShape() const {
+        Q_D(const FutureAudioSourceClipSeries);
+        return d->overlapCrossfadeShape;
+    }
+
+    /**
+     * Sets the size of the window around the read position in which clips are kept open.
+     *
+     * By default (0), all clips are opened when the series is opened. If set to a positive value, only clips that
+     * overlap the range of @p size samples before and after the read position, or the beginning of the looping range
+     * hinted by setLoopingRangeHint(), are open. Clips entering the window are opened ahead of need and clips leaving it
+     * are closed by a worker thread of the series. The reading thread never opens a clip or waits for it: if a clip to
+     * read is not open yet, it is silent in that read, opened by the worker first, and counted in
+     * synchronousOpenCount().
+     *
+     * This bounds the file handles and memory held by clips in large series.
+     */
+    void FutureAudioSourceClipSeries::setOpenWindowSize(qint64 size) {
+        Q_D(FutureAudioSourceClipSeries);
+        QMutexLocker locker(&d->mutex);
+        d->setOpenWindowSize(size);
+        d->maintainOpenWindow(d->position);
+    }
+
+    /**
+     * Gets the size of the window in which clips are kept open.
+     * @see setOpenWindowSize()
+     */
+    qint64 FutureAudioSourceClipSeries::openWindowSize() const {
+        Q_D(const FutureAudioSourceClipSeries);
+        return d->openWindowSize;
+    }
+
+    /**
+     * Gets the number of clips that were not open yet when they were read, and thus were skipped.
+     *
+     * A growing count means that the open window is too small for the speed at which the read position moves.
+     * @see setOpenWindowSize()
+     */
+    qint64 FutureAudioSourceClipSeries::synchronousOpenCount() const {
+        Q_D(const FutureAudioSourceClipSeries);
+        return d->synchronousOpenCount.loadRelaxed();
+    }
+
+    /**
+     * Resets the number of clips skipped since they were not open to zero.
+     */
+    void FutureAudioSourceClipSeries::resetSynchronousOpenCount() {
+        Q_D(FutureAudioSourceClipSeries);
+        d->synchronousOpenCount.storeRelaxed(0);
+    }
+
+    /**
+     * @copydoc PositionableAudioSource::setLoopingRangeHint()
+     *
+     * Clips at the beginning of the looping range are kept open, and the range is propagated to the clip in which it
+     * starts.
+     * @see setOpenWindowSize()
+     */
+    void FutureAudioSourceClipSeries::setLoopingRangeHint(qint64 l, qint64 r) {
+        Q_D(FutureAudioSourceClipSeries);
+        QMutexLocker locker(&d->mutex);
+        d->setLoopingRangeHint(l, r);
+        d->maintainOpenWindow(d->position);
+        // Re-ranked on the next tick of the timer, since the hint may be set on the audio thread
+        d->lastPrioritizedPosition = std::numeric_limits<qint64>::min();
+    }
+
     /**
      * Gets the length of audio that is able to be played within the series (including blank intervals).
      */
@@ -304,6 +540,9 @@ namespace talcs {
 
     /**
      * Gets whether a block of audio of a specified length can be read from the series.
+     *
+     * A clip that is not ready can be read if the part of it to read is available from its streaming source.
+     * @see FutureAudioSource::lengthAvailable()
      * @param from the start position of reading
      * @param length the length of audio measured in samples
      */
@@ -315,7 +554,13 @@ namespace talcs {
         bool flag = true;
         qAsConst(d->clips).overlap_find_all(queryInterval, [=, &flag](const decltype(d->clips)::const_iterator &it) {
             auto clip = it->interval();
-            if (static_cast<FutureAudioSource *>(clip.content())->status() != FutureAudioSource::Ready) {
+            auto clipSrc = static_cast<FutureAudioSource *>(clip.content());
+            if (clipSrc->status() == FutureAudioSource::Ready)
+                return true;
+            // Only the part of the clip to read is required to be available
+            auto clipStartPos = d->clipStartPosDict.value(d->clipKeyDict.value(clip.content()));
+            auto requiredLength = clipStartPos + qMin(from + length, clip.position() + clip.length()) - clip.position();
+            if (clipSrc->lengthAvailable() < requiredLength) {
                 flag = false;
                 return false;
             }
@@ -333,10 +578,10 @@ namespace talcs {
      * @see pauseRequired(), resumeRequired()
      *
      * @var FutureAudioSourceClipSeries::Skip
-     * The unready clip is skipped.
+     * The unready part of clips is skipped.
      *
      * @var FutureAudioSourceClipSeries::Block
-     * Waits for the unready clip to finish.
+     * Waits for the unready part of clips to read to be available.
      */
 
     /**
@@ -368,6 +613,51 @@ namespace talcs {
         return d->bufferingTarget;
     }
 
+    /**
+     * Sets the maximum number of clips whose content is prepared at the same time.
+     *
+     * By default (0), the series does not interfere with the preparation. If set to a positive value, the unfinished
+     * clips are ranked by how soon they are going to be read from the read position (clips in the hinted looping
+     * range are read again after the loop wraps), and only the first @p count of them keep running, together with all
+     * clips read by the next block, e.g. overlapping clips. The others are paused with FutureAudioSource::pause(), and
+     * resumed when they move up in the ranking. This takes control of pausing and resuming of all clip contents, so
+     * that the clips to be played soon always get the CPU first.
+     *
+     * A clip that is still paused when it is read is never waited for, even in Block mode. Its unready part is skipped,
+     * and the clip is resumed by the next re-ranking.
+     *
+     * The clips are re-ranked when they change, and as the read position moves by a timer on the thread of this object,
+     * so that reading and seeking, which may happen on the audio thread, never pause or resume a future. Therefore,
+     * this function should be called on the thread of this object.
+     *
+     * Note that pausing only takes effect if the future supports suspension, e.g. it is reported by a
+     * QFutureInterface that checks whether it is paused.
+     */
+    void FutureAudioSourceClipSeries::setMaxConcurrentRenderCount(int count) {
+        Q_D(FutureAudioSourceClipSeries);
+        QMutexLocker locker(&d->mutex);
+        count = qMax(0, count);
+        if (count == d->maxConcurrentRenderCount)
+            return;
+        if (count == 0) {
+            d->releaseAllRendering();
+            d->prioritizingTimer->stop();
+        } else {
+            d->prioritizingTimer->start();
+        }
+        d->maxConcurrentRenderCount = count;
+        d->prioritizeRendering(d->position, true);
+    }
+
+    /**
+     * Gets the maximum number of clips whose content is prepared at the same time.
+     * @see setMaxConcurrentRenderCount()
+     */
+    int FutureAudioSourceClipSeries::maxConcurrentRenderCount() const {
+        Q_D(const FutureAudioSourceClipSeries);
+        return d->maxConcurrentRenderCount;
+    }
+
     /**
      * @fn void FutureAudioSourceClipSeries::progressChanged(qint64 lengthAvailable, qint64 lengthLoaded, qint64 lengthOfAllClips, qint64 effectiveLength)
      * Emitted when one of these parameters are changed.
@@ -22,6 +22,7 @@
 
 #include <QMap>
 #include <QMutex>
+#include <QTimer>
 
 #include <TalcsCore/private/AudioSourceClipSeries_p.h>
 #include <TalcsCore/private/PositionableAudioSource_p.h>
@@ -33,7 +34,7 @@ namespace talcs {
         Q_DECLARE_PUBLIC(FutureAudioSourceClipSeries)
     public:
         FutureAudioSourceClipSeriesPrivate();
-        QMutex mutex;
+        mutable QMutex mutex;
         FutureAudioSourceClipSeries::ReadMode readMode = FutureAudioSourceClipSeries::Notify;
         qint64 cachedLengthAvailable = 0;
         qint64 cachedLengthLoaded = 0;
@@ -59,6 +60,16 @@ namespace talcs {
         };
         void checkAndNotify(qint64 position, qint64 length, NotifyPurpose purpose);
         void checkAndNotify(NotifyPurpose purpose);
+
+        // Only the unfinished clips closest to the read position are kept running, and the others are paused. The
+        // ranking follows the read position by a timer, so that the audio thread never pauses or resumes a future.
+        int maxConcurrentRenderCount = 0;
+        QTimer *prioritizingTimer = nullptr;
+        qint64 lastPrioritizedPosition = std::numeric_limits<qint64>::min();
+        qint64 renderDistance(const ClipInterval &clip, qint64 position_) const;
+        void prioritizeRendering(qint64 position_, bool force = false);
+        void releaseRendering(FutureAudioSource *content) const;
+        void releaseAllRendering() const;
     };
     
 }
@@ -21,6 +21,8 @@
 #define TALCS_FUTUREAUDIOSOURCE_P_H
 
 #include <QFutureWatcher>
+#include <QMutex>
+#include <QWaitCondition>
 
 #include <TalcsCore/private/PositionableAudioSource_p.h>
 #include <TalcsCore/FutureAudioSource.h>
@@ -34,7 +36,12 @@ namespace talcs {
         FutureAudioSource::Callbacks callbacks;
         void _q_statusChanged(FutureAudioSource::Status status);
         PositionableAudioSource *src = nullptr;
+        PositionableAudioSource *streamingSource = nullptr;
         QMutex mutex;
+
+        QMutex lengthAvailableMutex;
+        QWaitCondition lengthAvailableChanged;
+        void notifyLengthAvailableChanged();
     };
     
 }
@@ -66,6 +66,7 @@ namespace talcs {
         auto oldBuffer = d->buffer.get();
         d->buffer.reset(newBuffer, takeOwnership);
         d->position = 0;
+        d->contentVersion.fetchAndAddRelaxed(1);
         return oldBuffer;
     }
 
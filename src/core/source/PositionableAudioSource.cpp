@@ -58,6 +58,73 @@ namespace talcs {
         d->position = pos;
     }
 
+    /**
+     * Gets the first position not before the specified position from which the source might produce non-empty audio.
+     * Returns @c std::numeric_limits<qint64>::max() if the source produces no audio after the position.
+     *
+     * Parent sources use this hint to skip reading a source in the ranges where it is known to be empty, only moving its
+     * read position instead. The result is allowed to be earlier than the actual position where the audio starts, but
+     * must never be later.
+     *
+     * The default implementation returns the specified position, i.e. the source is never considered empty.
+     *
+     * Note that for derived class that reimplement this function, it should be synchronized with read() function.
+     * @see isEmptyRange()
+     */
+    qint64 PositionableAudioSource::nextNonEmptyPosition(qint64 position) const {
+        return position;
+    }
+
+    /**
+     * Returns whether the source is known to produce no audio in the specified range.
+     * @see nextNonEmptyPosition()
+     */
+    bool PositionableAudioSource::isEmptyRange(qint64 position, qint64 length) const {
+        return length <= 0 || nextNonEmptyPosition(position) >= position + length;
+    }
+
+    /**
+     * Hints that the source is going to be played in a loop within the specified range, so that sources that cache audio
+     * can keep the beginning of the loop. Pass -1 to both values to clear the hint.
+     *
+     * Sources that contain other sources should propagate the hint to them, with the range mapped to their positions.
+     *
+     * The default implementation only stores the range.
+     * @param l the left-close start of range
+     * @param r the right-open end of range
+     * @see TransportAudioSource::setLoopingRange()
+     */
+    void PositionableAudioSource::setLoopingRangeHint(qint64 l, qint64 r) {
+        Q_D(PositionableAudioSource);
+        d->loopingStartHint = l;
+        d->loopingEndHint = r;
+    }
+
+    /**
+     * Gets the hinted looping range.
+     * @see setLoopingRangeHint()
+     */
+    QPair<qint64, qint64> PositionableAudioSource::loopingRangeHint() const {
+        Q_D(const PositionableAudioSource);
+        return {d->loopingStartHint, d->loopingEndHint};
+    }
+
+    /**
+     * Gets a number that changes whenever the audio of the source changes, i.e. reading the same position again might
+     * produce different audio. Sources that cache the audio read, like BufferingAudioSource, discard the cache when it
+     * changes.
+     *
+     * Sources that contain other sources should combine the content versions of them. Live parameters that are applied
+     * while reading, such as the gain of a mixer, are part of the content as well.
+     *
+     * The default implementation returns a counter that derived classes in this library increase on changes, which is 0
+     * if the source never changes.
+     */
+    quint64 PositionableAudioSource::contentVersion() const {
+        Q_D(const PositionableAudioSource);
+        return d->contentVersion.loadRelaxed();
+    }
+
     PositionableAudioSourceStateSaver::PositionableAudioSourceStateSaver(PositionableAudioSource *src)
         : d(new PositionableAudioSourceStateSaverPrivate{src, src ? src->nextReadPosition() : 0}) {
     }
@@ -35,6 +35,14 @@ namespace talcs {
         virtual qint64 nextReadPosition() const;
         virtual void setNextReadPosition(qint64 pos);
 
+        virtual qint64 nextNonEmptyPosition(qint64 position) const;
+        bool isEmptyRange(qint64 position, qint64 length) const;
+
+        virtual void setLoopingRangeHint(qint64 l, qint64 r);
+        QPair<qint64, qint64> loopingRangeHint() const;
+
+        virtual quint64 contentVersion() const;
+
     protected:
         explicit PositionableAudioSource(PositionableAudioSourcePrivate &d);
     };
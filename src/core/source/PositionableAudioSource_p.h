@@ -20,15 +20,25 @@
 #ifndef TALCS_POSITIONABLEAUDIOSOURCE_P_H
 #define TALCS_POSITIONABLEAUDIOSOURCE_P_H
 
+#include <QAtomicInteger>
+
 #include <TalcsCore/PositionableAudioSource.h>
 #include <TalcsCore/private/AudioSource_p.h>
 
 namespace talcs {
 
+    // Mixes the content version of a contained source into that of the container
+    static inline quint64 combineContentVersion(quint64 version, quint64 childVersion) {
+        return (version * 1099511628211ull) ^ childVersion;
+    }
+
     class PositionableAudioSourcePrivate : public AudioSourcePrivate {
         Q_DECLARE_PUBLIC(PositionableAudioSource)
     public:
         qint64 position = 0;
+        qint64 loopingStartHint = -1;
+        qint64 loopingEndHint = -1;
+        QAtomicInteger<quint64> contentVersion = 0;
     };
 
     class PositionableAudioSourceStateSaverPrivate {
@@ -127,12 +127,75 @@ namespace talcs {
         PositionableAudioSource::setNextReadPosition(pos);
     }
 
+    /**
+     * @copydoc PositionableAudioSource::nextNonEmptyPosition()
+     *
+     * The result is the earliest one of all input sources that are not muted by solo setting. Input sources that are
+     * empty in a block are not read, and only their read positions are moved.
+     *
+     * If the level meter is enabled, the mixer is never considered empty, so that levelMetered() keeps being emitted.
+     */
+    qint64 PositionableMixerAudioSource::nextNonEmptyPosition(qint64 position) const {
+        Q_D(const PositionableMixerAudioSource);
+        QMutexLocker locker(&d->mutex);
+        auto ret = std::numeric_limits<qint64>::max();
+        if (!d->currentMagnitudes.empty())
+            return position;
+        if (d->silentFlags == -1)
+            return ret;
+        for (auto src : d->sourceList) {
+            if (d->isMutedBySoloSetting(src))
+                continue;
+            ret = qMin(ret, src->nextNonEmptyPosition(position));
+            if (ret <= position)
+                break;
+        }
+        return ret;
+    }
+
+    /**
+     * @copydoc PositionableAudioSource::contentVersion()
+     *
+     * The version changes when the sources or the mixing parameters change, or when the content of any source changes.
+     */
+    quint64 PositionableMixerAudioSource::contentVersion() const {
+        Q_D(const PositionableMixerAudioSource);
+        QMutexLocker locker(&d->mutex);
+        auto version = d->contentVersion.loadRelaxed();
+        for (auto src : d->sourceList)
+            version = combineContentVersion(version, src->contentVersion());
+        return version;
+    }
+
+    // Sources that are empty in the looping range do not need to cache its beginning, so the hint is cleared for them
+    void PositionableMixerAudioSourcePrivate::propagateLoopingRangeHint(PositionableAudioSource *src) const {
+        if (loopingStartHint >= 0 && loopingEndHint > loopingStartHint && !src->isEmptyRange(loopingStartHint, loopingEndHint - loopingStartHint))
+            src->setLoopingRangeHint(loopingStartHint, loopingEndHint);
+        else
+            src->setLoopingRangeHint(-1, -1);
+    }
+
+    /**
+     * @copydoc PositionableAudioSource::setLoopingRangeHint()
+     *
+     * The range is propagated to the sources in the mixer that are not empty in it, and cleared for the others.
+     */
+    void PositionableMixerAudioSource::setLoopingRangeHint(qint64 l, qint64 r) {
+        Q_D(PositionableMixerAudioSource);
+        QMutexLocker locker(&d->mutex);
+        PositionableAudioSource::setLoopingRangeHint(l, r);
+        for (auto src : d->sourceList)
+            d->propagateLoopingRangeHint(src);
+    }
+
     bool PositionableMixerAudioSource::addSource(PositionableAudioSource *src, bool takeOwnership) {
         if (src == this)
             return false;
         Q_D(PositionableMixerAudioSource);
         QMutexLocker locker(&d->mutex);
+        d->contentVersion.fetchAndAddRelaxed(1);
         src->setNextReadPosition(nextReadPosition());
+        d->propagateLoopingRangeHint(src);
         return d->addSource(src, takeOwnership, isOpen(), bufferSize(), sampleRate());
     }
 
@@ -140,7 +203,9 @@ namespace talcs {
     PositionableMixerAudioSource::appendSource(PositionableAudioSource *src, bool takeOwnership) {
         Q_D(PositionableMixerAudioSource);
         QMutexLocker locker(&d->mutex);
+        d->contentVersion.fetchAndAddRelaxed(1);
         src->setNextReadPosition(nextReadPosition());
+        d->propagateLoopingRangeHint(src);
         return d->insertSource(d->sourceIteratorEnd(), src, takeOwnership, isOpen(), bufferSize(), sampleRate());
     }
 
@@ -148,7 +213,9 @@ namespace talcs {
     PositionableMixerAudioSource::prependSource(PositionableAudioSource *src, bool takeOwnership) {
         Q_D(PositionableMixerAudioSource);
         QMutexLocker locker(&d->mutex);
+        d->contentVersion.fetchAndAddRelaxed(1);
         src->setNextReadPosition(nextReadPosition());
+        d->propagateLoopingRangeHint(src);
         return d->insertSource(d->firstSource(), src, takeOwnership, isOpen(), bufferSize(), sampleRate());
     }
 
@@ -157,31 +224,37 @@ namespace talcs {
                                                PositionableAudioSource *src, bool takeOwnership) {
         Q_D(PositionableMixerAudioSource);
         QMutexLocker locker(&d->mutex);
+        d->contentVersion.fetchAndAddRelaxed(1);
         src->setNextReadPosition(nextReadPosition());
+        d->propagateLoopingRangeHint(src);
         return d->insertSource(pos, src, takeOwnership, isOpen(), bufferSize(), sampleRate());
     }
 
     bool PositionableMixerAudioSource::removeSource(PositionableAudioSource *src) {
         Q_D(PositionableMixerAudioSource);
         QMutexLocker locker(&d->mutex);
+        d->contentVersion.fetchAndAddRelaxed(1);
         return d->removeSource(src);
     }
 
     void PositionableMixerAudioSource::eraseSource(const PositionableMixerAudioSource::SourceIterator &srcIt) {
         Q_D(PositionableMixerAudioSource);
         QMutexLocker locker(&d->mutex);
+        d->contentVersion.fetchAndAddRelaxed(1);
         d->eraseSource(srcIt);
     }
 
     void PositionableMixerAudioSource::removeAllSources() {
         Q_D(PositionableMixerAudioSource);
         QMutexLocker locker(&d->mutex);
+        d->contentVersion.fetchAndAddRelaxed(1);
         d->removeAllSources();
     }
 
     void PositionableMixerAudioSource::moveSource(const PositionableMixerAudioSource::SourceIterator &pos, const SourceIterator &first, const SourceIterator &last) {
         Q_D(PositionableMixerAudioSource);
         QMutexLocker locker(&d->mutex);
+        d->contentVersion.fetchAndAddRelaxed(1);
         d->moveSource(pos, first, last);
     }
 
@@ -189,6 +262,7 @@ namespace talcs {
                                                   const PositionableMixerAudioSource::SourceIterator &second) {
         Q_D(PositionableMixerAudioSource);
         QMutexLocker locker(&d->mutex);
+        d->contentVersion.fetchAndAddRelaxed(1);
         d->swapSource(first, second);
     }
 
@@ -226,6 +300,7 @@ namespace talcs {
     void PositionableMixerAudioSource::setSourceSolo(PositionableAudioSource *src, bool isSolo) {
         Q_D(PositionableMixerAudioSource);
         QMutexLocker locker(&d->mutex);
+        d->contentVersion.fetchAndAddRelaxed(1);
         d->setSourceSolo(src, isSolo);
     }
 
@@ -242,6 +317,7 @@ namespace talcs {
     void PositionableMixerAudioSource::setGain(float gain) {
         Q_D(PositionableMixerAudioSource);
         QMutexLocker locker(&d->mutex);
+        d->contentVersion.fetchAndAddRelaxed(1);
         d->gain = gain;
     }
 
@@ -253,6 +329,7 @@ namespace talcs {
     void PositionableMixerAudioSource::setPan(float pan) {
         Q_D(PositionableMixerAudioSource);
         QMutexLocker locker(&d->mutex);
+        d->contentVersion.fetchAndAddRelaxed(1);
         d->pan = pan;
     }
 
@@ -264,6 +341,7 @@ namespace talcs {
     void PositionableMixerAudioSource::setRouteChannels(bool routeChannels) {
         Q_D(PositionableMixerAudioSource);
         QMutexLocker locker(&d->mutex);
+        d->contentVersion.fetchAndAddRelaxed(1);
         d->routeChannels = routeChannels;
     }
 
@@ -275,6 +353,7 @@ namespace talcs {
     void PositionableMixerAudioSource::setSilentFlags(int silentFlags) {
         Q_D(PositionableMixerAudioSource);
         QMutexLocker locker(&d->mutex);
+        d->contentVersion.fetchAndAddRelaxed(1);
         d->silentFlags = silentFlags;
     }
 
@@ -40,6 +40,9 @@ namespace talcs {
         void close() override;
         qint64 length() const override;
         void setNextReadPosition(qint64 pos) override;
+        qint64 nextNonEmptyPosition(qint64 position) const override;
+        void setLoopingRangeHint(qint64 l, qint64 r) override;
+        quint64 contentVersion() const override;
 
         bool addSource(PositionableAudioSource *src, bool takeOwnership = false) override;
         SourceIterator appendSource(PositionableAudioSource *src, bool takeOwnership = false) override;
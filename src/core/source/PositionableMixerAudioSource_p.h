@@ -32,6 +32,7 @@ namespace talcs {
         Q_DECLARE_PUBLIC(PositionableMixerAudioSource)
     public:
         void setNextReadPositionToAll(qint64 pos);
+        void propagateLoopingRangeHint(PositionableAudioSource *src) const;
     };
     
 }
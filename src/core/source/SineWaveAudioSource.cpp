@@ -95,6 +95,7 @@ namespace talcs {
         Q_D(SineWaveAudioSource);
         QMutexLocker locker(&d->mutex);
         d->freq = frequencyIntegration;
+        d->contentVersion.fetchAndAddRelaxed(1);
     }
 
     /**
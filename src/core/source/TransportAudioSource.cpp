@@ -61,7 +61,14 @@ namespace talcs {
 
     static inline void safeRead(IAudioSampleContainer *dest, qint64 destPos, qint64 length,
                                 PositionableAudioSource *src) {
-        src->read({dest, destPos, qBound(0ll, src->length() - src->nextReadPosition(), length)});
+        auto srcPosition = src->nextReadPosition();
+        length = qBound(0ll, src->length() - srcPosition, length);
+        // The destination is already cleared, so a source known to be empty here is skipped
+        if (src->isEmptyRange(srcPosition, length)) {
+            src->setNextReadPosition(srcPosition + length);
+            return;
+        }
+        src->read({dest, destPos, length});
     }
 
     static inline bool inRange(qint64 x, qint64 l, qint64 r) {
@@ -152,6 +159,7 @@ namespace talcs {
         QMutexLocker locker(&d->mutex);
         d->src.reset(src, takeOwnership);
         if (src) {
+            src->setLoopingRangeHint(d->loopingStart, d->loopingEnd);
             if (isOpen()) {
                 src->setNextReadPosition(d->position);
                 src->open(bufferSize(), sampleRate());
@@ -296,14 +304,19 @@ namespace talcs {
      * Note that the end of range should be greater than the start of range, otherwise the behavior will be quite wierd.
      *
      * If not to looping play, set both values to -1.
+     *
+     * The range is also hinted to the input source, so that it can keep the beginning of the loop ready.
      * @param l the left-close start of range
      * @param r the right-open end of range
+     * @see PositionableAudioSource::setLoopingRangeHint()
      */
     void TransportAudioSource::setLoopingRange(qint64 l, qint64 r) {
         Q_D(TransportAudioSource);
         QMutexLocker locker(&d->mutex);
         d->loopingStart = l;
         d->loopingEnd = r;
+        if (d->src)
+            d->src->setLoopingRangeHint(l, r);
     }
 
     void TransportAudioSourcePrivate::_q_positionAboutToChange(qint64 pos) {
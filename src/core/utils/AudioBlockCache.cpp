@@ -0,0 +1,284 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#include "AudioBlockCache.h"
+#include "AudioBlockCache_p.h"
+
+#include <TalcsCore/AudioCacheBudget.h>
+
+namespace talcs {
+
+    /**
+     * @class AudioBlockCache
+     * @brief A thread-safe LRU cache of decoded audio blocks
+     *
+     * Each block holds the audio of a fixed number of sample frames, and is identified by the identity of the audio
+     * (e.g. the path of the file), the sample rate and the index of the block. AudioFormatInputSource objects with the
+     * same cache key share the blocks of the global instance, so that a file referenced by several clips, or played
+     * repeatedly in a loop, is decoded and resampled only once.
+     *
+     * The cache registers itself with the global AudioCacheBudget. The least recently used blocks are evicted when the
+     * memory usage exceeds the memory cap or the limit set by the budget.
+     */
+
+    /**
+     * Constructor.
+     *
+     * Usually the global instance is used instead of constructing an object.
+     * @param blockSize the number of sample frames in a block
+     * @see globalInstance()
+     */
+    AudioBlockCache::AudioBlockCache(qint64 blockSize) : d_ptr(new AudioBlockCachePrivate) {
+        Q_D(AudioBlockCache);
+        Q_ASSERT(blockSize > 0);
+        d->q_ptr = this;
+        d->blockSize = blockSize;
+        AudioCacheBudget::globalInstance()->registerClient(this);
+    }
+
+    /**
+     * Destructor.
+     */
+    AudioBlockCache::~AudioBlockCache() {
+        AudioCacheBudget::globalInstance()->unregisterClient(this);
+    }
+
+    /**
+     * Gets the process-wide cache used by AudioFormatInputSource.
+     */
+    AudioBlockCache *AudioBlockCache::globalInstance() {
+        static AudioBlockCache instance;
+        return &instance;
+    }
+
+    /**
+     * Gets the number of sample frames in a block.
+     *
+     * The last block of the audio might be shorter.
+     */
+    qint64 AudioBlockCache::blockSize() const {
+        Q_D(const AudioBlockCache);
+        return d->blockSize;
+    }
+
+    /**
+     * Sets the maximum memory usage in bytes. Zero or a negative value means unlimited.
+     *
+     * The default value is 256 MiB.
+     */
+    void AudioBlockCache::setMemoryCap(qint64 bytes) {
+        Q_D(AudioBlockCache);
+        {
+            QMutexLocker locker(&d->mutex);
+            d->memoryCap.storeRelaxed(bytes);
+            d->evict();
+        }
+        AudioCacheBudget::globalInstance()->requestRebalance();
+    }
+
+    /**
+     * Gets the maximum memory usage in bytes.
+     */
+    qint64 AudioBlockCache::memoryCap() const {
+        Q_D(const AudioBlockCache);
+        return d->memoryCap.loadRelaxed();
+    }
+
+    /**
+     * Looks up a block.
+     *
+     * The block is implicitly shared with the cache, so it must not be written to.
+     * @param identity the identity of the audio
+     * @param sampleRate the sample rate of the block
+     * @param blockIndex the index of the block
+     * @param block the block is stored into this buffer if found
+     * @return @c true if found
+     */
+    bool AudioBlockCache::find(const QString &identity, double sampleRate, qint64 blockIndex, AudioBuffer &block) {
+        Q_D(AudioBlockCache);
+        QMutexLocker locker(&d->mutex);
+        auto it = d->entryDict.find({identity, sampleRate, blockIndex});
+        if (it == d->entryDict.end()) {
+            d->missCount++;
+            return false;
+        }
+        d->hitCount++;
+        d->entryList.splice(d->entryList.begin(), d->entryList, it.value());
+        block = it.value()->block;
+        return true;
+    }
+
+    /**
+     * Inserts a block. If the block already exists, it is replaced.
+     *
+     * The block is implicitly shared with the cache, so the caller should not write to it afterwards.
+     */
+    void AudioBlockCache::insert(const QString &identity, double sampleRate, qint64 blockIndex,
+                                 const AudioBuffer &block) {
+        Q_D(AudioBlockCache);
+        QMutexLocker locker(&d->mutex);
+        AudioBlockCacheKey key = {identity, sampleRate, blockIndex};
+        auto it = d->entryDict.find(key);
+        if (it != d->entryDict.end())
+            d->removeEntry(it.value());
+        d->entryList.push_front({key, block});
+        d->entryDict.insert(key, d->entryList.begin());
+        d->memoryUsage.fetchAndAddRelaxed(AudioBlockCachePrivate::blockBytes(block));
+        d->evict();
+    }
+
+    /**
+     * Removes all blocks of the specified identity, e.g. when the file is modified.
+     */
+    void AudioBlockCache::remove(const QString &identity) {
+        Q_D(AudioBlockCache);
+        QMutexLocker locker(&d->mutex);
+        for (auto it = d->entryList.begin(); it != d->entryList.end();) {
+            auto next = std::next(it);
+            if (it->key.identity == identity)
+                d->removeEntry(it);
+            it = next;
+        }
+    }
+
+    /**
+     * Removes all blocks.
+     */
+    void AudioBlockCache::clear() {
+        Q_D(AudioBlockCache);
+        QMutexLocker locker(&d->mutex);
+        d->entryList.clear();
+        d->entryDict.clear();
+        d->memoryUsage.storeRelaxed(0);
+    }
+
+    /**
+     * @struct AudioBlockCache::Statistics
+     * @brief The statistics of the cache.
+     *
+     * @var AudioBlockCache::Statistics::hitCount
+     * The number of lookups that found the block.
+     *
+     * @var AudioBlockCache::Statistics::missCount
+     * The number of lookups that did not find the block.
+     *
+     * @var AudioBlockCache::Statistics::blockCount
+     * The number of blocks currently cached.
+     *
+     * @var AudioBlockCache::Statistics::memoryUsage
+     * The memory currently used by the blocks in bytes.
+     */
+
+    /**
+     * Gets the ratio of lookups that found the block, or zero if no lookup has been made.
+     */
+    double AudioBlockCache::Statistics::hitRate() const {
+        auto total = hitCount + missCount;
+        return total ? static_cast<double>(hitCount) / static_cast<double>(total) : 0.0;
+    }
+
+    /**
+     * Gets the statistics of the cache.
+     */
+    AudioBlockCache::Statistics AudioBlockCache::statistics() const {
+        Q_D(const AudioBlockCache);
+        QMutexLocker locker(&d->mutex);
+        return {d->hitCount, d->missCount, static_cast<qint64>(d->entryList.size()), d->memoryUsage.loadRelaxed()};
+    }
+
+    /**
+     * Resets the hit count and the miss count.
+     */
+    void AudioBlockCache::resetStatistics() {
+        Q_D(AudioBlockCache);
+        QMutexLocker locker(&d->mutex);
+        d->hitCount = 0;
+        d->missCount = 0;
+    }
+
+    /**
+     * @copydoc IAudioCacheClient::cacheMemoryUsage()
+     */
+    qint64 AudioBlockCache::cacheMemoryUsage() const {
+        Q_D(const AudioBlockCache);
+        return d->memoryUsage.loadRelaxed();
+    }
+
+    /**
+     * Returns the memory cap, or the current memory usage if the cap is unlimited.
+     */
+    qint64 AudioBlockCache::preferredCacheMemory() const {
+        Q_D(const AudioBlockCache);
+        auto memoryCap = d->memoryCap.loadRelaxed();
+        return memoryCap > 0 ? memoryCap : d->memoryUsage.loadRelaxed();
+    }
+
+    /**
+     * Returns zero, since every block can be decoded again.
+     */
+    qint64 AudioBlockCache::minimumCacheMemory() const {
+        return 0;
+    }
+
+    /**
+     * Returns zero. The cache is shared by all clips, and the blocks being read are the most recently used ones, so
+     * it is treated as being at the playhead.
+     */
+    qint64 AudioBlockCache::playheadDistance() const {
+        return 0;
+    }
+
+    /**
+     * @copydoc IAudioCacheClient::setCacheMemoryLimit()
+     */
+    void AudioBlockCache::setCacheMemoryLimit(qint64 bytes) {
+        Q_D(AudioBlockCache);
+        QMutexLocker locker(&d->mutex);
+        d->memoryLimit = bytes;
+        d->evict();
+    }
+
+    qint64 AudioBlockCachePrivate::effectiveLimit() const {
+        auto memoryCap_ = memoryCap.loadRelaxed();
+        if (memoryCap_ > 0 && memoryLimit >= 0)
+            return qMin(memoryCap_, memoryLimit);
+        if (memoryCap_ > 0)
+            return memoryCap_;
+        return memoryLimit;
+    }
+
+    void AudioBlockCachePrivate::evict() {
+        auto limit = effectiveLimit();
+        if (limit < 0)
+            return;
+        while (memoryUsage.loadRelaxed() > limit && !entryList.empty())
+            removeEntry(std::prev(entryList.end()));
+    }
+
+    void AudioBlockCachePrivate::removeEntry(std::list<Entry>::iterator it) {
+        memoryUsage.fetchAndSubRelaxed(blockBytes(it->block));
+        entryDict.remove(it->key);
+        entryList.erase(it);
+    }
+
+    qint64 AudioBlockCachePrivate::blockBytes(const AudioBuffer &block) {
+        return static_cast<qint64>(block.channelCount()) * block.sampleCount() * static_cast<qint64>(sizeof(float));
+    }
+
+}
@@ -0,0 +1,75 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#ifndef TALCS_AUDIOBLOCKCACHE_H
+#define TALCS_AUDIOBLOCKCACHE_H
+
+#include <QScopedPointer>
+#include <QString>
+
+#include <TalcsCore/IAudioCacheClient.h>
+
+namespace talcs {
+
+    class AudioBuffer;
+
+    class AudioBlockCachePrivate;
+
+    class TALCSCORE_EXPORT AudioBlockCache : public IAudioCacheClient {
+        Q_DECLARE_PRIVATE(AudioBlockCache)
+    public:
+        explicit AudioBlockCache(qint64 blockSize = 16384);
+        ~AudioBlockCache() override;
+
+        static AudioBlockCache *globalInstance();
+
+        qint64 blockSize() const;
+
+        void setMemoryCap(qint64 bytes);
+        qint64 memoryCap() const;
+
+        bool find(const QString &identity, double sampleRate, qint64 blockIndex, AudioBuffer &block);
+        void insert(const QString &identity, double sampleRate, qint64 blockIndex, const AudioBuffer &block);
+
+        void remove(const QString &identity);
+        void clear();
+
+        struct Statistics {
+            qint64 hitCount;
+            qint64 missCount;
+            qint64 blockCount;
+            qint64 memoryUsage;
+            double hitRate() const;
+        };
+        Statistics statistics() const;
+        void resetStatistics();
+
+        qint64 cacheMemoryUsage() const override;
+        qint64 preferredCacheMemory() const override;
+        qint64 minimumCacheMemory() const override;
+        qint64 playheadDistance() const override;
+        void setCacheMemoryLimit(qint64 bytes) override;
+
+    private:
+        QScopedPointer<AudioBlockCachePrivate> d_ptr;
+    };
+
+}
+
+#endif // TALCS_AUDIOBLOCKCACHE_H
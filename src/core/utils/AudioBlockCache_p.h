@@ -0,0 +1,80 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#ifndef TALCS_AUDIOBLOCKCACHE_P_H
+#define TALCS_AUDIOBLOCKCACHE_P_H
+
+#include <list>
+
+#include <QAtomicInteger>
+#include <QHash>
+#include <QMutex>
+
+#include <TalcsCore/AudioBlockCache.h>
+#include <TalcsCore/AudioBuffer.h>
+
+namespace talcs {
+
+    struct AudioBlockCacheKey {
+        QString identity;
+        double sampleRate;
+        qint64 blockIndex;
+
+        bool operator==(const AudioBlockCacheKey &other) const {
+            return blockIndex == other.blockIndex && sampleRate == other.sampleRate && identity == other.identity;
+        }
+    };
+
+    inline size_t qHash(const AudioBlockCacheKey &key, size_t seed = 0) {
+        return ::qHash(key.identity, seed) ^ ::qHash(key.blockIndex, seed) ^ ::qHash(qRound64(key.sampleRate), seed);
+    }
+
+    class AudioBlockCachePrivate {
+        Q_DECLARE_PUBLIC(AudioBlockCache)
+    public:
+        AudioBlockCache *q_ptr;
+
+        qint64 blockSize;
+        // Written with the mutex locked, and read without locking by AudioCacheBudget
+        QAtomicInteger<qint64> memoryCap = 256 * 1024 * 1024;
+        qint64 memoryLimit = -1;
+
+        mutable QMutex mutex;
+
+        struct Entry {
+            AudioBlockCacheKey key;
+            AudioBuffer block;
+        };
+        // The most recently used block is at the front
+        std::list<Entry> entryList;
+        QHash<AudioBlockCacheKey, std::list<Entry>::iterator> entryDict;
+
+        QAtomicInteger<qint64> memoryUsage = 0;
+        qint64 hitCount = 0;
+        qint64 missCount = 0;
+
+        qint64 effectiveLimit() const;
+        void evict();
+        void removeEntry(std::list<Entry>::iterator it);
+        static qint64 blockBytes(const AudioBuffer &block);
+    };
+
+}
+
+#endif // TALCS_AUDIOBLOCKCACHE_P_H
@@ -0,0 +1,217 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#include "AudioCacheBudget.h"
+#include "AudioCacheBudget_p.h"
+
+#include <algorithm>
+
+#include <QThreadPool>
+
+#include <TalcsCore/IAudioCacheClient.h>
+
+namespace talcs {
+
+    /**
+     * @class AudioCacheBudget
+     * @brief The memory budget shared by audio caches
+     *
+     * Audio caches, such as the buffers of BufferingAudioSource, register with the budget as IAudioCacheClient
+     * objects. When the memory preferred by all clients exceeds the budget, the clients closest to the playhead keep
+     * their preferred memory, and the distant ones are shrunk down to their minimum memory, or evicted.
+     *
+     * By default, the budget is unlimited.
+     */
+
+    /**
+     * Constructor.
+     *
+     * Usually the global instance is used instead of constructing an object.
+     * @see globalInstance()
+     */
+    AudioCacheBudget::AudioCacheBudget() : d_ptr(new AudioCacheBudgetPrivate) {
+    }
+
+    /**
+     * Destructor.
+     */
+    AudioCacheBudget::~AudioCacheBudget() = default;
+
+    /**
+     * Gets the process-wide budget, with which BufferingAudioSource objects are registered.
+     */
+    AudioCacheBudget *AudioCacheBudget::globalInstance() {
+        static AudioCacheBudget instance;
+        return &instance;
+    }
+
+    /**
+     * Sets the budget in bytes. Zero or a negative value means unlimited.
+     */
+    void AudioCacheBudget::setBudget(qint64 bytes) {
+        Q_D(AudioCacheBudget);
+        {
+            QMutexLocker locker(&d->mutex);
+            if (bytes == d->budget)
+                return;
+            d->budget = bytes;
+        }
+        rebalance();
+    }
+
+    /**
+     * Gets the budget in bytes.
+     */
+    qint64 AudioCacheBudget::budget() const {
+        Q_D(const AudioCacheBudget);
+        QMutexLocker locker(&d->mutex);
+        return d->budget;
+    }
+
+    /**
+     * Registers a client. The client is not limited until the next rebalancing.
+     */
+    void AudioCacheBudget::registerClient(IAudioCacheClient *client) {
+        Q_D(AudioCacheBudget);
+        QMutexLocker locker(&d->mutex);
+        d->clientLimits.insert(client, -1);
+    }
+
+    /**
+     * Unregisters a client.
+     *
+     * This function waits for the ongoing rebalancing, so it must not be called while holding a lock that
+     * IAudioCacheClient::setCacheMemoryLimit() acquires.
+     */
+    void AudioCacheBudget::unregisterClient(IAudioCacheClient *client) {
+        Q_D(AudioCacheBudget);
+        QMutexLocker rebalanceLocker(&d->rebalanceMutex);
+        QMutexLocker locker(&d->mutex);
+        d->clientLimits.remove(client);
+    }
+
+    /**
+     * @struct AudioCacheBudget::ClientUsage
+     * @brief The memory usage of a client.
+     *
+     * @var AudioCacheBudget::ClientUsage::client
+     * The client.
+     *
+     * @var AudioCacheBudget::ClientUsage::usage
+     * The memory currently allocated in bytes.
+     *
+     * @var AudioCacheBudget::ClientUsage::limit
+     * The limit set at the last rebalancing, or -1 if unlimited.
+     *
+     * @var AudioCacheBudget::ClientUsage::playheadDistance
+     * The distance from the playhead reported by the client.
+     */
+
+    /**
+     * Gets the memory usage of each client.
+     */
+    QList<AudioCacheBudget::ClientUsage> AudioCacheBudget::clientUsage() const {
+        Q_D(const AudioCacheBudget);
+        QMutexLocker locker(&d->mutex);
+        QList<ClientUsage> ret;
+        for (auto it = d->clientLimits.cbegin(); it != d->clientLimits.cend(); it++)
+            ret.append({it.key(), it.key()->cacheMemoryUsage(), it.value(), it.key()->playheadDistance()});
+        return ret;
+    }
+
+    /**
+     * Gets the memory usage of all clients in bytes.
+     */
+    qint64 AudioCacheBudget::totalUsage() const {
+        Q_D(const AudioCacheBudget);
+        QMutexLocker locker(&d->mutex);
+        qint64 ret = 0;
+        for (auto it = d->clientLimits.cbegin(); it != d->clientLimits.cend(); it++)
+            ret += it.key()->cacheMemoryUsage();
+        return ret;
+    }
+
+    /**
+     * Distributes the budget to the clients on the current thread.
+     *
+     * Every client gets its minimum memory. Then the rest of the budget is given to the clients in ascending order of
+     * their distance from the playhead, until it runs out.
+     * @see requestRebalance()
+     */
+    void AudioCacheBudget::rebalance() {
+        Q_D(AudioCacheBudget);
+        QMutexLocker rebalanceLocker(&d->rebalanceMutex);
+        d->isRebalanceRequested = false;
+        struct ClientInfo {
+            IAudioCacheClient *client;
+            qint64 distance;
+            qint64 minimum;
+            qint64 preferred;
+            qint64 oldLimit;
+        };
+        QList<ClientInfo> clients;
+        qint64 budget;
+        {
+            QMutexLocker locker(&d->mutex);
+            budget = d->budget;
+            // The getters of the clients return snapshots without locking, so the audio thread is not involved here
+            for (auto it = d->clientLimits.cbegin(); it != d->clientLimits.cend(); it++) {
+                auto client = it.key();
+                auto minimum = client->minimumCacheMemory();
+                clients.append({client, client->playheadDistance(), minimum, qMax(minimum, client->preferredCacheMemory()), it.value()});
+            }
+        }
+        std::stable_sort(clients.begin(), clients.end(), [](const ClientInfo &a, const ClientInfo &b) {
+            return a.distance < b.distance;
+        });
+        qint64 remaining = budget;
+        for (const auto &info : clients)
+            remaining -= info.minimum;
+        for (const auto &info : clients) {
+            qint64 limit = -1;
+            if (budget > 0) {
+                auto extra = qBound(0ll, info.preferred - info.minimum, qMax(0ll, remaining));
+                remaining -= extra;
+                limit = info.minimum + extra;
+            }
+            if (limit == info.oldLimit)
+                continue;
+            info.client->setCacheMemoryLimit(limit);
+            QMutexLocker locker(&d->mutex);
+            if (d->clientLimits.contains(info.client))
+                d->clientLimits.insert(info.client, limit);
+        }
+    }
+
+    /**
+     * Requests rebalancing in the global thread pool. Multiple requests before the rebalancing starts are merged.
+     *
+     * Clients should call this function instead of rebalance() when their preferred memory or distance from the
+     * playhead changes, since it does not block.
+     */
+    void AudioCacheBudget::requestRebalance() {
+        Q_D(AudioCacheBudget);
+        if (!d->isRebalanceRequested.testAndSetOrdered(false, true))
+            return;
+        QThreadPool::globalInstance()->start([this] {
+            rebalance();
+        });
+    }
+
+}
@@ -0,0 +1,66 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#ifndef TALCS_AUDIOCACHEBUDGET_H
+#define TALCS_AUDIOCACHEBUDGET_H
+
+#include <QList>
+#include <QScopedPointer>
+
+#include <TalcsCore/TalcsCoreGlobal.h>
+
+namespace talcs {
+
+    class IAudioCacheClient;
+
+    class AudioCacheBudgetPrivate;
+
+    class TALCSCORE_EXPORT AudioCacheBudget {
+        Q_DECLARE_PRIVATE(AudioCacheBudget)
+    public:
+        AudioCacheBudget();
+        ~AudioCacheBudget();
+
+        static AudioCacheBudget *globalInstance();
+
+        void setBudget(qint64 bytes);
+        qint64 budget() const;
+
+        void registerClient(IAudioCacheClient *client);
+        void unregisterClient(IAudioCacheClient *client);
+
+        struct ClientUsage {
+            IAudioCacheClient *client;
+            qint64 usage;
+            qint64 limit;
+            qint64 playheadDistance;
+        };
+        QList<ClientUsage> clientUsage() const;
+        qint64 totalUsage() const;
+
+        void rebalance();
+        void requestRebalance();
+
+    private:
+        QScopedPointer<AudioCacheBudgetPrivate> d_ptr;
+    };
+
+}
+
+#endif // TALCS_AUDIOCACHEBUDGET_H
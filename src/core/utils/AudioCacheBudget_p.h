@@ -0,0 +1,44 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#ifndef TALCS_AUDIOCACHEBUDGET_P_H
+#define TALCS_AUDIOCACHEBUDGET_P_H
+
+#include <QAtomicInteger>
+#include <QHash>
+#include <QMutex>
+
+#include <TalcsCore/AudioCacheBudget.h>
+
+namespace talcs {
+
+    class AudioCacheBudgetPrivate {
+    public:
+        // Guards the client list. Rebalancing holds the rebalance mutex, so that a client is not unregistered while it
+        // is being limited.
+        mutable QMutex mutex;
+        QMutex rebalanceMutex;
+        QHash<IAudioCacheClient *, qint64> clientLimits;
+        qint64 budget = 0;
+        QAtomicInteger<bool> isRebalanceRequested = false;
+    };
+
+}
+
+#endif // TALCS_AUDIOCACHEBUDGET_P_H
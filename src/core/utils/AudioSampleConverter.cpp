@@ -19,11 +19,20 @@
 
 #include "AudioSampleConverter.h"
 
+#include <algorithm>
 #include <limits>
 
 #include <QSysInfo>
 #include <QtEndian>
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#   define TALCS_DEINTERLEAVE_SSE
+#   include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   define TALCS_DEINTERLEAVE_NEON
+#   include <arm_neon.h>
+#endif
+
 namespace talcs {
 
     static constexpr double factor16 = static_cast<double>(0x7fffL) + 0.49999;
@@ -148,5 +157,51 @@ namespace talcs {
         while (--length >= 0)
             *p++ = isLittleEndian ? qToLittleEndian(*src++) : qToBigEndian(*src++);
     }
+
+    /**
+     * Splits interleaved samples into channels.
+     *
+     * Stereo audio, the most common case, is deinterleaved with SIMD instructions where available.
+     * @param dest the pointers to the pre-allocated destination memory of each channel
+     * @param src the pointer to interleaved source samples
+     * @param channelCount the number of channels
+     * @param length the number of samples of each channel
+     */
+    void AudioSampleConverter::deinterleave(float *const *dest, const float *src, int channelCount, qint64 length) {
+        if (channelCount == 1) {
+            std::copy_n(src, length, dest[0]);
+            return;
+        }
+        if (channelCount == 2) {
+            auto l = dest[0];
+            auto r = dest[1];
+            qint64 i = 0;
+#if defined(TALCS_DEINTERLEAVE_SSE)
+            for (; i + 4 <= length; i += 4) {
+                auto a = _mm_loadu_ps(src + 2 * i);
+                auto b = _mm_loadu_ps(src + 2 * i + 4);
+                _mm_storeu_ps(l + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+                _mm_storeu_ps(r + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+            }
+#elif defined(TALCS_DEINTERLEAVE_NEON)
+            for (; i + 4 <= length; i += 4) {
+                auto v = vld2q_f32(src + 2 * i);
+                vst1q_f32(l + i, v.val[0]);
+                vst1q_f32(r + i, v.val[1]);
+            }
+#endif
+            for (; i < length; i++) {
+                l[i] = src[2 * i];
+                r[i] = src[2 * i + 1];
+            }
+            return;
+        }
+        for (int ch = 0; ch < channelCount; ch++) {
+            auto p = dest[ch];
+            auto q = src + ch;
+            for (qint64 i = 0; i < length; i++, q += channelCount)
+                p[i] = *q;
+        }
+    }
     
 }
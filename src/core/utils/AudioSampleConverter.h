@@ -31,6 +31,8 @@ namespace talcs {
         static void convertToInt32(void *dest, const float *src, qint64 length, bool isLittleEndian, bool restrictRange = false);
         static void convertToFloat32(void *dest, const float *src, qint64 length, bool isLittleEndian);
         static void convertToFloat64(void *dest, const float *src, qint64 length, bool isLittleEndian);
+
+        static void deinterleave(float *const *dest, const float *src, int channelCount, qint64 length);
     };
     
 }
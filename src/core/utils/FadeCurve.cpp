@@ -0,0 +1,155 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#include "FadeCurve.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#   define TALCS_FADECURVE_SSE
+#   include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   define TALCS_FADECURVE_NEON
+#   include <arm_neon.h>
+#endif
+
+namespace talcs {
+
+    namespace {
+        struct FadeCurveTables {
+            static constexpr double PI = 3.14159265358979323846;
+            FadeCurveTables() {
+                for (int i = 0; i <= FadeCurve::TableSize; i++) {
+                    double x = double(i) / FadeCurve::TableSize;
+                    data[FadeCurve::Linear][i] = static_cast<float>(x);
+                    data[FadeCurve::EqualPower][i] = static_cast<float>(std::sin(x * PI / 2));
+                    data[FadeCurve::SCurve][i] = static_cast<float>(0.5 - 0.5 * std::cos(x * PI));
+                }
+                // Pad one more entry so that interpolating at x = 1 does not need a branch
+                for (auto &table : data)
+                    table[FadeCurve::TableSize + 1] = table[FadeCurve::TableSize];
+            }
+            float data[3][FadeCurve::TableSize + 2];
+        };
+
+        const FadeCurveTables &fadeCurveTables() {
+            static FadeCurveTables tables;
+            return tables;
+        }
+
+        inline void fillRamp(float *dest, qint64 length, double x0, double dx, const float *table) {
+            const auto scale = static_cast<float>(FadeCurve::TableSize);
+            const auto t0 = static_cast<float>(x0) * scale;
+            const auto dt = static_cast<float>(dx) * scale;
+            for (qint64 i = 0; i < length; i++) {
+                float t = std::clamp(t0 + dt * static_cast<float>(i), 0.0f, scale);
+                int idx = static_cast<int>(t);
+                float frac = t - static_cast<float>(idx);
+                dest[i] = table[idx] + frac * (table[idx + 1] - table[idx]);
+            }
+        }
+
+        inline void multiplyGains(float *dest, const float *gains, qint64 length) {
+            qint64 i = 0;
+#if defined(TALCS_FADECURVE_SSE)
+            for (; i + 4 <= length; i += 4)
+                _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_loadu_ps(dest + i), _mm_loadu_ps(gains + i)));
+#elif defined(TALCS_FADECURVE_NEON)
+            for (; i + 4 <= length; i += 4)
+                vst1q_f32(dest + i, vmulq_f32(vld1q_f32(dest + i), vld1q_f32(gains + i)));
+#endif
+            for (; i < length; i++)
+                dest[i] *= gains[i];
+        }
+
+        // The gains of a block are interpolated from the table first, since the table lookup cannot be vectorized
+        constexpr qint64 RAMP_BLOCK_SIZE = 256;
+    }
+
+    /**
+     * @class FadeCurve
+     * @brief Precomputed gain curves for fading.
+     *
+     * The curves are stored in lookup tables shared by the whole process, which are built once on first use. Each curve
+     * maps the normalized position @c x in [0, 1] to a gain in [0, 1], rising from 0 at @c x = 0 to 1 at @c x = 1. A
+     * fade-out is produced by walking the same curve backwards.
+     */
+
+    /**
+     * @enum FadeCurve::Shape
+     * The shape of the curve.
+     *
+     * @var FadeCurve::Linear
+     * The gain changes linearly. Two complementary linear fades sum to unity amplitude.
+     *
+     * @var FadeCurve::EqualPower
+     * Quarter sine. Two complementary equal-power fades sum to unity power, which is suitable for crossfading
+     * uncorrelated audio.
+     *
+     * @var FadeCurve::SCurve
+     * Raised cosine. Starts and ends smoothly.
+     */
+
+    /**
+     * Gets the lookup table of a specified shape.
+     *
+     * The table contains TableSize + 2 entries, where entry @c i is the gain at @c x = i / TableSize and the last
+     * entry is a copy of the previous one.
+     */
+    const float *FadeCurve::table(FadeCurve::Shape shape) {
+        return fadeCurveTables().data[shape];
+    }
+
+    /**
+     * Gets the gain at a specified normalized position.
+     *
+     * Positions outside [0, 1] are clamped.
+     */
+    float FadeCurve::gainAt(FadeCurve::Shape shape, double x) {
+        float gain;
+        fillRamp(&gain, 1, x, 0, table(shape));
+        return gain;
+    }
+
+    /**
+     * Fills a gain curve into a buffer.
+     *
+     * The @c i-th sample is set to the gain at position <tt>x0 + i * dx</tt>. A negative @p dx produces a fade-out.
+     */
+    void FadeCurve::fill(float *dest, qint64 length, double x0, double dx, FadeCurve::Shape shape) {
+        fillRamp(dest, length, x0, dx, table(shape));
+    }
+
+    /**
+     * Multiplies the samples in a buffer by a gain curve.
+     *
+     * The @c i-th sample is multiplied by the gain at position <tt>x0 + i * dx</tt>. A negative @p dx produces a
+     * fade-out.
+     */
+    void FadeCurve::multiply(float *dest, qint64 length, double x0, double dx, FadeCurve::Shape shape) {
+        float gains[RAMP_BLOCK_SIZE];
+        for (qint64 offset = 0; offset < length; offset += RAMP_BLOCK_SIZE) {
+            auto blockLength = qMin(RAMP_BLOCK_SIZE, length - offset);
+            fillRamp(gains, blockLength, x0 + dx * static_cast<double>(offset), dx, table(shape));
+            multiplyGains(dest + offset, gains, blockLength);
+        }
+    }
+
+}
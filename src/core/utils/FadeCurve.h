@@ -0,0 +1,46 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#ifndef TALCS_FADECURVE_H
+#define TALCS_FADECURVE_H
+
+#include <TalcsCore/TalcsCoreGlobal.h>
+
+namespace talcs {
+
+    class TALCSCORE_EXPORT FadeCurve {
+    public:
+        enum Shape {
+            Linear,
+            EqualPower,
+            SCurve,
+        };
+
+        static constexpr int TableSize = 4096;
+
+        static const float *table(Shape shape);
+        static float gainAt(Shape shape, double x);
+
+        static void fill(float *dest, qint64 length, double x0, double dx, Shape shape);
+        static void multiply(float *dest, qint64 length, double x0, double dx, Shape shape);
+    };
+
+}
+
+#endif // TALCS_FADECURVE_H
@@ -20,7 +20,7 @@
 #include "DspxAudioClipContext.h"
 #include "DspxAudioClipContext_p.h"
 
-#include <TalcsCore/PositionableMixerAudioSource.h>
+#include <TalcsCore/AudioSourceClipSeries.h>
 #include <TalcsCore/BufferingAudioSource.h>
 
 #include <TalcsFormat/FormatManager.h>
@@ -32,15 +32,27 @@
 
 namespace talcs {
 
+    void DspxAudioClipContextPrivate::insertClip() {
+        Q_Q(DspxAudioClipContext);
+        auto clipSeries = trackContext->clipSeries();
+        clipView = clipSeries->insertClip(contentSource.get(), 0, 0, 1);
+        clipSeries->setClipGain(clipView, gain);
+        clipSeries->setClipPan(clipView, pan);
+        clipSeries->setClipMute(clipView, isMute);
+        q->updatePosition();
+    }
+
+    void DspxAudioClipContextPrivate::removeClip() {
+        if (clipView.isNull())
+            return;
+        trackContext->clipSeries()->removeClip(clipView);
+        clipView = {};
+    }
+
     DspxAudioClipContext::DspxAudioClipContext(DspxTrackContext *trackContext) : QObject(trackContext), d_ptr(new DspxAudioClipContextPrivate) {
         Q_D(DspxAudioClipContext);
         d->q_ptr = this;
 
-        d->controlMixer = std::make_unique<PositionableMixerAudioSource>();
-        d->clipMixer = std::make_unique<PositionableMixerAudioSource>();
-
-        d->controlMixer->addSource(d->clipMixer.get());
-
         d->trackContext = trackContext;
     }
 
@@ -48,16 +60,6 @@ namespace talcs {
 
     }
 
-    PositionableMixerAudioSource *DspxAudioClipContext::controlMixer() const {
-        Q_D(const DspxAudioClipContext);
-        return d->controlMixer.get();
-    }
-
-    PositionableMixerAudioSource *DspxAudioClipContext::clipMixer() const {
-        Q_D(const DspxAudioClipContext);
-        return d->clipMixer.get();
-    }
-
     BufferingAudioSource *DspxAudioClipContext::contentSource() const {
         Q_D(const DspxAudioClipContext);
         return d->contentSource.get();
@@ -107,19 +109,57 @@ namespace talcs {
         return d->clipLenTick;
     }
 
-    void DspxAudioClipContext::loadAudio(AbstractAudioFormatIO *io) {
+    void DspxAudioClipContext::setGain(float gain) {
+        Q_D(DspxAudioClipContext);
+        d->gain = gain;
+        if (!d->clipView.isNull())
+            d->trackContext->clipSeries()->setClipGain(d->clipView, gain);
+    }
+
+    float DspxAudioClipContext::gain() const {
+        Q_D(const DspxAudioClipContext);
+        return d->gain;
+    }
+
+    void DspxAudioClipContext::setPan(float pan) {
+        Q_D(DspxAudioClipContext);
+        d->pan = pan;
+        if (!d->clipView.isNull())
+            d->trackContext->clipSeries()->setClipPan(d->clipView, pan);
+    }
+
+    float DspxAudioClipContext::pan() const {
+        Q_D(const DspxAudioClipContext);
+        return d->pan;
+    }
+
+    void DspxAudioClipContext::setMute(bool isMute) {
+        Q_D(DspxAudioClipContext);
+        d->isMute = isMute;
+        if (!d->clipView.isNull())
+            d->trackContext->clipSeries()->setClipMute(d->clipView, isMute);
+    }
+
+    bool DspxAudioClipContext::isMute() const {
+        Q_D(const DspxAudioClipContext);
+        return d->isMute;
+    }
+
+    void DspxAudioClipContext::loadAudio(AbstractAudioFormatIO *io, const QString &cacheKey) {
         Q_D(DspxAudioClipContext);
         auto rawSource_ = std::make_unique<AudioFormatInputSource>(io, true);
-        if (d->contentSource)
-            d->clipMixer->removeSource(d->contentSource.get());
+        rawSource_->setCacheKey(cacheKey);
+        rawSource_->setResamplerQuality(d->resamplerQuality);
+        d->removeClip();
         d->contentSource.reset(d->trackContext->projectContext()->makeBufferable(rawSource_.get(), 2));
+        d->contentSource->setIoGroup(cacheKey);
         d->rawSource = std::move(rawSource_);
-        d->clipMixer->prependSource(d->contentSource.get());
+        d->insertClip();
     }
 
     AbstractAudioFormatIO *DspxAudioClipContext::takeAudio() {
         Q_D(DspxAudioClipContext);
-        d->clipMixer->removeSource(d->contentSource.get());
+        d->removeClip();
         d->contentSource.reset();
         auto io = d->rawSource->audioFormatIo();
         d->rawSource->close();
@@ -128,8 +168,22 @@ namespace talcs {
         return io;
     }
 
+    void DspxAudioClipContext::setResamplerQuality(AudioResampler::Quality quality) {
+        Q_D(DspxAudioClipContext);
+        d->resamplerQuality = quality;
+        if (d->rawSource)
+            d->rawSource->setResamplerQuality(quality);
+    }
+
+    AudioResampler::Quality DspxAudioClipContext::resamplerQuality() const {
+        Q_D(const DspxAudioClipContext);
+        return d->resamplerQuality;
+    }
+
     void DspxAudioClipContext::updatePosition() {
         Q_D(DspxAudioClipContext);
+        if (d->clipView.isNull())
+            return;
         auto clipSeries = d->trackContext->clipSeries();
         auto convertTime = d->trackContext->projectContext()->timeConverter();
         auto startSample = convertTime(d->clipStartTick);
@@ -23,11 +23,11 @@
 #include <QObject>
 #include <QVariant>
 
+#include <TalcsFormat/AudioResampler.h>
 #include <TalcsDspx/TalcsDspxGlobal.h>
 
 namespace talcs {
 
-    class PositionableMixerAudioSource;
     class BufferingAudioSource;
     class AbstractAudioFormatIO;
 
@@ -42,8 +42,6 @@ namespace talcs {
     public:
         ~DspxAudioClipContext() override;
 
-        PositionableMixerAudioSource *controlMixer() const;
-        PositionableMixerAudioSource *clipMixer() const;
         BufferingAudioSource *contentSource() const;
 
         DspxTrackContext *trackContext() const;
@@ -57,9 +55,21 @@ namespace talcs {
         void setClipLen(int tick);
         int clipLen() const;
 
-        void loadAudio(AbstractAudioFormatIO *io);
+        void setGain(float gain);
+        float gain() const;
+
+        void setPan(float pan);
+        float pan() const;
+
+        void setMute(bool isMute);
+        bool isMute() const;
+
+        void loadAudio(AbstractAudioFormatIO *io, const QString &cacheKey = {});
         AbstractAudioFormatIO *takeAudio();
 
+        void setResamplerQuality(AudioResampler::Quality quality);
+        AudioResampler::Quality resamplerQuality() const;
+
         void updatePosition();
 
         void setData(const QVariant &data);
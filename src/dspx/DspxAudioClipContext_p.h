@@ -38,8 +38,6 @@ namespace talcs {
 
         std::unique_ptr<AudioFormatInputSource> rawSource;
         std::unique_ptr<BufferingAudioSource> contentSource;
-        std::unique_ptr<PositionableMixerAudioSource> clipMixer;
-        std::unique_ptr<PositionableMixerAudioSource> controlMixer;
 
         DspxTrackContext *trackContext;
 
@@ -49,6 +47,15 @@ namespace talcs {
         int clipStartTick = 0;
         int clipLenTick = 0;
 
+        float gain = 1;
+        float pan = 0;
+        bool isMute = false;
+
+        AudioResampler::Quality resamplerQuality = AudioResampler::HighQuality;
+
+        void insertClip();
+        void removeClip();
+
         QVariant data;
 
     };
@@ -30,6 +30,7 @@
 
 #include <TalcsDspx/DspxProjectContext.h>
 #include <TalcsDspx/DspxTrackContext.h>
+#include <TalcsDspx/DspxAudioClipContext.h>
 
 namespace talcs {
     DspxProjectAudioExporterSourceWriter::DspxProjectAudioExporterSourceWriter(DspxProjectAudioExporterPrivate *d, DspxTrackContext *trackContext, AudioSource *src, AbstractAudioFormatIO *outFile, int channelCountToMonoize, qint64 length)
@@ -60,6 +61,10 @@ namespace talcs {
                 masterTrack->isSourceSolo(trackContext->controlMixer()),
                 masterTrack->isMutedBySoloSetting(trackContext->controlMixer()) ? -1 : trackContext->controlMixer()->silentFlags(),
             });
+            for (auto clipContext : trackContext->clips()) {
+                savedResamplerQualityList.append({clipContext, clipContext->resamplerQuality()});
+                clipContext->setResamplerQuality(AudioResampler::HighQuality);
+            }
         }
     }
 
@@ -75,6 +80,9 @@ namespace talcs {
         projectContext->transport()->setPosition(savedMixerPosition);
 
         savedMixerSourceDataList.clear();
+        for (const auto &[clipContext, quality] : savedResamplerQualityList)
+            clipContext->setResamplerQuality(quality);
+        savedResamplerQualityList.clear();
         savedMixerSilentFlags = 0;
         savedMixerPosition = 0;
 
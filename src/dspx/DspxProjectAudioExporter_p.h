@@ -26,10 +26,12 @@
 
 #include <TalcsCore/AudioSource.h>
 
+#include <TalcsFormat/AudioResampler.h>
 #include <TalcsFormat/AudioSourceWriter.h>
 
 namespace talcs {
     class PositionableMixerAudioSource;
+    class DspxAudioClipContext;
 }
 
 namespace talcs {
@@ -81,6 +83,8 @@ namespace talcs {
         };
         QList<MixerSourceData> savedMixerSourceDataList;
         int savedMixerSilentFlags;
+        // Clips are resampled at the highest quality during exporting
+        QList<QPair<DspxAudioClipContext *, AudioResampler::Quality>> savedResamplerQualityList;
 
         QHash<PositionableMixerAudioSource *, AbstractAudioFormatIO *> taskSources;
         QList<MixerSourceData>::const_iterator savedMixerSourceDataIt;
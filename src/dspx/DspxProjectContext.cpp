@@ -144,12 +144,29 @@ namespace talcs {
         return d->bufferingReadAheadSize;
     }
 
+    void DspxProjectContext::setAdaptiveBufferingEnabled(bool enabled) {
+        Q_D(DspxProjectContext);
+        if (enabled != d->isAdaptiveBuffering) {
+            d->isAdaptiveBuffering = enabled;
+            emit d->adaptiveBufferingEnabledChanged(enabled);
+        }
+    }
+
+    bool DspxProjectContext::isAdaptiveBufferingEnabled() const {
+        Q_D(const DspxProjectContext);
+        return d->isAdaptiveBuffering;
+    }
+
     BufferingAudioSource *DspxProjectContext::makeBufferable(PositionableAudioSource *source, int channelCount) {
         Q_D(DspxProjectContext);
         auto bufSrc = new DspxProjectContextBufferingAudioSourceObject(source, channelCount, d->bufferingReadAheadSize);
+        bufSrc->setAdaptiveReadAheadEnabled(d->isAdaptiveBuffering);
         connect(d, &DspxProjectContextPrivate::readAheadSizeChanged, bufSrc, [bufSrc](qint64 size) {
             bufSrc->setReadAheadSize(size);
         });
+        connect(d, &DspxProjectContextPrivate::adaptiveBufferingEnabledChanged, bufSrc, [bufSrc](bool enabled) {
+            bufSrc->setAdaptiveReadAheadEnabled(enabled);
+        });
         return bufSrc;
     }
 
@@ -67,6 +67,9 @@ namespace talcs {
 
         void setBufferingReadAheadSize(qint64 size);
         qint64 bufferingReadAheadSize() const;
+
+        void setAdaptiveBufferingEnabled(bool enabled);
+        bool isAdaptiveBufferingEnabled() const;
         BufferingAudioSource *makeBufferable(PositionableAudioSource *source, int channelCount);
 
         DspxTrackContext *addTrack(int index);
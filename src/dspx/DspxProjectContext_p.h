@@ -54,11 +54,13 @@ namespace talcs {
         DspxProjectContext::TimeConverter timeConverter = [](int) { return 0; };
         DspxProjectContext::Interpolator interpolator = [](int, const QVariant &, int, const QVariant &, int){ return 0; };
         qint64 bufferingReadAheadSize = 0;
+        bool isAdaptiveBuffering = false;
 
         QList<DspxTrackContext *> tracks;
 
     signals:
         void readAheadSizeChanged(qint64 readAheadSize);
+        void adaptiveBufferingEnabledChanged(bool enabled);
     };
 }
 
@@ -79,9 +79,7 @@ namespace talcs {
     DspxAudioClipContext *DspxTrackContext::addAudioClip(quintptr id) {
         Q_D(DspxTrackContext);
         auto clip = new DspxAudioClipContext(this);
-        auto clipView = d->clipSeries->insertClip(clip->controlMixer(), 0, 0, 1);
         d->clips.insert(id, clip);
-        clip->d_func()->clipView = clipView;
         return clip;
     }
 
@@ -89,7 +87,7 @@ namespace talcs {
         Q_D(DspxTrackContext);
         Q_ASSERT(d->clips.contains(id));
         std::unique_ptr<DspxAudioClipContext> clip(d->clips.take(id));
-        d->clipSeries->removeClip(clip->d_func()->clipView);
+        clip->d_func()->removeClip();
     }
 
     QList<DspxAudioClipContext *> DspxTrackContext::clips() const {
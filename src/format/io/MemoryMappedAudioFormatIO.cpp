@@ -0,0 +1,577 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#include "MemoryMappedAudioFormatIO.h"
+#include "MemoryMappedAudioFormatIO_p.h"
+
+#include <cmath>
+#include <cstring>
+
+#include <QFileDevice>
+#include <QDebug>
+#include <QtEndian>
+
+#ifdef Q_OS_UNIX
+#   include <sys/mman.h>
+#   include <unistd.h>
+#endif
+
+#include <TalcsFormat/AudioFormatIO.h>
+
+#define TEST_IS_OPEN(ret)                                                                          \
+    if (!d->openMode) {                                                                            \
+        qWarning() << "MemoryMappedAudioFormatIO: Not open.";                                      \
+        return ret;                                                                                \
+    }
+
+namespace talcs {
+
+    static const uchar W64_RIFF_GUID[16] = {'r', 'i', 'f', 'f', 0x2E, 0x91, 0xCF, 0x11, 0xA5, 0xD6, 0x28, 0xDB, 0x04, 0xC1, 0x00, 0x00};
+    static const uchar W64_WAVE_GUID[16] = {'w', 'a', 'v', 'e', 0xF3, 0xAC, 0xD3, 0x11, 0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A};
+    static const uchar W64_FMT_GUID[16] = {'f', 'm', 't', ' ', 0xF3, 0xAC, 0xD3, 0x11, 0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A};
+    static const uchar W64_DATA_GUID[16] = {'d', 'a', 't', 'a', 0xF3, 0xAC, 0xD3, 0x11, 0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A};
+
+    static constexpr quint16 WAVE_FORMAT_PCM = 0x0001;
+    static constexpr quint16 WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+    static constexpr quint16 WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+    static inline bool chunkIdEquals(const uchar *p, const char *id) {
+        return std::memcmp(p, id, 4) == 0;
+    }
+
+    // The 80-bit IEEE 754 extended precision number used by the sample rate of AIFF
+    static double readExtended(const uchar *p) {
+        int exponent = ((p[0] & 0x7F) << 8) | p[1];
+        auto mantissa = qFromBigEndian<quint64>(p + 2);
+        if (exponent == 0 && mantissa == 0)
+            return 0;
+        auto value = std::ldexp(double(mantissa), exponent - 16383 - 63);
+        return (p[0] & 0x80) ? -value : value;
+    }
+
+    /**
+     * @class MemoryMappedAudioFormatIO
+     * @brief Reads uncompressed PCM audio files by memory mapping
+     *
+     * The file is mapped into memory instead of being read through a decoder, so opening and seeking cost nothing
+     * regardless of the file size, and the samples are converted straight from the mapped region. For native-endian
+     * 32-bit float files, floatData() gives access to the samples without any copy.
+     *
+     * WAV (including WAVE_FORMAT_EXTENSIBLE), RF64, Sony Wave64 and AIFF/AIFC files with 8, 16, 24 or 32-bit integer,
+     * or 32 or 64-bit float samples are supported. Other files fail to open, so AudioFormatIO can be used instead.
+     *
+     * On Unix-like systems, the kernel is hinted that the file is read sequentially, and the range ahead of the read
+     * position is prefetched after each seek.
+     *
+     * Writing is not supported.
+     */
+
+    /**
+     * Constructor.
+     * @param stream the file to read. It must be opened before this object is opened.
+     */
+    MemoryMappedAudioFormatIO::MemoryMappedAudioFormatIO(QFileDevice *stream) : d_ptr(new MemoryMappedAudioFormatIOPrivate) {
+        Q_D(MemoryMappedAudioFormatIO);
+        d->q_ptr = this;
+        d->stream = stream;
+    }
+
+    /**
+     * Destructor.
+     */
+    MemoryMappedAudioFormatIO::~MemoryMappedAudioFormatIO() {
+        MemoryMappedAudioFormatIO::close();
+    }
+
+    /**
+     * Sets the file to read.
+     */
+    void MemoryMappedAudioFormatIO::setStream(QFileDevice *stream) {
+        Q_D(MemoryMappedAudioFormatIO);
+        if (d->openMode) {
+            qWarning() << "MemoryMappedAudioFormatIO: Cannot set stream when MemoryMappedAudioFormatIO is open.";
+            return;
+        }
+        d->stream = stream;
+    }
+
+    /**
+     * Gets the file to read.
+     */
+    QFileDevice *MemoryMappedAudioFormatIO::stream() const {
+        Q_D(const MemoryMappedAudioFormatIO);
+        return d->stream;
+    }
+
+    bool MemoryMappedAudioFormatIO::open(OpenMode mode) {
+        Q_D(MemoryMappedAudioFormatIO);
+        close();
+        if (mode.testFlag(Write)) {
+            qWarning() << "MemoryMappedAudioFormatIO: Writing is not supported.";
+            setErrorString("MemoryMappedAudioFormatIO: Writing is not supported.");
+            return false;
+        }
+        if (mode == 0) {
+            qWarning() << "MemoryMappedAudioFormatIO: Cannot open because access mode is not specified.";
+            setErrorString("MemoryMappedAudioFormatIO: Cannot open because access mode is not specified.");
+            return false;
+        }
+        if (!d->stream) {
+            qWarning() << "MemoryMappedAudioFormatIO: Cannot open because stream is null.";
+            setErrorString("MemoryMappedAudioFormatIO: Cannot open because stream is null.");
+            return false;
+        }
+        if (!d->stream->openMode()) {
+            qWarning() << "MemoryMappedAudioFormatIO: Cannot open because stream is not opened.";
+            setErrorString("MemoryMappedAudioFormatIO: Cannot open because stream is not opened.");
+            return false;
+        }
+        d->format = 0;
+        d->channelCount = 0;
+        d->sampleRate = 0;
+        d->isBigEndian = false;
+        d->mappedSize = d->stream->size();
+        if (d->mappedSize < 12 || !(d->mappedFile = d->stream->map(0, d->mappedSize))) {
+            setErrorString("MemoryMappedAudioFormatIO: Cannot map the file.");
+            d->mappedSize = 0;
+            return false;
+        }
+        bool isParsed = false;
+        if (chunkIdEquals(d->mappedFile, "RIFF") && chunkIdEquals(d->mappedFile + 8, "WAVE"))
+            isParsed = d->parseRiff(false);
+        else if (chunkIdEquals(d->mappedFile, "RF64") && chunkIdEquals(d->mappedFile + 8, "WAVE"))
+            isParsed = d->parseRiff(true);
+        else if (d->mappedSize >= 40 && std::memcmp(d->mappedFile, W64_RIFF_GUID, 16) == 0 && std::memcmp(d->mappedFile + 24, W64_WAVE_GUID, 16) == 0)
+            isParsed = d->parseWave64();
+        else if (chunkIdEquals(d->mappedFile, "FORM") && (chunkIdEquals(d->mappedFile + 8, "AIFF") || chunkIdEquals(d->mappedFile + 8, "AIFC")))
+            isParsed = d->parseAiff();
+        if (!isParsed || d->channelCount <= 0 || !d->data) {
+            d->stream->unmap(d->mappedFile);
+            d->mappedFile = nullptr;
+            d->mappedSize = 0;
+            d->data = nullptr;
+            setErrorString("MemoryMappedAudioFormatIO: Unsupported file format.");
+            return false;
+        }
+        d->position = 0;
+        d->advisedEnd = -1;
+#ifdef Q_OS_UNIX
+        {
+            auto pageSize = quintptr(sysconf(_SC_PAGESIZE));
+            auto begin = reinterpret_cast<quintptr>(d->data) & ~(pageSize - 1);
+            auto end = reinterpret_cast<quintptr>(d->data) + quintptr(d->frameCount * d->channelCount * d->bytesPerSample);
+            ::madvise(reinterpret_cast<void *>(begin), end - begin, MADV_SEQUENTIAL);
+        }
+#endif
+        d->advise(0, true);
+        d->openMode = mode;
+        clearErrorString();
+        return true;
+    }
+
+    AbstractAudioFormatIO::OpenMode MemoryMappedAudioFormatIO::openMode() const {
+        Q_D(const MemoryMappedAudioFormatIO);
+        return d->openMode;
+    }
+
+    void MemoryMappedAudioFormatIO::close() {
+        Q_D(MemoryMappedAudioFormatIO);
+        if (d->mappedFile) {
+            d->stream->unmap(d->mappedFile);
+            d->mappedFile = nullptr;
+            d->mappedSize = 0;
+            d->data = nullptr;
+        }
+        d->openMode = NotOpen;
+        clearErrorString();
+    }
+
+    /**
+     * Gets the format, represented in the same way as AudioFormatIO::format().
+     */
+    int MemoryMappedAudioFormatIO::format() const {
+        Q_D(const MemoryMappedAudioFormatIO);
+        TEST_IS_OPEN(0)
+        return d->format;
+    }
+
+    void MemoryMappedAudioFormatIO::setFormat(int format) {
+        qWarning() << "MemoryMappedAudioFormatIO: Writing is not supported.";
+    }
+
+    int MemoryMappedAudioFormatIO::channelCount() const {
+        Q_D(const MemoryMappedAudioFormatIO);
+        TEST_IS_OPEN(0)
+        return d->channelCount;
+    }
+
+    void MemoryMappedAudioFormatIO::setChannelCount(int channelCount) {
+        qWarning() << "MemoryMappedAudioFormatIO: Writing is not supported.";
+    }
+
+    double MemoryMappedAudioFormatIO::sampleRate() const {
+        Q_D(const MemoryMappedAudioFormatIO);
+        TEST_IS_OPEN(0)
+        return d->sampleRate;
+    }
+
+    void MemoryMappedAudioFormatIO::setSampleRate(double sampleRate) {
+        qWarning() << "MemoryMappedAudioFormatIO: Writing is not supported.";
+    }
+
+    qint64 MemoryMappedAudioFormatIO::length() const {
+        Q_D(const MemoryMappedAudioFormatIO);
+        TEST_IS_OPEN(0)
+        return d->frameCount;
+    }
+
+    template <class T, bool isBigEndian>
+    static inline T loadSample(const uchar *p) {
+        if constexpr (isBigEndian)
+            return qFromBigEndian<T>(p);
+        else
+            return qFromLittleEndian<T>(p);
+    }
+
+    template <bool isBigEndian>
+    static void convertToFloat(float *dest, const uchar *src, qint64 sampleCount, MemoryMappedAudioFormatIOPrivate::SampleType sampleType) {
+        switch (sampleType) {
+            case MemoryMappedAudioFormatIOPrivate::UInt8:
+                for (qint64 i = 0; i < sampleCount; i++)
+                    dest[i] = float(int(src[i]) - 128) / 128.0f;
+                break;
+            case MemoryMappedAudioFormatIOPrivate::Int8:
+                for (qint64 i = 0; i < sampleCount; i++)
+                    dest[i] = float(static_cast<qint8>(src[i])) / 128.0f;
+                break;
+            case MemoryMappedAudioFormatIOPrivate::Int16:
+                for (qint64 i = 0; i < sampleCount; i++)
+                    dest[i] = float(loadSample<qint16, isBigEndian>(src + 2 * i)) / 32768.0f;
+                break;
+            case MemoryMappedAudioFormatIOPrivate::Int24:
+                for (qint64 i = 0; i < sampleCount; i++) {
+                    auto p = src + 3 * i;
+                    auto value = qint32(isBigEndian ? quint32(p[0]) << 24 | quint32(p[1]) << 16 | quint32(p[2]) << 8
+                                                    : quint32(p[2]) << 24 | quint32(p[1]) << 16 | quint32(p[0]) << 8);
+                    dest[i] = float(value >> 8) / 8388608.0f;
+                }
+                break;
+            case MemoryMappedAudioFormatIOPrivate::Int32:
+                for (qint64 i = 0; i < sampleCount; i++)
+                    dest[i] = float(double(loadSample<qint32, isBigEndian>(src + 4 * i)) / 2147483648.0);
+                break;
+            case MemoryMappedAudioFormatIOPrivate::Float32:
+                for (qint64 i = 0; i < sampleCount; i++) {
+                    auto value = loadSample<quint32, isBigEndian>(src + 4 * i);
+                    std::memcpy(dest + i, &value, 4);
+                }
+                break;
+            case MemoryMappedAudioFormatIOPrivate::Float64:
+                for (qint64 i = 0; i < sampleCount; i++) {
+                    auto value = loadSample<quint64, isBigEndian>(src + 8 * i);
+                    double sample;
+                    std::memcpy(&sample, &value, 8);
+                    dest[i] = float(sample);
+                }
+                break;
+        }
+    }
+
+    /**
+     * Reads interleaved samples converted from the mapped region.
+     */
+    qint64 MemoryMappedAudioFormatIO::read(float *ptr, qint64 length) {
+        Q_D(MemoryMappedAudioFormatIO);
+        TEST_IS_OPEN(0)
+        length = qBound(0ll, length, d->frameCount - d->position);
+        if (length == 0)
+            return 0;
+        d->advise(d->position + length, false);
+        auto sampleCount = length * d->channelCount;
+        auto src = d->data + d->position * d->channelCount * d->bytesPerSample;
+        if (auto p = floatData()) {
+            std::memcpy(ptr, p + d->position * d->channelCount, sampleCount * sizeof(float));
+        } else if (d->isBigEndian) {
+            convertToFloat<true>(ptr, src, sampleCount, d->sampleType);
+        } else {
+            convertToFloat<false>(ptr, src, sampleCount, d->sampleType);
+        }
+        d->position += length;
+        return length;
+    }
+
+    qint64 MemoryMappedAudioFormatIO::write(const float *ptr, qint64 length) {
+        qWarning() << "MemoryMappedAudioFormatIO: Writing is not supported.";
+        return 0;
+    }
+
+    qint64 MemoryMappedAudioFormatIO::seek(qint64 pos) {
+        Q_D(MemoryMappedAudioFormatIO);
+        TEST_IS_OPEN(-1)
+        if (pos < 0 || pos > d->frameCount)
+            return -1;
+        d->position = pos;
+        d->advise(pos, true);
+        return pos;
+    }
+
+    qint64 MemoryMappedAudioFormatIO::pos() const {
+        Q_D(const MemoryMappedAudioFormatIO);
+        TEST_IS_OPEN(0)
+        return d->position;
+    }
+
+    /**
+     * Gets the mapped audio data, i.e. the interleaved samples as stored in the file, or @c nullptr if not open.
+     */
+    const uchar *MemoryMappedAudioFormatIO::mappedData() const {
+        Q_D(const MemoryMappedAudioFormatIO);
+        return d->data;
+    }
+
+    /**
+     * Gets the interleaved samples without copy, if the samples are 32-bit float in native byte order and suitably
+     * aligned. Otherwise, returns @c nullptr, and read() has to be used.
+     */
+    const float *MemoryMappedAudioFormatIO::floatData() const {
+        Q_D(const MemoryMappedAudioFormatIO);
+        if (!d->data || d->sampleType != MemoryMappedAudioFormatIOPrivate::Float32 || d->isBigEndian != (Q_BYTE_ORDER == Q_BIG_ENDIAN))
+            return nullptr;
+        if (reinterpret_cast<quintptr>(d->data) % alignof(float))
+            return nullptr;
+        return reinterpret_cast<const float *>(d->data);
+    }
+
+    /**
+     * Sets the length in samples to prefetch ahead of the read position. By default (0), one second is prefetched.
+     */
+    void MemoryMappedAudioFormatIO::setReadAheadHint(qint64 length) {
+        Q_D(MemoryMappedAudioFormatIO);
+        d->readAheadHint = length;
+    }
+
+    /**
+     * Gets the length in samples to prefetch ahead of the read position.
+     */
+    qint64 MemoryMappedAudioFormatIO::readAheadHint() const {
+        Q_D(const MemoryMappedAudioFormatIO);
+        return d->readAheadHint;
+    }
+
+    bool MemoryMappedAudioFormatIOPrivate::setSampleType(int bitsPerSample, bool isFloat) {
+        if (isFloat) {
+            if (bitsPerSample == 32)
+                sampleType = Float32;
+            else if (bitsPerSample == 64)
+                sampleType = Float64;
+            else
+                return false;
+        } else {
+            // Samples are justified to the most significant bits of the container
+            switch ((bitsPerSample + 7) / 8) {
+                case 1:
+                    sampleType = isBigEndian ? Int8 : UInt8;
+                    break;
+                case 2:
+                    sampleType = Int16;
+                    break;
+                case 3:
+                    sampleType = Int24;
+                    break;
+                case 4:
+                    sampleType = Int32;
+                    break;
+                default:
+                    return false;
+            }
+        }
+        static const int sampleBytes[] = {1, 1, 2, 3, 4, 4, 8};
+        static const int subtypes[] = {AudioFormatIO::PCM_U8, AudioFormatIO::PCM_S8, AudioFormatIO::PCM_16, AudioFormatIO::PCM_24, AudioFormatIO::PCM_32, AudioFormatIO::FLOAT, AudioFormatIO::DOUBLE};
+        bytesPerSample = sampleBytes[sampleType];
+        format |= subtypes[sampleType];
+        return true;
+    }
+
+    // WAV and RF64. The sizes of RF64 are stored in the ds64 chunk if the 32-bit fields are 0xFFFFFFFF.
+    bool MemoryMappedAudioFormatIOPrivate::parseRiff(bool isRf64) {
+        format = isRf64 ? AudioFormatIO::RF64 : AudioFormatIO::WAV;
+        quint64 ds64DataSize = 0;
+        bool hasFormat = false;
+        qint64 dataOffset = -1;
+        quint64 dataSize = 0;
+        for (qint64 offset = 12; offset + 8 <= mappedSize;) {
+            auto chunk = mappedFile + offset;
+            quint64 size = qFromLittleEndian<quint32>(chunk + 4);
+            if (chunkIdEquals(chunk, "ds64") && size >= 24 && offset + 8 + 24 <= mappedSize) {
+                ds64DataSize = qFromLittleEndian<quint64>(chunk + 16);
+            } else if (chunkIdEquals(chunk, "fmt ") && size >= 16 && offset + 8 + 16 <= mappedSize) {
+                auto formatTag = qFromLittleEndian<quint16>(chunk + 8);
+                channelCount = qFromLittleEndian<quint16>(chunk + 10);
+                sampleRate = qFromLittleEndian<quint32>(chunk + 12);
+                auto blockAlign = qFromLittleEndian<quint16>(chunk + 20);
+                auto bitsPerSample = qFromLittleEndian<quint16>(chunk + 22);
+                if (formatTag == WAVE_FORMAT_EXTENSIBLE && size >= 40 && offset + 8 + 40 <= mappedSize)
+                    formatTag = qFromLittleEndian<quint16>(chunk + 32);
+                if (channelCount > 0 && blockAlign / channelCount * 8 > bitsPerSample)
+                    bitsPerSample = blockAlign / channelCount * 8;
+                if (formatTag == WAVE_FORMAT_PCM)
+                    hasFormat = setSampleType(bitsPerSample, false);
+                else if (formatTag == WAVE_FORMAT_IEEE_FLOAT)
+                    hasFormat = setSampleType(bitsPerSample, true);
+                if (!hasFormat)
+                    return false;
+            } else if (chunkIdEquals(chunk, "data")) {
+                dataOffset = offset + 8;
+                dataSize = isRf64 && size == 0xFFFFFFFF ? ds64DataSize : size;
+                if (hasFormat)
+                    break;
+            }
+            if (size > quint64(mappedSize))
+                break;
+            offset += 8 + qint64(size) + qint64(size & 1);
+        }
+        if (!hasFormat || dataOffset < 0 || channelCount <= 0)
+            return false;
+        data = mappedFile + dataOffset;
+        frameCount = qint64(qMin(dataSize, quint64(mappedSize - dataOffset))) / (channelCount * bytesPerSample);
+        return true;
+    }
+
+    // Sony Wave64. The chunks are identified by GUIDs, have 64-bit sizes including the header, and are 8-byte aligned.
+    bool MemoryMappedAudioFormatIOPrivate::parseWave64() {
+        format = AudioFormatIO::W64;
+        bool hasFormat = false;
+        qint64 dataOffset = -1;
+        quint64 dataSize = 0;
+        for (qint64 offset = 40; offset + 24 <= mappedSize;) {
+            auto chunk = mappedFile + offset;
+            auto size = qFromLittleEndian<quint64>(chunk + 16);
+            if (size < 24)
+                return false;
+            if (std::memcmp(chunk, W64_FMT_GUID, 16) == 0 && size >= 24 + 16 && offset + 24 + 16 <= mappedSize) {
+                auto formatTag = qFromLittleEndian<quint16>(chunk + 24);
+                channelCount = qFromLittleEndian<quint16>(chunk + 26);
+                sampleRate = qFromLittleEndian<quint32>(chunk + 28);
+                auto blockAlign = qFromLittleEndian<quint16>(chunk + 36);
+                auto bitsPerSample = qFromLittleEndian<quint16>(chunk + 38);
+                if (formatTag == WAVE_FORMAT_EXTENSIBLE && size >= 24 + 40 && offset + 24 + 40 <= mappedSize)
+                    formatTag = qFromLittleEndian<quint16>(chunk + 48);
+                if (channelCount > 0 && blockAlign / channelCount * 8 > bitsPerSample)
+                    bitsPerSample = blockAlign / channelCount * 8;
+                if (formatTag == WAVE_FORMAT_PCM)
+                    hasFormat = setSampleType(bitsPerSample, false);
+                else if (formatTag == WAVE_FORMAT_IEEE_FLOAT)
+                    hasFormat = setSampleType(bitsPerSample, true);
+                if (!hasFormat)
+                    return false;
+            } else if (std::memcmp(chunk, W64_DATA_GUID, 16) == 0) {
+                dataOffset = offset + 24;
+                dataSize = size - 24;
+                if (hasFormat)
+                    break;
+            }
+            if (size > quint64(mappedSize))
+                break;
+            offset += qint64((size + 7) & ~quint64(7));
+        }
+        if (!hasFormat || dataOffset < 0 || channelCount <= 0)
+            return false;
+        data = mappedFile + dataOffset;
+        frameCount = qint64(qMin(dataSize, quint64(mappedSize - dataOffset))) / (channelCount * bytesPerSample);
+        return true;
+    }
+
+    // AIFF and uncompressed AIFC. Samples are big-endian unless the compression type of AIFC says otherwise.
+    bool MemoryMappedAudioFormatIOPrivate::parseAiff() {
+        format = AudioFormatIO::AIFF;
+        bool isAifc = chunkIdEquals(mappedFile + 8, "AIFC");
+        bool hasFormat = false;
+        qint64 dataOffset = -1;
+        quint64 dataSize = 0;
+        for (qint64 offset = 12; offset + 8 <= mappedSize;) {
+            auto chunk = mappedFile + offset;
+            quint64 size = qFromBigEndian<quint32>(chunk + 4);
+            if (chunkIdEquals(chunk, "COMM") && size >= 18 && offset + 8 + 18 <= mappedSize) {
+                channelCount = qFromBigEndian<qint16>(chunk + 8);
+                auto bitsPerSample = qFromBigEndian<qint16>(chunk + 14);
+                sampleRate = readExtended(chunk + 16);
+                bool isFloat = false;
+                isBigEndian = true;
+                if (isAifc) {
+                    if (size < 22 || offset + 8 + 22 > mappedSize)
+                        return false;
+                    auto compressionType = chunk + 26;
+                    if (chunkIdEquals(compressionType, "sowt")) {
+                        isBigEndian = false;
+                        format |= AudioFormatIO::LittleEndian;
+                    } else if (chunkIdEquals(compressionType, "fl32") || chunkIdEquals(compressionType, "FL32")) {
+                        isFloat = true;
+                        bitsPerSample = 32;
+                    } else if (chunkIdEquals(compressionType, "fl64") || chunkIdEquals(compressionType, "FL64")) {
+                        isFloat = true;
+                        bitsPerSample = 64;
+                    } else if (!chunkIdEquals(compressionType, "NONE") && !chunkIdEquals(compressionType, "twos")) {
+                        return false;
+                    }
+                }
+                hasFormat = setSampleType(bitsPerSample, isFloat);
+                if (!hasFormat)
+                    return false;
+            } else if (chunkIdEquals(chunk, "SSND") && size >= 8 && offset + 16 <= mappedSize) {
+                auto dataStart = qFromBigEndian<quint32>(chunk + 8);
+                if (dataStart > size - 8)
+                    return false;
+                dataOffset = offset + 16 + dataStart;
+                dataSize = size - 8 - dataStart;
+            }
+            if (size > quint64(mappedSize))
+                break;
+            offset += 8 + qint64(size) + qint64(size & 1);
+        }
+        if (!hasFormat || dataOffset < 0 || dataOffset > mappedSize || channelCount <= 0)
+            return false;
+        data = mappedFile + dataOffset;
+        frameCount = qint64(qMin(dataSize, quint64(mappedSize - dataOffset))) / (channelCount * bytesPerSample);
+        return true;
+    }
+
+    // Prefetches the range ahead of the frame. While reading sequentially, the next range is prefetched when the read
+    // position passes the half of the last prefetched range.
+    void MemoryMappedAudioFormatIOPrivate::advise(qint64 frame, bool isSeek) {
+#ifdef Q_OS_UNIX
+        auto length = readAheadHint > 0 ? readAheadHint : qint64(sampleRate);
+        if (!isSeek && advisedEnd >= 0 && frame < advisedEnd - length / 2)
+            return;
+        auto begin = isSeek || advisedEnd < 0 ? frame : advisedEnd;
+        auto end = qMin(frameCount, qMax(begin, frame) + length);
+        advisedEnd = end;
+        if (end <= begin)
+            return;
+        auto frameBytes = quintptr(channelCount * bytesPerSample);
+        auto pageSize = quintptr(sysconf(_SC_PAGESIZE));
+        auto p = reinterpret_cast<quintptr>(data) + quintptr(begin) * frameBytes;
+        auto alignedP = p & ~(pageSize - 1);
+        ::madvise(reinterpret_cast<void *>(alignedP), quintptr(end - begin) * frameBytes + (p - alignedP), MADV_WILLNEED);
+#else
+        Q_UNUSED(frame)
+        Q_UNUSED(isSeek)
+#endif
+    }
+
+}
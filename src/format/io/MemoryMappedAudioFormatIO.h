@@ -0,0 +1,76 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#ifndef TALCS_MEMORYMAPPEDAUDIOFORMATIO_H
+#define TALCS_MEMORYMAPPEDAUDIOFORMATIO_H
+
+#include <QScopedPointer>
+
+#include <TalcsCore/ErrorStringProvider.h>
+#include <TalcsFormat/AbstractAudioFormatIO.h>
+
+class QFileDevice;
+
+namespace talcs {
+
+    class MemoryMappedAudioFormatIOPrivate;
+
+    class TALCSFORMAT_EXPORT MemoryMappedAudioFormatIO : public AbstractAudioFormatIO, public ErrorStringProvider {
+        Q_DECLARE_PRIVATE(MemoryMappedAudioFormatIO)
+    public:
+        explicit MemoryMappedAudioFormatIO(QFileDevice *stream = nullptr);
+        ~MemoryMappedAudioFormatIO() override;
+
+        void setStream(QFileDevice *stream);
+        QFileDevice *stream() const;
+
+        bool open(OpenMode mode) override;
+        OpenMode openMode() const override;
+        void close() override;
+
+        int format() const override;
+        void setFormat(int format) override;
+
+        int channelCount() const override;
+        void setChannelCount(int channelCount) override;
+
+        double sampleRate() const override;
+        void setSampleRate(double sampleRate) override;
+
+        qint64 length() const override;
+
+        qint64 read(float *ptr, qint64 length) override;
+        qint64 write(const float *ptr, qint64 length) override;
+
+        qint64 seek(qint64 pos) override;
+        qint64 pos() const override;
+
+        const uchar *mappedData() const;
+        const float *floatData() const;
+
+        void setReadAheadHint(qint64 length);
+        qint64 readAheadHint() const;
+
+    private:
+        QScopedPointer<MemoryMappedAudioFormatIOPrivate> d_ptr;
+    };
+
+}
+
+#endif //TALCS_MEMORYMAPPEDAUDIOFORMATIO_H
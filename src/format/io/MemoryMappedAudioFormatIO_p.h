@@ -0,0 +1,69 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#ifndef TALCS_MEMORYMAPPEDAUDIOFORMATIO_P_H
+#define TALCS_MEMORYMAPPEDAUDIOFORMATIO_P_H
+
+#include <TalcsFormat/MemoryMappedAudioFormatIO.h>
+
+namespace talcs {
+    class MemoryMappedAudioFormatIOPrivate {
+        Q_DECLARE_PUBLIC(MemoryMappedAudioFormatIO)
+    public:
+        MemoryMappedAudioFormatIO *q_ptr;
+
+        QFileDevice *stream;
+
+        AbstractAudioFormatIO::OpenMode openMode{};
+
+        enum SampleType {
+            UInt8,
+            Int8,
+            Int16,
+            Int24,
+            Int32,
+            Float32,
+            Float64,
+        };
+
+        uchar *mappedFile = nullptr;
+        qint64 mappedSize = 0;
+        const uchar *data = nullptr;
+        qint64 frameCount = 0;
+
+        int format = 0;
+        int channelCount = 0;
+        double sampleRate = 0;
+        SampleType sampleType = Int16;
+        int bytesPerSample = 0;
+        bool isBigEndian = false;
+
+        qint64 position = 0;
+        qint64 readAheadHint = 0;
+        qint64 advisedEnd = -1;
+
+        bool parseRiff(bool isRf64);
+        bool parseWave64();
+        bool parseAiff();
+        bool setSampleType(int bitsPerSample, bool isFloat);
+        void advise(qint64 frame, bool isSeek);
+    };
+}
+
+#endif //TALCS_MEMORYMAPPEDAUDIOFORMATIO_P_H
@@ -0,0 +1,386 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#include "ReadAheadAudioFormatIO.h"
+#include "ReadAheadAudioFormatIO_p.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <QDebug>
+#include <QThreadPool>
+
+#define TEST_IS_OPEN(ret)                                                                          \
+    if (!d->openMode) {                                                                            \
+        qWarning() << "ReadAheadAudioFormatIO: Not open.";                                         \
+        return ret;                                                                                \
+    }
+
+namespace talcs {
+
+    /**
+     * @class ReadAheadAudioFormatIO
+     * @brief Decodes another AbstractAudioFormatIO object ahead of the read position on a background thread
+     *
+     * AbstractAudioFormatIO::read() decodes on the calling thread, which can be a buffering worker or even the audio
+     * thread. This decorator decodes the wrapped object into a queue of chunks in a thread pool, and serves read() and
+     * seek() from the queue, so slow codecs (e.g. WavPack and AAC) are decoupled from their consumers.
+     *
+     * A seek within the queued chunks keeps the queue. A seek elsewhere discards the queue and restarts decoding from
+     * the new position. If a chunk is being decoded at that moment, it is discarded as soon as its decoding finishes.
+     * read() blocks only when the chunk at the read position is not decoded yet.
+     *
+     * Once opened, the wrapped object is only accessed by the decoding task until this object is closed. Writing is
+     * not supported.
+     */
+
+    /**
+     * Constructor.
+     * @param audioFormatIo the object to read from
+     * @param takeOwnership whether the object is deleted with this object
+     */
+    ReadAheadAudioFormatIO::ReadAheadAudioFormatIO(AbstractAudioFormatIO *audioFormatIo, bool takeOwnership) : d_ptr(new ReadAheadAudioFormatIOPrivate) {
+        Q_D(ReadAheadAudioFormatIO);
+        d->q_ptr = this;
+        d->io.reset(audioFormatIo, takeOwnership);
+        d->setAutoDelete(false);
+    }
+
+    /**
+     * Destructor.
+     */
+    ReadAheadAudioFormatIO::~ReadAheadAudioFormatIO() {
+        ReadAheadAudioFormatIO::close();
+    }
+
+    /**
+     * Sets the object to read from.
+     *
+     * Note that this function should not be called when this object is open.
+     */
+    void ReadAheadAudioFormatIO::setAudioFormatIo(AbstractAudioFormatIO *audioFormatIo, bool takeOwnership) {
+        Q_D(ReadAheadAudioFormatIO);
+        if (d->openMode) {
+            qWarning() << "ReadAheadAudioFormatIO: Cannot set audio format io when ReadAheadAudioFormatIO is open.";
+            return;
+        }
+        d->io.reset(audioFormatIo, takeOwnership);
+    }
+
+    /**
+     * Gets the object to read from.
+     */
+    AbstractAudioFormatIO *ReadAheadAudioFormatIO::audioFormatIo() const {
+        Q_D(const ReadAheadAudioFormatIO);
+        return d->io;
+    }
+
+    /**
+     * Sets the length in samples of each chunk. The default value is 16384.
+     *
+     * The new size applies to the chunks decoded afterward.
+     */
+    void ReadAheadAudioFormatIO::setChunkSize(qint64 chunkSize) {
+        Q_D(ReadAheadAudioFormatIO);
+        Q_ASSERT(chunkSize > 0);
+        QMutexLocker locker(&d->mutex);
+        d->chunkSize = chunkSize;
+    }
+
+    /**
+     * Gets the length in samples of each chunk.
+     */
+    qint64 ReadAheadAudioFormatIO::chunkSize() const {
+        Q_D(const ReadAheadAudioFormatIO);
+        QMutexLocker locker(&d->mutex);
+        return d->chunkSize;
+    }
+
+    /**
+     * Sets the maximum number of decoded chunks queued ahead of the read position. The default value is 8.
+     */
+    void ReadAheadAudioFormatIO::setChunkCount(int chunkCount) {
+        Q_D(ReadAheadAudioFormatIO);
+        Q_ASSERT(chunkCount > 0);
+        QMutexLocker locker(&d->mutex);
+        d->chunkCount = chunkCount;
+        if (d->openMode)
+            d->startTask();
+    }
+
+    /**
+     * Gets the maximum number of decoded chunks queued ahead of the read position.
+     */
+    int ReadAheadAudioFormatIO::chunkCount() const {
+        Q_D(const ReadAheadAudioFormatIO);
+        QMutexLocker locker(&d->mutex);
+        return d->chunkCount;
+    }
+
+    /**
+     * Sets the thread pool to decode in, or @c nullptr to use QThreadPool::globalInstance(), which is the default.
+     *
+     * The decoding task only occupies a thread while the queue is being filled.
+     */
+    void ReadAheadAudioFormatIO::setThreadPool(QThreadPool *threadPool) {
+        Q_D(ReadAheadAudioFormatIO);
+        QMutexLocker locker(&d->mutex);
+        d->threadPool = threadPool;
+    }
+
+    /**
+     * Gets the thread pool to decode in.
+     */
+    QThreadPool *ReadAheadAudioFormatIO::threadPool() const {
+        Q_D(const ReadAheadAudioFormatIO);
+        QMutexLocker locker(&d->mutex);
+        return d->threadPool;
+    }
+
+    bool ReadAheadAudioFormatIO::open(OpenMode mode) {
+        Q_D(ReadAheadAudioFormatIO);
+        close();
+        if (mode.testFlag(Write)) {
+            qWarning() << "ReadAheadAudioFormatIO: Writing is not supported.";
+            setErrorString("ReadAheadAudioFormatIO: Writing is not supported.");
+            return false;
+        }
+        if (mode == 0) {
+            qWarning() << "ReadAheadAudioFormatIO: Cannot open because access mode is not specified.";
+            setErrorString("ReadAheadAudioFormatIO: Cannot open because access mode is not specified.");
+            return false;
+        }
+        if (!d->io) {
+            qWarning() << "ReadAheadAudioFormatIO: Cannot open because audio format io is null.";
+            setErrorString("ReadAheadAudioFormatIO: Cannot open because audio format io is null.");
+            return false;
+        }
+        if (!d->io->open(Read)) {
+            auto errorStringProvider = dynamic_cast<ErrorStringProvider *>(d->io.get());
+            setErrorString(errorStringProvider ? errorStringProvider->errorString() : QStringLiteral("ReadAheadAudioFormatIO: Cannot open audio format io."));
+            return false;
+        }
+        QMutexLocker locker(&d->mutex);
+        d->format = d->io->format();
+        d->channelCount = d->io->channelCount();
+        d->sampleRate = d->io->sampleRate();
+        d->length = d->io->length();
+        d->readPosition = 0;
+        d->decodePosition = 0;
+        d->isSeekRequired = d->io->pos() != 0;
+        d->isTerminateRequested = false;
+        d->openMode = mode;
+        d->startTask();
+        clearErrorString();
+        return true;
+    }
+
+    AbstractAudioFormatIO::OpenMode ReadAheadAudioFormatIO::openMode() const {
+        Q_D(const ReadAheadAudioFormatIO);
+        return d->openMode;
+    }
+
+    void ReadAheadAudioFormatIO::close() {
+        Q_D(ReadAheadAudioFormatIO);
+        if (d->openMode) {
+            {
+                QMutexLocker locker(&d->mutex);
+                d->isTerminateRequested = true;
+                d->waitForTask();
+                d->clearChunkQueue();
+                d->openMode = NotOpen;
+            }
+            d->io->close();
+        }
+        clearErrorString();
+    }
+
+    /**
+     * Gets the format of the wrapped object.
+     */
+    int ReadAheadAudioFormatIO::format() const {
+        Q_D(const ReadAheadAudioFormatIO);
+        TEST_IS_OPEN(0)
+        return d->format;
+    }
+
+    void ReadAheadAudioFormatIO::setFormat(int format) {
+        qWarning() << "ReadAheadAudioFormatIO: Writing is not supported.";
+    }
+
+    int ReadAheadAudioFormatIO::channelCount() const {
+        Q_D(const ReadAheadAudioFormatIO);
+        TEST_IS_OPEN(0)
+        return d->channelCount;
+    }
+
+    void ReadAheadAudioFormatIO::setChannelCount(int channelCount) {
+        qWarning() << "ReadAheadAudioFormatIO: Writing is not supported.";
+    }
+
+    double ReadAheadAudioFormatIO::sampleRate() const {
+        Q_D(const ReadAheadAudioFormatIO);
+        TEST_IS_OPEN(0)
+        return d->sampleRate;
+    }
+
+    void ReadAheadAudioFormatIO::setSampleRate(double sampleRate) {
+        qWarning() << "ReadAheadAudioFormatIO: Writing is not supported.";
+    }
+
+    qint64 ReadAheadAudioFormatIO::length() const {
+        Q_D(const ReadAheadAudioFormatIO);
+        TEST_IS_OPEN(0)
+        return d->length;
+    }
+
+    /**
+     * Reads interleaved samples from the decoded chunks, and waits for the decoding task if the chunk at the read
+     * position is not decoded yet.
+     */
+    qint64 ReadAheadAudioFormatIO::read(float *ptr, qint64 length) {
+        Q_D(ReadAheadAudioFormatIO);
+        TEST_IS_OPEN(0)
+        QMutexLocker locker(&d->mutex);
+        length = qBound(0ll, length, d->length - d->readPosition);
+        qint64 readLength = 0;
+        while (readLength < length) {
+            if (d->chunkQueue.isEmpty()) {
+                // The wrapped object may end earlier than its reported length
+                if (d->decodePosition >= d->length && !d->isTaskRunning)
+                    break;
+                d->startTask();
+                d->chunkDecoded.wait(&d->mutex);
+                continue;
+            }
+            auto &chunk = d->chunkQueue.first();
+            auto offset = d->readPosition - chunk.position;
+            auto chunkReadLength = qMin(length - readLength, chunk.length - offset);
+            std::copy_n(chunk.data.constData() + offset * d->channelCount, chunkReadLength * d->channelCount, ptr + readLength * d->channelCount);
+            readLength += chunkReadLength;
+            d->readPosition += chunkReadLength;
+            if (d->readPosition == chunk.position + chunk.length) {
+                d->freeChunkData.append(std::move(chunk.data));
+                d->chunkQueue.removeFirst();
+            }
+        }
+        d->startTask();
+        return readLength;
+    }
+
+    qint64 ReadAheadAudioFormatIO::write(const float *ptr, qint64 length) {
+        qWarning() << "ReadAheadAudioFormatIO: Writing is not supported.";
+        return 0;
+    }
+
+    qint64 ReadAheadAudioFormatIO::seek(qint64 pos) {
+        Q_D(ReadAheadAudioFormatIO);
+        TEST_IS_OPEN(-1)
+        if (pos < 0 || pos > d->length)
+            return -1;
+        QMutexLocker locker(&d->mutex);
+        // The queue always covers the range from the read position to the decode position
+        auto queuedStart = d->chunkQueue.isEmpty() ? d->readPosition : d->chunkQueue.first().position;
+        if (pos >= queuedStart && pos <= d->decodePosition) {
+            while (!d->chunkQueue.isEmpty() && d->chunkQueue.first().position + d->chunkQueue.first().length <= pos)
+                d->freeChunkData.append(std::move(d->chunkQueue.takeFirst().data));
+        } else {
+            d->generation++;
+            d->clearChunkQueue();
+            d->decodePosition = pos;
+            d->isSeekRequired = true;
+        }
+        d->readPosition = pos;
+        d->startTask();
+        return pos;
+    }
+
+    qint64 ReadAheadAudioFormatIO::pos() const {
+        Q_D(const ReadAheadAudioFormatIO);
+        TEST_IS_OPEN(0)
+        QMutexLocker locker(&d->mutex);
+        return d->readPosition;
+    }
+
+    /**
+     * Gets the length in samples that is decoded ahead of the read position.
+     */
+    qint64 ReadAheadAudioFormatIO::bufferedLength() const {
+        Q_D(const ReadAheadAudioFormatIO);
+        QMutexLocker locker(&d->mutex);
+        if (d->chunkQueue.isEmpty())
+            return 0;
+        auto &lastChunk = d->chunkQueue.last();
+        return lastChunk.position + lastChunk.length - d->readPosition;
+    }
+
+    void ReadAheadAudioFormatIOPrivate::startTask() {
+        if (isTaskRunning || isTerminateRequested)
+            return;
+        if (chunkQueue.size() >= chunkCount || decodePosition >= length)
+            return;
+        isTaskRunning = true;
+        (threadPool ? threadPool : QThreadPool::globalInstance())->start(this);
+    }
+
+    void ReadAheadAudioFormatIOPrivate::run() {
+        QMutexLocker locker(&mutex);
+        while (!isTerminateRequested && chunkQueue.size() < chunkCount && decodePosition < length) {
+            auto currentGeneration = generation;
+            auto position = decodePosition;
+            auto readLength = qMin(chunkSize, length - position);
+            auto needsSeek = std::exchange(isSeekRequired, false);
+            auto data = freeChunkData.isEmpty() ? QVector<float>() : freeChunkData.takeLast();
+            data.resize(readLength * channelCount);
+            locker.unlock();
+            if (needsSeek)
+                io->seek(position);
+            readLength = io->read(data.data(), readLength);
+            locker.relock();
+            if (currentGeneration != generation) {
+                freeChunkData.append(std::move(data));
+                continue;
+            }
+            if (readLength <= 0) {
+                // The wrapped object ends earlier than its reported length, so the reader is told that nothing remains
+                freeChunkData.append(std::move(data));
+                decodePosition = length;
+                break;
+            }
+            chunkQueue.append({std::move(data), position, readLength});
+            decodePosition += readLength;
+            chunkDecoded.wakeAll();
+        }
+        isTaskRunning = false;
+        chunkDecoded.wakeAll();
+        taskFinished.wakeAll();
+    }
+
+    void ReadAheadAudioFormatIOPrivate::clearChunkQueue() {
+        for (auto &chunk : chunkQueue)
+            freeChunkData.append(std::move(chunk.data));
+        chunkQueue.clear();
+    }
+
+    void ReadAheadAudioFormatIOPrivate::waitForTask() {
+        while (isTaskRunning)
+            taskFinished.wait(&mutex);
+    }
+
+}
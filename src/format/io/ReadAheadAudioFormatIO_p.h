@@ -0,0 +1,79 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#ifndef TALCS_READAHEADAUDIOFORMATIO_P_H
+#define TALCS_READAHEADAUDIOFORMATIO_P_H
+
+#include <QList>
+#include <QMutex>
+#include <QRunnable>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <TalcsCore/TakeOwnershipPointer.h>
+#include <TalcsFormat/ReadAheadAudioFormatIO.h>
+
+namespace talcs {
+
+    class ReadAheadAudioFormatIOPrivate : public QRunnable {
+        Q_DECLARE_PUBLIC(ReadAheadAudioFormatIO)
+    public:
+        ReadAheadAudioFormatIO *q_ptr;
+
+        TakeOwnershipPointer<AbstractAudioFormatIO> io;
+        qint64 chunkSize = 16384;
+        int chunkCount = 8;
+        QThreadPool *threadPool = nullptr;
+
+        // The properties of the AudioFormatIO object are cached when opened, so that it is only accessed by the
+        // decoding task afterward
+        AbstractAudioFormatIO::OpenMode openMode{};
+        int format = 0;
+        int channelCount = 0;
+        double sampleRate = 0;
+        qint64 length = 0;
+
+        // The decoded chunks are queued in order from the read position. A seek out of the queue increases the
+        // generation, and the decoding task discards the chunk it is decoding if the generation is outdated.
+        struct Chunk {
+            QVector<float> data;
+            qint64 position = 0;
+            qint64 length = 0;
+        };
+        QList<Chunk> chunkQueue;
+        QList<QVector<float>> freeChunkData;
+        qint64 readPosition = 0;
+        qint64 decodePosition = 0;
+        quint64 generation = 0;
+        bool isSeekRequired = false;
+        bool isTaskRunning = false;
+        bool isTerminateRequested = false;
+
+        mutable QMutex mutex;
+        QWaitCondition chunkDecoded;
+        QWaitCondition taskFinished;
+
+        void run() override;
+        void startTask();
+        void clearChunkQueue();
+        void waitForTask();
+    };
+}
+
+#endif //TALCS_READAHEADAUDIOFORMATIO_P_H
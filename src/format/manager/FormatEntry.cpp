@@ -19,6 +19,8 @@
 
 #include "FormatEntry.h"
 
+#include <TalcsFormat/AbstractAudioFormatIO.h>
+
 namespace talcs {
 
     FormatEntry::~FormatEntry() = default;
@@ -27,6 +29,35 @@ namespace talcs {
         return {};
     }
 
+    /**
+     * Checks whether the first bytes of a file identify it as a format of this entry. FormatManager tries the entry
+     * that claims the file before the one hinted by the extension.
+     *
+     * @param header the first FormatManager::HeaderSize bytes of the file, or fewer if the file is shorter
+     */
+    bool FormatEntry::matchesHeader(const QByteArray &header) const {
+        Q_UNUSED(header)
+        return false;
+    }
+
+    /**
+     * Loads a file like getFormatLoad(), and gets the properties of the file for the probe cache of FormatManager, so
+     * that FormatManager does not have to open the file again.
+     *
+     * If @p probeInfo is not empty, it holds the properties recorded when this entry loaded the same unchanged file
+     * before, and the entry may trust them instead of validating the file. Otherwise, the entry fills in the
+     * properties it gets while loading, or leaves it empty if it does not open the file.
+     *
+     * The default implementation calls getFormatLoad(), and fills in the properties if the returned object is open.
+     * Entries that validate the file by opening and closing it should override this function.
+     */
+    talcs::AbstractAudioFormatIO *FormatEntry::getFormatLoadProbed(const QString &filename, const QVariant &userData, FormatManager::ProbeInfo &probeInfo) {
+        auto io = getFormatLoad(filename, userData);
+        if (io && io->openMode() != AbstractAudioFormatIO::NotOpen)
+            probeInfo = {{}, io->format(), io->channelCount(), io->sampleRate(), io->length()};
+        return io;
+    }
+
     FormatEntry::FormatEntry(QObject *parent) : QObject(parent) {
     }
 }
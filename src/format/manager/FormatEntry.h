@@ -23,6 +23,7 @@
 #include <QObject>
 
 #include <TalcsFormat/TalcsFormatGlobal.h>
+#include <TalcsFormat/FormatManager.h>
 
 namespace talcs {
 
@@ -35,8 +36,10 @@ namespace talcs {
 
         virtual QStringList filters() const = 0;
         virtual QStringList extensionHints() const;
+        virtual bool matchesHeader(const QByteArray &header) const;
         virtual talcs::AbstractAudioFormatIO *getFormatOpen(const QString &filename, QVariant &userData, QWidget *win) = 0;
         virtual talcs::AbstractAudioFormatIO *getFormatLoad(const QString &filename, const QVariant &userData) = 0;
+        virtual talcs::AbstractAudioFormatIO *getFormatLoadProbed(const QString &filename, const QVariant &userData, FormatManager::ProbeInfo &probeInfo);
 
     protected:
         explicit FormatEntry(QObject *parent = nullptr);
@@ -19,12 +19,18 @@
 
 #include "FormatManager.h"
 
+#include <QFile>
 #include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
 
 #include "FormatManager_p.h"
 
 #include <set>
 
+#include <TalcsFormat/AbstractAudioFormatIO.h>
 #include <TalcsFormat/FormatEntry.h>
 
 namespace talcs {
@@ -33,7 +39,11 @@ namespace talcs {
         d->q_ptr = this;
     }
 
-    FormatManager::~FormatManager() = default;
+    FormatManager::~FormatManager() {
+        Q_D(FormatManager);
+        if (d->isProbeCacheDirty)
+            saveProbeCache();
+    }
 
     void FormatManager::addEntry(FormatEntry *entry) {
         Q_D(FormatManager);
@@ -73,31 +83,155 @@ namespace talcs {
         return d->extensionHintDict.value(extension);
     }
 
+    FormatEntry *FormatManager::detectFromHeader(const QByteArray &header) const {
+        Q_D(const FormatManager);
+        if (header.isEmpty())
+            return nullptr;
+        for (auto entry : d->entries) {
+            if (entry->matchesHeader(header))
+                return entry;
+        }
+        return nullptr;
+    }
+
+    FormatManager::ProbeInfo FormatManager::probeInfo(const QString &filename) const {
+        Q_D(const FormatManager);
+        return d->findProbeInfo(QFileInfo(filename));
+    }
+
+    void FormatManager::setProbeCacheFileName(const QString &fileName) {
+        Q_D(FormatManager);
+        if (d->isProbeCacheDirty)
+            saveProbeCache();
+        QMutexLocker locker(&d->probeCacheMutex);
+        d->probeCacheFileName = fileName;
+        d->loadProbeCache();
+    }
+
+    QString FormatManager::probeCacheFileName() const {
+        Q_D(const FormatManager);
+        QMutexLocker locker(&d->probeCacheMutex);
+        return d->probeCacheFileName;
+    }
+
+    bool FormatManager::saveProbeCache() const {
+        Q_D(const FormatManager);
+        QMutexLocker locker(&d->probeCacheMutex);
+        if (d->probeCacheFileName.isEmpty())
+            return false;
+        QJsonArray records;
+        for (auto it = d->probeCache.cbegin(); it != d->probeCache.cend(); it++) {
+            records.append(QJsonObject({
+                {"path", it.key()},
+                {"size", it->size},
+                {"lastModified", it->lastModified.toMSecsSinceEpoch()},
+                {"entry", it->info.entryClassName},
+                {"format", it->info.format},
+                {"channelCount", it->info.channelCount},
+                {"sampleRate", it->info.sampleRate},
+                {"length", it->info.length},
+            }));
+        }
+        QSaveFile f(d->probeCacheFileName);
+        if (!f.open(QIODevice::WriteOnly))
+            return false;
+        f.write(QJsonDocument(records).toJson(QJsonDocument::Compact));
+        if (!f.commit())
+            return false;
+        d->isProbeCacheDirty = false;
+        return true;
+    }
+
     talcs::AbstractAudioFormatIO *FormatManager::getFormatLoad(const QString &filename, const QVariant &userData, const QString &entryClassName) const {
         Q_D(const FormatManager);
+        QFileInfo fileInfo(filename);
         auto entries = d->entries;
-        {
-            auto extension = QFileInfo(filename).suffix();
-            auto hintedEntry = extension.isEmpty() ? nullptr : hintFromExtension(extension);
-            if (hintedEntry) {
-                entries.removeOne(hintedEntry);
-                entries.prepend(hintedEntry);
-            }
-        }
-        if (!entryClassName.isEmpty()) {
-            auto specifiedEntry = std::find_if(d->entries.cbegin(), d->entries.cend(), [entryClassName](FormatEntry *entry) {
-                return entry->metaObject()->className() == entryClassName;
-            });
-            if (specifiedEntry != d->entries.cend()) {
-                auto entry = *specifiedEntry;
-                entries.removeOne(entry);
-                entries.prepend(entry);
-            }
+        auto prependEntry = [&entries](FormatEntry *entry) {
+            if (!entry)
+                return;
+            entries.removeOne(entry);
+            entries.prepend(entry);
+        };
+        // Prepended from the lowest priority: extension hint, magic bytes, cached entry, then the specified entry
+        auto cachedInfo = d->findProbeInfo(fileInfo);
+        FormatEntry *cachedEntry = nullptr;
+        if (cachedInfo.entryClassName.isEmpty()) {
+            auto extension = fileInfo.suffix();
+            prependEntry(extension.isEmpty() ? nullptr : hintFromExtension(extension));
+            QFile f(filename);
+            if (f.open(QIODevice::ReadOnly))
+                prependEntry(detectFromHeader(f.read(HeaderSize)));
+        } else {
+            cachedEntry = d->findEntry(cachedInfo.entryClassName);
+            prependEntry(cachedEntry);
         }
+        if (!entryClassName.isEmpty())
+            prependEntry(d->findEntry(entryClassName));
         for (auto entry : entries) {
-            if (auto io = entry->getFormatLoad(filename, userData))
-                return io;
+            // The cached entry is given the recorded properties so that it can skip validating the file, and the
+            // other entries record the properties from their own open
+            auto info = entry == cachedEntry ? cachedInfo : ProbeInfo();
+            auto io = entry->getFormatLoadProbed(filename, userData, info);
+            if (!io)
+                continue;
+            if (entry != cachedEntry && info.channelCount > 0) {
+                info.entryClassName = entry->metaObject()->className();
+                d->insertProbeInfo(fileInfo, info);
+            }
+            return io;
         }
         return nullptr;
     }
+
+    FormatEntry *FormatManagerPrivate::findEntry(const QString &entryClassName) const {
+        auto it = std::find_if(entries.cbegin(), entries.cend(), [entryClassName](FormatEntry *entry) {
+            return entry->metaObject()->className() == entryClassName;
+        });
+        return it == entries.cend() ? nullptr : *it;
+    }
+
+    FormatManager::ProbeInfo FormatManagerPrivate::findProbeInfo(const QFileInfo &fileInfo) const {
+        QMutexLocker locker(&probeCacheMutex);
+        if (probeCacheFileName.isEmpty() || !fileInfo.isFile())
+            return {};
+        auto it = probeCache.constFind(fileInfo.canonicalFilePath());
+        if (it == probeCache.cend() || it->size != fileInfo.size() || it->lastModified != fileInfo.lastModified())
+            return {};
+        return it->info;
+    }
+
+    void FormatManagerPrivate::insertProbeInfo(const QFileInfo &fileInfo, const FormatManager::ProbeInfo &info) const {
+        QMutexLocker locker(&probeCacheMutex);
+        if (probeCacheFileName.isEmpty() || !fileInfo.isFile())
+            return;
+        probeCache.insert(fileInfo.canonicalFilePath(), {fileInfo.size(), fileInfo.lastModified(), info});
+        isProbeCacheDirty = true;
+    }
+
+    void FormatManagerPrivate::loadProbeCache() {
+        probeCache.clear();
+        isProbeCacheDirty = false;
+        QFile f(probeCacheFileName);
+        if (probeCacheFileName.isEmpty() || !f.open(QIODevice::ReadOnly))
+            return;
+        for (const auto &value : QJsonDocument::fromJson(f.readAll()).array()) {
+            auto record = value.toObject();
+            // Records of files that have been changed are dropped when the cache is saved
+            QFileInfo fileInfo(record.value("path").toString());
+            if (!fileInfo.isFile() || fileInfo.size() != record.value("size").toVariant().toLongLong() ||
+                fileInfo.lastModified().toMSecsSinceEpoch() != record.value("lastModified").toVariant().toLongLong())
+                continue;
+            probeCache.insert(fileInfo.canonicalFilePath(), {
+                fileInfo.size(),
+                fileInfo.lastModified(),
+                {
+                    record.value("entry").toString(),
+                    record.value("format").toInt(),
+                    record.value("channelCount").toInt(),
+                    record.value("sampleRate").toDouble(),
+                    record.value("length").toVariant().toLongLong(),
+                }
+            });
+        }
+    }
 }
@@ -47,6 +47,22 @@ namespace talcs {
 
         FormatEntry *hintFromExtension(const QString &extension) const;
 
+        static constexpr int HeaderSize = 64;
+        FormatEntry *detectFromHeader(const QByteArray &header) const;
+
+        struct ProbeInfo {
+            QString entryClassName;
+            int format = 0;
+            int channelCount = 0;
+            double sampleRate = 0;
+            qint64 length = 0;
+        };
+        ProbeInfo probeInfo(const QString &filename) const;
+
+        void setProbeCacheFileName(const QString &fileName);
+        QString probeCacheFileName() const;
+        bool saveProbeCache() const;
+
         talcs::AbstractAudioFormatIO *getFormatLoad(const QString &filename, const QVariant &userData = {}, const QString &entryClassName = {}) const;
 
     private:
@@ -22,7 +22,10 @@
 
 #include <TalcsFormat/FormatManager.h>
 
+#include <QDateTime>
+#include <QFileInfo>
 #include <QHash>
+#include <QMutex>
 
 namespace talcs {
 
@@ -32,6 +35,21 @@ namespace talcs {
         FormatManager *q_ptr;
         QList<FormatEntry *> entries;
         QHash<QString, FormatEntry *> extensionHintDict;
+
+        struct ProbeCacheRecord {
+            qint64 size;
+            QDateTime lastModified;
+            FormatManager::ProbeInfo info;
+        };
+        mutable QMutex probeCacheMutex;
+        mutable QHash<QString, ProbeCacheRecord> probeCache;
+        mutable bool isProbeCacheDirty = false;
+        QString probeCacheFileName;
+
+        FormatEntry *findEntry(const QString &entryClassName) const;
+        FormatManager::ProbeInfo findProbeInfo(const QFileInfo &fileInfo) const;
+        void insertProbeInfo(const QFileInfo &fileInfo, const FormatManager::ProbeInfo &info) const;
+        void loadProbeCache();
     };
 
 }
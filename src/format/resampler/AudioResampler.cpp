@@ -21,29 +21,124 @@
 #include "AudioResampler_p.h"
 
 #include <algorithm>
+#include <cmath>
+
+#include <QMutex>
+
+#include <TalcsCore/AudioSampleConverter.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#   define TALCS_RESAMPLER_SSE
+#   include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   define TALCS_RESAMPLER_NEON
+#   include <arm_neon.h>
+#endif
 
 namespace talcs {
 
+    static constexpr double PI = 3.14159265358979323846;
+
+    struct SincParameters {
+        // Zero crossings of the windowed sinc on each side
+        int halfLength;
+        // Filters between adjacent phases are linearly interpolated
+        int phaseCount;
+        double kaiserBeta;
+        // The cutoff relative to the lower Nyquist frequency
+        double cutoff;
+    };
+    static const SincParameters SHORT_SINC_PARAMETERS = {8, 256, 7.0, 0.85};
+    static const SincParameters SINC_PARAMETERS = {32, 512, 10.0, 0.92};
+
+    // With a variable ratio, the sinc filters are designed beforehand for cutoff ratios in steps of the tolerance, and
+    // the longest one not above the ratio is used. The filter is not lengthened further below the minimum ratio, which
+    // aliases instead.
+    static const double MIN_VARISPEED_FILTER_RATIO = 0.125;
+    static const double VARISPEED_FILTER_TOLERANCE = 0.9;
+
+    // The history of a variable-ratio resampler is allocated beforehand for the largest step, so that changing the
+    // ratio never allocates while processing. Smaller ratios are clamped.
+    static const double MIN_VARIABLE_RATIO = 0.125;
+
+    struct HalfBandParameters {
+        // Non-zero taps on each side of the center tap
+        int halfLength;
+        double kaiserBeta;
+    };
+    static const HalfBandParameters SHORT_HALF_BAND_PARAMETERS = {16, 7.0};
+    static const HalfBandParameters HALF_BAND_PARAMETERS = {48, 10.0};
+    static const HalfBandParameters HIGH_QUALITY_HALF_BAND_PARAMETERS = {64, 12.0};
+
+    // Ratios up to 16 or down to 1/16 are resampled by cascaded half-band stages
+    static const int MAX_HALF_BAND_STAGE_COUNT = 4;
+
     /**
      * @class AudioResampler
      * @brief An adapter class of [r8b::CDSPResampler](https://www.voxengo.com/public/r8brain-free-src/Documentation/a00114.html)
      * that provides Secret-Rabbit-Code-like APIs.
+     *
+     * Lower quality tiers use single-precision interpolators instead, which are cheaper and have less latency.
+     *
+     * If the ratio is a power of two (e.g. 2 or 0.5), the tiers from ShortSinc up resample with cascaded polyphase
+     * half-band filters instead, which need only half of the taps for each output sample and have less latency. The
+     * filters of each tier are designed to be on par with its general engine.
+     *
+     * A variable-ratio resampler, which is used for varispeed playback and scrubbing, always uses the interpolator of
+     * its tier (the Sinc interpolator for HighQuality), and its ratio can be changed with setRatio() without losing the
+     * state and the phase. Its ratio is not less than 1/8.
+     */
+
+    /**
+     * @enum AudioResampler::Quality
+     * The quality tier of resampling.
+     *
+     * @var AudioResampler::Linear
+     * Linear interpolation without anti-aliasing. Suitable for scrubbing.
+     *
+     * @var AudioResampler::Cubic
+     * 4-point Catmull-Rom interpolation without anti-aliasing. Suitable for waveform generation and scrubbing.
+     *
+     * @var AudioResampler::ShortSinc
+     * A polyphase windowed-sinc resampler with 16 taps, with a stopband attenuation of about 70 dB. Suitable for live
+     * preview.
+     *
+     * @var AudioResampler::Sinc
+     * A polyphase windowed-sinc resampler with 64 taps, with a stopband attenuation of about 100 dB. It works in single
+     * precision with SIMD inner loops, so it uses less memory bandwidth than HighQuality.
+     *
+     * @var AudioResampler::HighQuality
+     * r8brain, which works in double precision. This is the default tier, and should be used for exporting.
      */
 
     /**
      * Constructor.
      * @param ratio destination sample rate / source sample rate
      * @param bufferSize the size of each output block
+     * @param quality the quality tier
+     * @param isVariableRatio whether the ratio can be changed with setRatio()
      */
 
-    AudioResampler::AudioResampler(double ratio, qint64 bufferSize) : d(new AudioResamplerPrivate) {
+    AudioResampler::AudioResampler(double ratio, qint64 bufferSize, Quality quality, bool isVariableRatio) : d(new AudioResamplerPrivate) {
         Q_ASSERT(ratio > 0.0);
-        d->ratio = ratio;
+        d->ratio = isVariableRatio ? qMax(ratio, MIN_VARIABLE_RATIO) : ratio;
         d->bufferSize = static_cast<int>(bufferSize);
+        d->quality = quality;
+        d->isVariableRatio = isVariableRatio;
+        if (isVariableRatio) {
+            d->initializeInterpolator();
+            return;
+        }
         if (qFuzzyCompare(ratio, 1.0)) {
             d->copyOnly = true;
             return;
         }
+        if (quality >= ShortSinc && d->initializeHalfBand())
+            return;
+        if (quality != HighQuality) {
+            d->initializeInterpolator();
+            return;
+        }
         int maxInLen = r8b::CDSPResampler(1, ratio, d->bufferSize).getInLenBeforeOutPos(d->bufferSize);
         d->resampler.reset(new r8b::CDSPResampler(1, ratio, maxInLen));
         int outputBufferSize = r8b::CDSPResampler(1, ratio, std::ceil(d->bufferSize / ratio)).getMaxOutLen(0);
@@ -61,8 +156,13 @@ namespace talcs {
      * Resets the initial states of the resampler. This function should be called when the source is changed.
      */
     void AudioResampler::reset() {
+        d->outputLength = 0;
         if (d->copyOnly)
             return;
+        if (!d->halfBandStages.isEmpty())
+            return d->resetHalfBand();
+        if (d->isVariableRatio || d->quality != HighQuality)
+            return d->resetInterpolator();
         d->resampler->clear();
         std::fill(d->outputBuffer.begin(), d->outputBuffer.end(), 0);
         d->outputBufferOffset = 0;
@@ -71,12 +171,55 @@ namespace talcs {
     }
 
     /**
-     * Gets the ratio of the resampler.
+     * Gets the ratio of the resampler. If the ratio is ramping, the target ratio is returned.
      */
     double AudioResampler::ratio() const {
         return d->ratio;
     }
 
+    /**
+     * Changes the ratio of a variable-ratio resampler from the next output sample.
+     *
+     * The input time advances continuously, so the phase is preserved. Ratios less than 1/8 are clamped, so that
+     * processing does not need to allocate larger buffers.
+     * @param ratio destination sample rate / source sample rate
+     * @param rampLength the number of output samples over which the ratio glides to the new value, or 0 to change it
+     * at once
+     */
+    void AudioResampler::setRatio(double ratio, qint64 rampLength) {
+        Q_ASSERT(d->isVariableRatio && ratio > 0.0);
+        if (!d->isVariableRatio || ratio <= 0.0)
+            return;
+        ratio = qMax(ratio, MIN_VARIABLE_RATIO);
+        d->ratio = ratio;
+        d->targetStep = 1.0 / ratio;
+        if (rampLength > 0) {
+            d->stepDelta = (d->targetStep - d->step) / static_cast<double>(rampLength);
+            d->rampRemaining = rampLength;
+        } else {
+            d->rampRemaining = 0;
+            d->setStep(d->targetStep);
+        }
+    }
+
+    /**
+     * Gets whether the ratio can be changed with setRatio().
+     */
+    bool AudioResampler::isVariableRatio() const {
+        return d->isVariableRatio;
+    }
+
+    /**
+     * Gets the input time of the next output sample since the last reset, in input samples.
+     *
+     * With a variable ratio, this tracks the position in the source as the ratio changes.
+     */
+    double AudioResampler::inputTime() const {
+        if (d->isVariableRatio)
+            return static_cast<double>(d->timeInt) + d->timeFrac;
+        return static_cast<double>(d->outputLength) / d->ratio;
+    }
+
     /**
      * Gets the buffer size of the resampler.
      */
@@ -84,12 +227,34 @@ namespace talcs {
         return d->bufferSize;
     }
 
+    /**
+     * Gets the quality tier of the resampler.
+     */
+    AudioResampler::Quality AudioResampler::quality() const {
+        return d->quality;
+    }
+
+    /**
+     * Gets the maximum length of an input block that read() is requested to provide.
+     */
+    qint64 AudioResampler::maxReadLength() const {
+        if (d->copyOnly)
+            return d->bufferSize;
+        if (!d->halfBandStages.isEmpty())
+            return d->halfBandStages.first().maxReadLength;
+        if (d->isVariableRatio || d->quality != HighQuality)
+            return d->maxReadLength;
+        return d->inputBuffer.size();
+    }
+
     /**
      * Processes the output buffer.
      *
      * This function does not provide functionalities of getting read length, and it should be checked in other ways.
      */
     void AudioResampler::process(float *buffer, qint64 length) {
+        d->outputLength += length;
+
         // If ratio is 1.0 then just copy.
         if (d->copyOnly)
             return read(buffer, length);
@@ -97,6 +262,11 @@ namespace talcs {
         if (length == 0)
             return;
 
+        if (!d->halfBandStages.isEmpty())
+            return d->processHalfBand(this, static_cast<int>(d->halfBandStages.size()) - 1, buffer, length);
+
+        if (d->isVariableRatio || d->quality != HighQuality)
+            return d->processInterpolator(this, buffer, length);
 
         for (int i = 0; i < 2; i++) {
             bool readFlag = true;
@@ -164,4 +334,406 @@ namespace talcs {
      * a block of the specified length, the function needs to fill the exceeding part with zeros.
      */
 
+    static double besselI0(double x) {
+        double sum = 1.0;
+        double term = 1.0;
+        for (int k = 1; k < 64; k++) {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+            if (term < sum * 1e-17)
+                break;
+        }
+        return sum;
+    }
+
+    static inline float dotProduct(const float *a, const float *b, int length) {
+        int i = 0;
+        float sum = 0.0f;
+#if defined(TALCS_RESAMPLER_SSE)
+        auto acc0 = _mm_setzero_ps();
+        auto acc1 = _mm_setzero_ps();
+        for (; i + 8 <= length; i += 8) {
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        }
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, _mm_add_ps(acc0, acc1));
+        sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(TALCS_RESAMPLER_NEON)
+        auto acc0 = vdupq_n_f32(0.0f);
+        auto acc1 = vdupq_n_f32(0.0f);
+        for (; i + 8 <= length; i += 8) {
+            acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+            acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+        }
+        float lanes[4];
+        vst1q_f32(lanes, vaddq_f32(acc0, acc1));
+        sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+        for (; i < length; i++)
+            sum += a[i] * b[i];
+        return sum;
+    }
+
+    static SincTable designSincTable(const SincParameters *parameters, double cutoffRatio) {
+        // When downsampling, the sinc is stretched, so the filter is lengthened to keep the number of zero crossings
+        SincTable table;
+        table.cutoffRatio = cutoffRatio;
+        table.halfLength = static_cast<int>(std::ceil(parameters->halfLength / cutoffRatio));
+        auto halfLength = table.halfLength;
+        auto phaseCount = parameters->phaseCount;
+        // The filter of phase p is applied to the input samples around time t = n + p / phaseCount, and its tap k
+        // corresponds to the input sample at n - halfLength + 1 + k. The last phase equals the first phase
+        // shifted by one sample, so that every phase can be interpolated with the next one.
+        auto tapCount = 2 * halfLength;
+        auto cutoff = cutoffRatio * parameters->cutoff;
+        auto i0Beta = besselI0(parameters->kaiserBeta);
+        table.taps.resize((phaseCount + 1) * tapCount);
+        for (int p = 0; p <= phaseCount; p++) {
+            for (int k = 0; k < tapCount; k++) {
+                double x = k - (halfLength - 1) - static_cast<double>(p) / phaseCount;
+                double w = x / halfLength;
+                double window = std::abs(w) < 1.0 ? besselI0(parameters->kaiserBeta * std::sqrt(1.0 - w * w)) / i0Beta : 0.0;
+                double y = x == 0.0 ? 1.0 : std::sin(PI * cutoff * x) / (PI * cutoff * x);
+                table.taps[p * tapCount + k] = static_cast<float>(cutoff * y * window);
+            }
+        }
+        return table;
+    }
+
+    // The filters of variable ratios take several megabytes and some time to design, so they are shared by all
+    // resamplers of the same tier, and freed with the last one
+    static QSharedPointer<const QVector<SincTable>> varispeedSincTables(const SincParameters *parameters) {
+        static QMutex mutex;
+        static QWeakPointer<const QVector<SincTable>> shortSincTables;
+        static QWeakPointer<const QVector<SincTable>> sincTables;
+        QMutexLocker locker(&mutex);
+        auto &sharedTables = parameters == &SHORT_SINC_PARAMETERS ? shortSincTables : sincTables;
+        if (auto tables = sharedTables.toStrongRef())
+            return tables;
+        QSharedPointer<QVector<SincTable>> tables(new QVector<SincTable>);
+        for (double cutoffRatio = 1.0;; cutoffRatio *= VARISPEED_FILTER_TOLERANCE) {
+            tables->append(designSincTable(parameters, qMax(cutoffRatio, MIN_VARISPEED_FILTER_RATIO)));
+            if (cutoffRatio <= MIN_VARISPEED_FILTER_RATIO)
+                break;
+        }
+        sharedTables = tables;
+        return tables;
+    }
+
+    void AudioResamplerPrivate::initializeInterpolator() {
+        switch (quality) {
+            case AudioResampler::Linear:
+                halfLength = 1;
+                break;
+            case AudioResampler::Cubic:
+                halfLength = 2;
+                break;
+            case AudioResampler::ShortSinc:
+                sincParameters = &SHORT_SINC_PARAMETERS;
+                break;
+            default:
+                sincParameters = &SINC_PARAMETERS;
+                break;
+        }
+        step = 1.0 / ratio;
+        stepInt = static_cast<qint64>(std::floor(step));
+        stepFrac = step - static_cast<double>(stepInt);
+        if (sincParameters) {
+            phaseCount = sincParameters->phaseCount;
+            if (isVariableRatio) {
+                sincTables = varispeedSincTables(sincParameters);
+            } else {
+                sincTables.reset(new QVector<SincTable>{designSincTable(sincParameters, qMin(1.0, ratio))});
+            }
+            selectSincTable(qMin(1.0, ratio));
+            // The filter may be lengthened later with a variable ratio, so the history is kept for the longest one
+            historyHalfLength = isVariableRatio ? static_cast<int>(std::ceil(sincParameters->halfLength / MIN_VARISPEED_FILTER_RATIO)) : halfLength;
+        } else {
+            historyHalfLength = halfLength;
+        }
+        reserveHistory(isVariableRatio ? 1.0 / MIN_VARIABLE_RATIO : step);
+        resetInterpolator();
+    }
+
+    void AudioResamplerPrivate::selectSincTable(double cutoffRatio) {
+        // The cutoff ratio of table i is VARISPEED_FILTER_TOLERANCE ^ i, except the last one
+        int index = 0;
+        if (sincTables->size() > 1 && cutoffRatio < 1.0)
+            index = qBound(0, static_cast<int>(std::ceil(std::log(cutoffRatio) / std::log(VARISPEED_FILTER_TOLERANCE) - 1e-9)), sincTables->size() - 1);
+        sincTable = &sincTables->at(index);
+        halfLength = sincTable->halfLength;
+    }
+
+    void AudioResamplerPrivate::reserveHistory(double maxStep) {
+        auto maxStepLength = static_cast<int>(std::ceil(bufferSize * maxStep)) + 2;
+        maxReadLength = qMax(maxReadLength, maxStepLength + historyHalfLength + 2);
+        auto historySize = 2 * historyHalfLength + maxStepLength + maxReadLength;
+        if (history.size() < historySize)
+            history.resize(historySize);
+    }
+
+    void AudioResamplerPrivate::resetInterpolator() {
+        // Zeros are assumed before the first input sample, so that the output is aligned with the input
+        std::fill(history.begin(), history.end(), 0.0f);
+        historyStart = -(historyHalfLength - 1);
+        historyLength = historyHalfLength - 1;
+        timeInt = 0;
+        timeFrac = 0;
+        if (rampRemaining) {
+            rampRemaining = 0;
+            setStep(targetStep);
+        }
+    }
+
+    void AudioResamplerPrivate::setStep(double newStep) {
+        step = newStep;
+        stepInt = static_cast<qint64>(std::floor(step));
+        stepFrac = step - static_cast<double>(stepInt);
+    }
+
+    void AudioResamplerPrivate::processInterpolator(AudioResampler *q, float *buffer, qint64 length) {
+        // The input time from the current output sample to the last one
+        auto span = static_cast<double>(length - 1) * step;
+        if (rampRemaining) {
+            auto rampSpan = static_cast<double>(qMin(length - 1, rampRemaining));
+            span = rampSpan * step + stepDelta * rampSpan * (rampSpan + 1) / 2 + static_cast<double>(length - 1 - rampSpan) * targetStep;
+        }
+
+        if (isVariableRatio && sincParameters) {
+            // The filter is adapted to the largest step of this block. The history has been allocated for any step.
+            auto maxStep = rampRemaining ? qMax(step, targetStep) : step;
+            selectSincTable(1.0 / maxStep);
+        }
+
+        // Discards the samples that are no longer needed
+        auto firstNeeded = timeInt - historyHalfLength + 1;
+        auto dropLength = firstNeeded - historyStart;
+        if (dropLength >= historyLength) {
+            // Only happens when downsampling by a large ratio. Skips the input between the filters.
+            auto skipLength = dropLength - historyLength;
+            while (skipLength > 0) {
+                auto readLength = static_cast<int>(qMin<qint64>(skipLength, maxReadLength));
+                q->read(history.data(), readLength);
+                skipLength -= readLength;
+            }
+            historyStart = firstNeeded;
+            historyLength = 0;
+        } else if (dropLength > 0) {
+            std::copy(history.cbegin() + dropLength, history.cbegin() + historyLength, history.begin());
+            historyStart = firstNeeded;
+            historyLength -= static_cast<int>(dropLength);
+        }
+
+        // Reads the samples needed by the last output sample, with a margin of one sample for rounding
+        auto lastTimeInt = timeInt + static_cast<qint64>(std::floor(timeFrac + span));
+        auto neededEnd = lastTimeInt + halfLength + 2;
+        auto readLength = neededEnd - (historyStart + historyLength);
+        if (readLength > 0) {
+            Q_ASSERT(historyLength + readLength <= history.size());
+            q->read(history.data() + historyLength, readLength);
+            historyLength += static_cast<int>(readLength);
+        }
+
+        auto advance = [this] {
+            if (Q_UNLIKELY(rampRemaining)) {
+                if (--rampRemaining)
+                    setStep(step + stepDelta);
+                else
+                    setStep(targetStep);
+            }
+            timeInt += stepInt;
+            timeFrac += stepFrac;
+            if (timeFrac >= 1.0) {
+                timeFrac -= 1.0;
+                timeInt++;
+            }
+        };
+        switch (quality) {
+            case AudioResampler::Linear:
+                for (qint64 i = 0; i < length; i++) {
+                    auto x = history.constData() + (timeInt - historyStart);
+                    auto a = static_cast<float>(timeFrac);
+                    buffer[i] = x[0] + a * (x[1] - x[0]);
+                    advance();
+                }
+                break;
+            case AudioResampler::Cubic:
+                for (qint64 i = 0; i < length; i++) {
+                    auto x = history.constData() + (timeInt - 1 - historyStart);
+                    auto a = static_cast<float>(timeFrac);
+                    auto c1 = 0.5f * (x[2] - x[0]);
+                    auto c2 = x[0] - 2.5f * x[1] + 2.0f * x[2] - 0.5f * x[3];
+                    auto c3 = 0.5f * (x[3] - x[0]) + 1.5f * (x[1] - x[2]);
+                    buffer[i] = ((c3 * a + c2) * a + c1) * a + x[1];
+                    advance();
+                }
+                break;
+            default: {
+                auto tapCount = 2 * halfLength;
+                for (qint64 i = 0; i < length; i++) {
+                    auto base = history.constData() + (timeInt - halfLength + 1 - historyStart);
+                    auto phase = timeFrac * phaseCount;
+                    auto phaseIndex = qMin(static_cast<int>(phase), phaseCount - 1);
+                    auto a = static_cast<float>(phase - phaseIndex);
+                    auto filter = sincTable->taps.constData() + phaseIndex * tapCount;
+                    auto y0 = dotProduct(base, filter, tapCount);
+                    auto y1 = dotProduct(base, filter + tapCount, tapCount);
+                    buffer[i] = y0 + a * (y1 - y0);
+                    advance();
+                }
+                break;
+            }
+        }
+    }
+
+    bool AudioResamplerPrivate::initializeHalfBand() {
+        int exponent;
+        if (std::frexp(ratio, &exponent) != 0.5)
+            return false;
+        // ratio == 2 ^ (exponent - 1)
+        auto isUpsampling = exponent > 1;
+        auto stageCount = isUpsampling ? exponent - 1 : 1 - exponent;
+        if (stageCount > MAX_HALF_BAND_STAGE_COUNT)
+            return false;
+
+        const HalfBandParameters *parameters;
+        switch (quality) {
+            case AudioResampler::ShortSinc:
+                parameters = &SHORT_HALF_BAND_PARAMETERS;
+                break;
+            case AudioResampler::Sinc:
+                parameters = &HALF_BAND_PARAMETERS;
+                break;
+            default:
+                parameters = &HIGH_QUALITY_HALF_BAND_PARAMETERS;
+                break;
+        }
+        // The filter is a windowed sinc with the cutoff at half of the higher Nyquist frequency, whose taps at even
+        // offsets are zero except the center one, which is 0.5. Tap j of halfBandTable is at the offset 2 * (j - halfLength) + 1
+        // in the higher sample rate.
+        halfLength = parameters->halfLength;
+        auto tapCount = 2 * halfLength;
+        auto i0Beta = besselI0(parameters->kaiserBeta);
+        halfBandTable.resize(tapCount);
+        double sum = 0.0;
+        for (int j = 0; j < tapCount; j++) {
+            double x = 2 * (j - halfLength) + 1;
+            double w = x / tapCount;
+            double window = besselI0(parameters->kaiserBeta * std::sqrt(1.0 - w * w)) / i0Beta;
+            double y = std::sin(0.5 * PI * x) / (PI * x) * window;
+            halfBandTable[j] = static_cast<float>(y);
+            sum += y;
+        }
+        // Normalizes the DC gain
+        for (auto &tap : halfBandTable)
+            tap = static_cast<float>(tap * 0.5 / sum);
+
+        // The maximum read length of each stage is the maximum output length of the previous one
+        halfBandStages.resize(stageCount);
+        auto maxOutputLength = bufferSize;
+        for (int i = stageCount - 1; i >= 0; i--) {
+            auto &stage = halfBandStages[i];
+            stage.isUpsampling = isUpsampling;
+            if (isUpsampling) {
+                stage.maxReadLength = maxOutputLength / 2 + tapCount + 2;
+                stage.history.resize(2 * stage.maxReadLength + tapCount);
+            } else {
+                stage.maxReadLength = 2 * maxOutputLength + tapCount;
+                stage.history.resize(stage.maxReadLength + tapCount);
+                stage.oddHistory.resize(stage.maxReadLength + tapCount);
+                stage.readBuffer.resize(stage.maxReadLength);
+            }
+            maxOutputLength = stage.maxReadLength;
+        }
+        resetHalfBand();
+        return true;
+    }
+
+    void AudioResamplerPrivate::resetHalfBand() {
+        // Zeros are assumed before the first input sample, so that the output is aligned with the input
+        for (auto &stage : halfBandStages) {
+            std::fill(stage.history.begin(), stage.history.end(), 0.0f);
+            std::fill(stage.oddHistory.begin(), stage.oddHistory.end(), 0.0f);
+            if (stage.isUpsampling) {
+                stage.historyStart = -(halfLength - 1);
+                stage.historyLength = halfLength - 1;
+            } else {
+                stage.historyStart = 0;
+                stage.historyLength = 0;
+                stage.oddHistoryStart = -halfLength;
+                stage.oddHistoryLength = halfLength;
+            }
+            stage.inputPosition = 0;
+            stage.outputPosition = 0;
+        }
+    }
+
+    static inline void dropHistory(float *history, qint64 &historyStart, int &historyLength, qint64 firstNeeded) {
+        auto dropLength = static_cast<int>(qMin<qint64>(firstNeeded - historyStart, historyLength));
+        if (dropLength <= 0)
+            return;
+        std::copy(history + dropLength, history + historyLength, history);
+        historyStart += dropLength;
+        historyLength -= dropLength;
+    }
+
+    void AudioResamplerPrivate::processHalfBand(AudioResampler *q, int stageIndex, float *buffer, qint64 length) {
+        if (length == 0)
+            return;
+        auto &stage = halfBandStages[stageIndex];
+        auto read = [this, q, stageIndex](float *inputBlock, qint64 readLength) {
+            if (stageIndex == 0)
+                q->read(inputBlock, readLength);
+            else
+                processHalfBand(q, stageIndex - 1, inputBlock, readLength);
+        };
+        auto tapCount = 2 * halfLength;
+        auto table = halfBandTable.constData();
+        if (stage.isUpsampling) {
+            // Output sample 2k is input sample k, and output sample 2k + 1 is filtered from input samples
+            // k - halfLength + 1 to k + halfLength
+            dropHistory(stage.history.data(), stage.historyStart, stage.historyLength, (stage.outputPosition >> 1) - halfLength + 1);
+            auto neededEnd = ((stage.outputPosition + length - 1) >> 1) + halfLength + 1;
+            auto readLength = neededEnd - (stage.historyStart + stage.historyLength);
+            if (readLength > 0) {
+                Q_ASSERT(stage.historyLength + readLength <= stage.history.size());
+                read(stage.history.data() + stage.historyLength, readLength);
+                stage.historyLength += static_cast<int>(readLength);
+            }
+            auto history = stage.history.constData();
+            for (qint64 i = 0; i < length; i++) {
+                auto position = stage.outputPosition + i;
+                auto offset = (position >> 1) - stage.historyStart;
+                if (position & 1)
+                    buffer[i] = 2.0f * dotProduct(history + offset - halfLength + 1, table, tapCount);
+                else
+                    buffer[i] = history[offset];
+            }
+        } else {
+            // Output sample k is filtered from the even input sample k and the odd input samples k - halfLength to
+            // k + halfLength - 1
+            dropHistory(stage.history.data(), stage.historyStart, stage.historyLength, stage.outputPosition);
+            dropHistory(stage.oddHistory.data(), stage.oddHistoryStart, stage.oddHistoryLength, stage.outputPosition - halfLength);
+            // The input position is always even, so the input is read in pairs
+            auto inputEnd = 2 * (stage.outputPosition + length - 1) + tapCount;
+            auto pairCount = (inputEnd - stage.inputPosition) / 2;
+            if (pairCount > 0) {
+                Q_ASSERT(2 * pairCount <= stage.readBuffer.size());
+                read(stage.readBuffer.data(), 2 * pairCount);
+                float *const dest[] = {stage.history.data() + stage.historyLength, stage.oddHistory.data() + stage.oddHistoryLength};
+                AudioSampleConverter::deinterleave(dest, stage.readBuffer.constData(), 2, pairCount);
+                stage.historyLength += static_cast<int>(pairCount);
+                stage.oddHistoryLength += static_cast<int>(pairCount);
+                stage.inputPosition = inputEnd;
+            }
+            Q_ASSERT(stage.historyStart == stage.outputPosition && stage.oddHistoryStart == stage.outputPosition - halfLength);
+            auto history = stage.history.constData();
+            auto oddHistory = stage.oddHistory.constData();
+            for (qint64 i = 0; i < length; i++)
+                buffer[i] = 0.5f * history[i] + dotProduct(oddHistory + i, table, tapCount);
+        }
+        stage.outputPosition += length;
+    }
+
 } // talcs
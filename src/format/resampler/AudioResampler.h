@@ -36,7 +36,15 @@ namespace talcs {
 
     class TALCSFORMAT_EXPORT AudioResampler {
     public:
-        explicit AudioResampler(double ratio, qint64 bufferSize);
+        enum Quality {
+            Linear,
+            Cubic,
+            ShortSinc,
+            Sinc,
+            HighQuality,
+        };
+
+        explicit AudioResampler(double ratio, qint64 bufferSize, Quality quality = HighQuality, bool isVariableRatio = false);
         virtual ~AudioResampler();
 
         void reset();
@@ -44,12 +52,19 @@ namespace talcs {
         void process(float *buffer, qint64 length);
 
         double ratio() const;
+        void setRatio(double ratio, qint64 rampLength = 0);
+        bool isVariableRatio() const;
+        double inputTime() const;
+
         qint64 bufferSize() const;
+        Quality quality() const;
+        qint64 maxReadLength() const;
 
     protected:
         virtual void read(float *inputBlock, qint64 length) = 0;
 
     private:
+        friend class AudioResamplerPrivate;
         QScopedPointer<AudioResamplerPrivate> d;
 
     };
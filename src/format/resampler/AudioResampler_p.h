@@ -22,16 +22,46 @@
 
 #include "AudioResampler.h"
 
+#include <QSharedPointer>
 #include <QVector>
 
 #include <r8brain-free-src/CDSPResampler.h>
 
 namespace talcs {
+    struct SincParameters;
+
+    // The polyphase filter of the sinc interpolator designed for a cutoff ratio, which holds the taps of each phase
+    struct SincTable {
+        double cutoffRatio;
+        int halfLength;
+        QVector<float> taps;
+    };
+
+    // A stage of the half-band resamplers that upsample or downsample by a factor of two. When upsampling, history holds
+    // the input samples from historyStart. When downsampling, history and oddHistory hold the even and odd input
+    // samples respectively, which are indexed in the output sample rate.
+    struct HalfBandStage {
+        bool isUpsampling = false;
+        int maxReadLength = 0;
+        QVector<float> history;
+        qint64 historyStart = 0;
+        int historyLength = 0;
+        QVector<float> oddHistory;
+        qint64 oddHistoryStart = 0;
+        int oddHistoryLength = 0;
+        QVector<float> readBuffer;
+        qint64 inputPosition = 0;
+        qint64 outputPosition = 0;
+    };
+
     class AudioResamplerPrivate {
     public:
         bool copyOnly = false;
         double ratio;
         int bufferSize;
+        AudioResampler::Quality quality;
+        bool isVariableRatio = false;
+        qint64 outputLength = 0;
         QScopedPointer<r8b::CDSPResampler> resampler;
         QVector<float> inputBuffer;
         QVector<double> f64InputBuffer;
@@ -39,6 +69,44 @@ namespace talcs {
         int outputBufferOffset = 0;
         int processedInputLength = 0;
         int processedOutputLength = 0;
+
+        // The interpolators of the tiers below HighQuality and of variable ratios. history holds the input samples from
+        // historyStart, and the input time of the next output sample is timeInt + timeFrac. The step glides to
+        // targetStep by stepDelta per output sample while rampRemaining is non-zero. The sinc filter in use is one of
+        // sincTables, which holds the filters of all cutoff ratios reachable with a variable ratio.
+        const SincParameters *sincParameters = nullptr;
+        QSharedPointer<const QVector<SincTable>> sincTables;
+        const SincTable *sincTable = nullptr;
+        int halfLength = 0;
+        int historyHalfLength = 0;
+        int phaseCount = 0;
+        int maxReadLength = 0;
+        QVector<float> history;
+        qint64 historyStart = 0;
+        int historyLength = 0;
+        qint64 timeInt = 0;
+        double timeFrac = 0;
+        double step = 1.0;
+        qint64 stepInt = 0;
+        double stepFrac = 0;
+        double targetStep = 1.0;
+        double stepDelta = 0;
+        qint64 rampRemaining = 0;
+        void initializeInterpolator();
+        void selectSincTable(double cutoffRatio);
+        void reserveHistory(double maxStep);
+        void setStep(double newStep);
+        void resetInterpolator();
+        void processInterpolator(AudioResampler *q, float *buffer, qint64 length);
+
+        // The half-band resamplers used for power-of-two ratios, in which halfLength is the number of non-zero taps on
+        // each side and halfBandTable holds the non-zero taps besides the center one. Stages are cascaded from the
+        // input to the output.
+        QVector<float> halfBandTable;
+        QVector<HalfBandStage> halfBandStages;
+        bool initializeHalfBand();
+        void resetHalfBand();
+        void processHalfBand(AudioResampler *q, int stageIndex, float *buffer, qint64 length);
     };
 }
 
@@ -21,6 +21,10 @@
 #include "MultichannelAudioResampler_p.h"
 #include "TalcsCore/AudioDataWrapper.h"
 
+#include <algorithm>
+
+#include <QThreadPool>
+
 namespace talcs {
     /**
      * @class MultichannelAudioResampler
@@ -33,15 +37,17 @@ namespace talcs {
      * @param ratio destination sample rate / source sample rate
      * @param bufferSize the size of each output block
      * @param channelCount the number of audio channels
+     * @param quality the quality tier
+     * @param isVariableRatio whether the ratio can be changed with setRatio()
      */
-    MultichannelAudioResampler::MultichannelAudioResampler(double ratio, qint64 bufferSize, int channelCount) : d(new MultichannelAudioResamplerPrivate) {
+    MultichannelAudioResampler::MultichannelAudioResampler(double ratio, qint64 bufferSize, int channelCount, AudioResampler::Quality quality, bool isVariableRatio) : d(new MultichannelAudioResamplerPrivate) {
         Q_ASSERT(channelCount > 0);
         d->channelCount = channelCount;
-        d->inputBuffer.resize(channelCount, 1);
         for (int i = 0; i < channelCount; i++) {
-            d->resamplerOfChannel.emplace_back(std::make_unique<ChannelResampler>(ratio, bufferSize, this, i));
+            d->resamplerOfChannel.emplace_back(std::make_unique<ChannelResampler>(ratio, bufferSize, quality, isVariableRatio, this, i));
         }
-        d->tmpBuf.reset(new float[bufferSize]);
+        // A process() call reads at most three input blocks: the initial one, and one in each of the two passes
+        d->inputBuffer.resize(channelCount, 3 * d->resamplerOfChannel[0]->maxReadLength());
     }
 
     /**
@@ -59,47 +65,62 @@ namespace talcs {
     }
 
     void ChannelResampler::read(float *inputBlock, qint64 length) {
-        int index = readIndexWithinCall++;
+        auto &inputBuffer = mcr->d->inputBuffer;
         if (ch == 0) {
-            mcr->d->inputBuffer.resize(-1, length);
-            mcr->read(&mcr->d->inputBuffer);
-            Q_ASSERT(index == static_cast<int>(mcr->d->inputBlockRecords.size()));
-            mcr->d->inputBlockRecords.emplace_back();
-            auto &record = mcr->d->inputBlockRecords.back();
-            record.channels.resize(mcr->d->channelCount);
-            for (int c = 0; c < mcr->d->channelCount; c++) {
-                const auto *p = mcr->d->inputBuffer.constData(c);
-                record.channels[c] = QVector<float>(p, p + length);
-            }
+            if (Q_UNLIKELY(readCursor + length > inputBuffer.sampleCount()))
+                inputBuffer.resize(-1, readCursor + length);
+            mcr->read({&inputBuffer, readCursor, length});
+            mcr->d->inputLength = readCursor + length;
         }
-        Q_ASSERT(index < static_cast<int>(mcr->d->inputBlockRecords.size()));
-        Q_ASSERT(static_cast<qint64>(mcr->d->inputBlockRecords[index].channels[ch].size()) == length);
-        const auto *p = mcr->d->inputBlockRecords[index].channels[ch].constData();
-        std::copy_n(p, length, inputBlock);
+        Q_ASSERT(readCursor + length <= mcr->d->inputLength);
+        std::copy_n(inputBuffer.constData(ch) + readCursor, length, inputBlock);
+        readCursor += length;
+    }
+
+    void ChannelResampler::run() {
+        processOutput();
+        mcr->d->doneSemaphore.release();
     }
 
     /**
      * @copydoc AudioResampler::process()
      */
     void MultichannelAudioResampler::process(const AudioSourceReadData &readData) {
-        d->inputBlockRecords.clear();
-        for (auto &resampler : d->resamplerOfChannel) {
-            resampler->readIndexWithinCall = 0;
+        d->inputLength = 0;
+        bool isContinuous = readData.buffer->isContinuous();
+        for (int i = 0; i < d->channelCount; i++) {
+            auto &resampler = d->resamplerOfChannel[i];
+            resampler->readCursor = 0;
+            resampler->outputLength = readData.length;
+            if (isContinuous && i < readData.buffer->channelCount())
+                resampler->output = readData.buffer->writePointerTo(i, readData.startPos);
+            else
+                resampler->output = resampler->tmpBuf.get();
         }
-        if (readData.buffer->isContinuous()) {
-            for (int i = 0; i < d->channelCount; i++) {
-                if (i < readData.buffer->channelCount())
-                    d->resamplerOfChannel[i]->process(readData.buffer->writePointerTo(i, readData.startPos), readData.length);
-                else
-                    d->resamplerOfChannel[i]->process(d->tmpBuf.get(), readData.length);
+
+        // Channel 0 pulls the input, so the other channels can only be processed after it
+        d->resamplerOfChannel[0]->processOutput();
+        if (d->threadPool && d->channelCount > 2) {
+            for (int i = 2; i < d->channelCount; i++)
+                d->threadPool->start(d->resamplerOfChannel[i].get());
+            d->resamplerOfChannel[1]->processOutput();
+            // Channels that no worker has picked up yet are processed on this thread, so that the call never waits
+            // for a busy pool
+            for (int i = 2; i < d->channelCount; i++) {
+                if (d->threadPool->tryTake(d->resamplerOfChannel[i].get()))
+                    d->resamplerOfChannel[i]->run();
             }
+            d->doneSemaphore.acquire(d->channelCount - 2);
         } else {
-            auto p = d->tmpBuf.get();
-            AudioDataWrapper pSrc(&p, 1, bufferSize());
-            for (int i = 0; i < d->channelCount; i++) {
-                d->resamplerOfChannel[i]->process(d->tmpBuf.get(), readData.length);
-                if (i < readData.buffer->channelCount())
-                    readData.buffer->setSampleRange(i, readData.startPos, readData.length, pSrc, 0, 0);
+            for (int i = 1; i < d->channelCount; i++)
+                d->resamplerOfChannel[i]->processOutput();
+        }
+
+        if (!isContinuous) {
+            for (int i = 0; i < qMin(d->channelCount, readData.buffer->channelCount()); i++) {
+                auto p = d->resamplerOfChannel[i]->tmpBuf.get();
+                AudioDataWrapper pSrc(&p, 1, readData.length);
+                readData.buffer->setSampleRange(i, readData.startPos, readData.length, pSrc, 0, 0);
             }
         }
     }
@@ -111,6 +132,29 @@ namespace talcs {
         return d->resamplerOfChannel[0]->ratio();
     }
 
+    /**
+     * @copydoc AudioResampler::setRatio()
+     */
+    void MultichannelAudioResampler::setRatio(double ratio, qint64 rampLength) {
+        for (auto &resampler: d->resamplerOfChannel) {
+            resampler->setRatio(ratio, rampLength);
+        }
+    }
+
+    /**
+     * @copydoc AudioResampler::isVariableRatio()
+     */
+    bool MultichannelAudioResampler::isVariableRatio() const {
+        return d->resamplerOfChannel[0]->isVariableRatio();
+    }
+
+    /**
+     * @copydoc AudioResampler::inputTime()
+     */
+    double MultichannelAudioResampler::inputTime() const {
+        return d->resamplerOfChannel[0]->inputTime();
+    }
+
     /**
      * @copydoc AudioResampler::bufferSize()
      */
@@ -125,6 +169,33 @@ namespace talcs {
         return d->resamplerOfChannel.size();
     }
 
+    /**
+     * @copydoc AudioResampler::quality()
+     */
+    AudioResampler::Quality MultichannelAudioResampler::quality() const {
+        return d->resamplerOfChannel[0]->quality();
+    }
+
+    /**
+     * Sets the thread pool used to process the channels in parallel, or @c nullptr to process them one after another
+     * on the calling thread, which is the default.
+     *
+     * Channel 0 is always processed first on the calling thread, since it pulls the input with read(). The other
+     * channels are then distributed to the pool, and the calling thread processes channel 1 and any channel the pool
+     * has not started yet. This pays off with many channels, e.g. in offline rendering. In real time, the pool should
+     * be dedicated to audio processing, since its workers run with the priority of the pool threads.
+     */
+    void MultichannelAudioResampler::setThreadPool(QThreadPool *threadPool) {
+        d->threadPool = threadPool;
+    }
+
+    /**
+     * Gets the thread pool used to process the channels in parallel.
+     */
+    QThreadPool *MultichannelAudioResampler::threadPool() const {
+        return d->threadPool;
+    }
+
     /**
      * @fn void MultichannelAudioResampler::read(const AudioSourceReadData &readData)
      * @copydoc AudioResampler::read()
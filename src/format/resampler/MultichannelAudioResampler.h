@@ -22,7 +22,10 @@
 
 #include <QScopedPointer>
 
+class QThreadPool;
+
 #include <TalcsCore/AudioSource.h>
+#include <TalcsFormat/AudioResampler.h>
 #include <TalcsFormat/TalcsFormatGlobal.h>
 
 namespace talcs {
@@ -36,7 +39,7 @@ namespace talcs {
 
     class TALCSFORMAT_EXPORT MultichannelAudioResampler {
     public:
-        explicit MultichannelAudioResampler(double ratio, qint64 bufferSize, int channelCount);
+        explicit MultichannelAudioResampler(double ratio, qint64 bufferSize, int channelCount, AudioResampler::Quality quality = AudioResampler::HighQuality, bool isVariableRatio = false);
         virtual ~MultichannelAudioResampler();
 
         void reset();
@@ -44,8 +47,16 @@ namespace talcs {
         void process(const AudioSourceReadData &readData);
 
         double ratio() const;
+        void setRatio(double ratio, qint64 rampLength = 0);
+        bool isVariableRatio() const;
+        double inputTime() const;
+
         qint64 bufferSize() const;
         int channelCount() const;
+        AudioResampler::Quality quality() const;
+
+        void setThreadPool(QThreadPool *threadPool);
+        QThreadPool *threadPool() const;
 
     protected:
         virtual void read(const AudioSourceReadData &readData) = 0;
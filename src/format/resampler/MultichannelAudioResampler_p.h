@@ -26,6 +26,8 @@
 #include "MultichannelAudioResampler.h"
 #include "AudioResampler.h"
 
+#include <QRunnable>
+#include <QSemaphore>
 #include <QVector>
 
 #include <TalcsCore/AudioBuffer.h>
@@ -38,22 +40,34 @@ namespace talcs {
     public:
         int channelCount;
         std::vector<std::unique_ptr<ChannelResampler>> resamplerOfChannel;
-        AudioBuffer inputBuffer;
-        std::unique_ptr<float[]> tmpBuf;
 
-        struct InputBlockRecord {
-            QVector<QVector<float>> channels;
-        };
-        std::vector<InputBlockRecord> inputBlockRecords;
+        QThreadPool *threadPool = nullptr;
+        QSemaphore doneSemaphore;
+
+        // The planar input read during a process() call. Channel 0 appends each input block to it, and the other
+        // channels copy the same blocks from it by their own read cursors.
+        AudioBuffer inputBuffer;
+        qint64 inputLength = 0;
     };
 
-    class ChannelResampler : public AudioResampler {
+    class ChannelResampler : public AudioResampler, public QRunnable {
     public:
-        ChannelResampler(double ratio, qint64 bufferSize, MultichannelAudioResampler *mcr, int ch) : AudioResampler(ratio, bufferSize), mcr(mcr), ch(ch) {}
+        ChannelResampler(double ratio, qint64 bufferSize, AudioResampler::Quality quality, bool isVariableRatio, MultichannelAudioResampler *mcr, int ch) : AudioResampler(ratio, bufferSize, quality, isVariableRatio), mcr(mcr), ch(ch), tmpBuf(new float[bufferSize]) {
+            setAutoDelete(false);
+        }
         void read(float *inputBlock, qint64 length) override;
+        void run() override;
+        void processOutput() {
+            process(output, outputLength);
+        }
         MultichannelAudioResampler *mcr;
         int ch;
-        int readIndexWithinCall = 0;
+        qint64 readCursor = 0;
+
+        // The output of the current process() call, which is tmpBuf if it cannot be written to the buffer directly
+        float *output = nullptr;
+        qint64 outputLength = 0;
+        std::unique_ptr<float[]> tmpBuf;
     };
 }
 
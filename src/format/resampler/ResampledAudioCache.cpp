@@ -0,0 +1,444 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#include "ResampledAudioCache.h"
+#include "ResampledAudioCache_p.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <TalcsCore/AudioBuffer.h>
+#include <TalcsCore/InterleavedAudioDataWrapper.h>
+#include <TalcsFormat/AudioFormatIO.h>
+#include <TalcsFormat/MemoryMappedAudioFormatIO.h>
+#include <TalcsFormat/MultichannelAudioResampler.h>
+#include <TalcsFormat/ReadAheadAudioFormatIO.h>
+
+namespace talcs {
+
+    static const char RENDITION_SUFFIX[] = ".w64";
+
+    static const AudioResampler::Quality RENDITION_QUALITY = AudioResampler::HighQuality;
+
+    // Identifies the quality tier and the engines it uses, i.e. r8brain, and the half-band stages for power-of-two
+    // ratios. Change it when the resampler produces different output.
+    static const char RENDITION_QUALITY_TAG[] = "hq-r8b-hb1";
+
+    static const qint64 RENDITION_BLOCK_SIZE = 4096;
+
+    static const qint64 FINGERPRINT_CHUNK_SIZE = 1024 * 1024;
+
+    static const qint64 DEFAULT_SIZE_LIMIT = 8ll * 1024 * 1024 * 1024;
+
+    /**
+     * @class ResampledAudioCache
+     * @brief The on-disk cache of resampled renditions of audio files
+     *
+     * When the cache directory is set, AudioFormatInputSource objects that read an audio file at a sample rate
+     * different from the file look up a rendition resampled to that rate. If it is not found, the audio is resampled
+     * in real time as usual, and the rendition is written in the background, so that later playbacks, exports and
+     * waveform passes map the rendition into memory instead of resampling again.
+     *
+     * Renditions are 32-bit float Sony Wave64 files named after the path of the source file, a hash of its size,
+     * modification time and content, the target sample rate, and the quality tier and engines of the resampler. A
+     * rendition therefore becomes unreachable once the source file or the resampler changes, and is removed when a new
+     * rendition of the file is written. When the renditions in the directory exceed the size limit, the least recently
+     * used ones are removed.
+     *
+     * Files in compressed formats also get a rendition at their own sample rate, which is simply the decoded audio.
+     * Seeking in such a file restarts the decoder, which has to find the page or frame of the position and decode up to
+     * it, whereas the rendition is mapped into memory and seeks in constant time.
+     * @see isSeekCostly()
+     *
+     * By default, the directory is empty and the cache is disabled.
+     */
+
+    class RenditionResampler : public MultichannelAudioResampler {
+    public:
+        RenditionResampler(double ratio, AbstractAudioFormatIO *io)
+                : MultichannelAudioResampler(ratio, RENDITION_BLOCK_SIZE, io->channelCount(), RENDITION_QUALITY), io(io) {
+        }
+
+    protected:
+        void read(const AudioSourceReadData &readData) override {
+            tmpBuf.resize(readData.length * channelCount());
+            auto inLength = qMax(qint64(0), io->read(tmpBuf.data(), readData.length));
+            InterleavedAudioDataWrapper wrapper(tmpBuf.data(), channelCount(), inLength);
+            for (int i = 0; i < channelCount(); i++) {
+                readData.buffer->setSampleRange(i, readData.startPos, inLength, wrapper, i, 0);
+                readData.buffer->clear(i, readData.startPos + inLength, readData.length - inLength);
+            }
+        }
+
+    private:
+        AbstractAudioFormatIO *io;
+        QVector<float> tmpBuf;
+    };
+
+    /**
+     * Constructor.
+     *
+     * Usually the global instance is used instead of constructing an object.
+     * @see globalInstance()
+     */
+    ResampledAudioCache::ResampledAudioCache() : d_ptr(new ResampledAudioCachePrivate) {
+        Q_D(ResampledAudioCache);
+        d->q_ptr = this;
+        d->sizeLimit = DEFAULT_SIZE_LIMIT;
+        d->threadPool.setMaxThreadCount(1);
+    }
+
+    /**
+     * Destructor.
+     *
+     * Renditions that have not started to be written are discarded, and the ongoing one is waited for.
+     */
+    ResampledAudioCache::~ResampledAudioCache() {
+        Q_D(ResampledAudioCache);
+        d->threadPool.clear();
+        d->threadPool.waitForDone();
+    }
+
+    /**
+     * Gets the process-wide cache, which AudioFormatInputSource objects use.
+     */
+    ResampledAudioCache *ResampledAudioCache::globalInstance() {
+        static ResampledAudioCache instance;
+        return &instance;
+    }
+
+    /**
+     * Sets the directory where renditions are stored. An empty path disables the cache.
+     *
+     * Note that renditions are uncompressed 32-bit float, so they take about ten times as much disk space as
+     * compressed source files. For example, the rendition of one hour of 48 kHz stereo FLAC takes about 1.4 GB. The
+     * total size is bounded by sizeLimit().
+     */
+    void ResampledAudioCache::setDirectory(const QString &path) {
+        Q_D(ResampledAudioCache);
+        QMutexLocker locker(&d->mutex);
+        if (!path.isEmpty())
+            QDir().mkpath(path);
+        d->directory = path;
+        d->failedRenditionSet.clear();
+        d->evictRenditions();
+    }
+
+    /**
+     * Gets the directory where renditions are stored.
+     */
+    QString ResampledAudioCache::directory() const {
+        Q_D(const ResampledAudioCache);
+        QMutexLocker locker(&d->mutex);
+        return d->directory;
+    }
+
+    /**
+     * Sets the maximum total size in bytes of the renditions in the directory. When it is exceeded, the least
+     * recently used renditions are removed. A rendition larger than the limit is not written at all. Zero means no
+     * limit.
+     *
+     * The default limit is 8 GiB.
+     */
+    void ResampledAudioCache::setSizeLimit(qint64 bytes) {
+        Q_D(ResampledAudioCache);
+        QMutexLocker locker(&d->mutex);
+        d->sizeLimit = qMax(0ll, bytes);
+        d->failedRenditionSet.clear();
+        d->evictRenditions();
+    }
+
+    /**
+     * Gets the maximum total size in bytes of the renditions in the directory.
+     */
+    qint64 ResampledAudioCache::sizeLimit() const {
+        Q_D(const ResampledAudioCache);
+        QMutexLocker locker(&d->mutex);
+        return d->sizeLimit;
+    }
+
+    /**
+     * Gets the path of the rendition of a source file at the specified sample rate.
+     *
+     * @return the path, or an empty string if the cache is disabled or the rendition has not been written yet
+     */
+    QString ResampledAudioCache::renditionPath(const QString &sourceFileName, double sampleRate) const {
+        Q_D(const ResampledAudioCache);
+        QMutexLocker locker(&d->mutex);
+        auto renditionFileName = d->renditionFileNameOf(sourceFileName, sampleRate);
+        if (renditionFileName.isEmpty() || !QFileInfo(renditionFileName).isFile())
+            return {};
+        // The modification time of a rendition is its last use, by which renditions are evicted
+        QFile renditionFile(renditionFileName);
+        if (renditionFile.open(QIODevice::ReadWrite))
+            renditionFile.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+        return renditionFileName;
+    }
+
+    /**
+     * Requests the rendition of a source file at the specified sample rate to be written in the background.
+     *
+     * The request is ignored if the rendition already exists, is being written, or failed to be written before.
+     */
+    void ResampledAudioCache::requestRendition(const QString &sourceFileName, double sampleRate) {
+        Q_D(ResampledAudioCache);
+        QMutexLocker locker(&d->mutex);
+        auto renditionFileName = d->renditionFileNameOf(sourceFileName, sampleRate);
+        if (renditionFileName.isEmpty() || QFileInfo(renditionFileName).isFile())
+            return;
+        if (d->pendingRenditionSet.contains(renditionFileName) || d->failedRenditionSet.contains(renditionFileName))
+            return;
+        d->pendingRenditionSet.insert(renditionFileName);
+        d->threadPool.start([=] {
+            bool ok = d->render(sourceFileName, sampleRate, renditionFileName);
+            if (ok)
+                d->removeStaleRenditions(sourceFileName);
+            QMutexLocker locker(&d->mutex);
+            if (ok)
+                d->evictRenditions(renditionFileName);
+            d->pendingRenditionSet.remove(renditionFileName);
+            if (!ok)
+                d->failedRenditionSet.insert(renditionFileName);
+        });
+    }
+
+    /**
+     * Waits for all requested renditions to be written.
+     *
+     * @return @c true if all renditions are written before the timeout
+     */
+    bool ResampledAudioCache::waitForDone(int msecs) {
+        Q_D(ResampledAudioCache);
+        return d->threadPool.waitForDone(msecs);
+    }
+
+    /**
+     * Removes all renditions of a source file.
+     */
+    void ResampledAudioCache::removeRenditions(const QString &sourceFileName) {
+        Q_D(ResampledAudioCache);
+        QMutexLocker locker(&d->mutex);
+        if (d->directory.isEmpty())
+            return;
+        QDir dir(d->directory);
+        auto prefix = ResampledAudioCachePrivate::prefixOf(sourceFileName);
+        for (const auto &fileName : dir.entryList({prefix + "-*"}, QDir::Files))
+            dir.remove(fileName);
+    }
+
+    /**
+     * Removes all renditions in the directory.
+     */
+    void ResampledAudioCache::clear() {
+        Q_D(ResampledAudioCache);
+        QMutexLocker locker(&d->mutex);
+        if (d->directory.isEmpty())
+            return;
+        QDir dir(d->directory);
+        for (const auto &fileName : dir.entryList({QString("*") + RENDITION_SUFFIX}, QDir::Files))
+            dir.remove(fileName);
+        d->failedRenditionSet.clear();
+    }
+
+    /**
+     * Gets the name of the file that an AudioFormatIO or MemoryMappedAudioFormatIO object reads from, including the
+     * one wrapped by a ReadAheadAudioFormatIO object.
+     *
+     * @return the file name, or an empty string if the object does not read from a file
+     */
+    QString ResampledAudioCache::sourceFileName(AbstractAudioFormatIO *io) {
+        if (auto readAheadIo = dynamic_cast<ReadAheadAudioFormatIO *>(io))
+            return sourceFileName(readAheadIo->audioFormatIo());
+        QFileDevice *fileDevice = nullptr;
+        if (auto audioFormatIo = dynamic_cast<AudioFormatIO *>(io))
+            fileDevice = qobject_cast<QFileDevice *>(audioFormatIo->stream());
+        else if (auto mappedIo = dynamic_cast<MemoryMappedAudioFormatIO *>(io))
+            fileDevice = mappedIo->stream();
+        if (!fileDevice || fileDevice->fileName().isEmpty())
+            return {};
+        return QFileInfo(fileDevice->fileName()).canonicalFilePath();
+    }
+
+    /**
+     * Checks whether seeking in an AudioFormatIO object, including the one wrapped by a ReadAheadAudioFormatIO object,
+     * needs to restart a decoder, i.e. the file is in FLAC, Ogg Vorbis, Opus, MPEG or ALAC format.
+     */
+    bool ResampledAudioCache::isSeekCostly(AbstractAudioFormatIO *io) {
+        if (auto readAheadIo = dynamic_cast<ReadAheadAudioFormatIO *>(io))
+            return isSeekCostly(readAheadIo->audioFormatIo());
+        auto audioFormatIo = dynamic_cast<AudioFormatIO *>(io);
+        if (!audioFormatIo)
+            return false;
+        if ((audioFormatIo->format() & AudioFormatIO::MajorFormatMask) == AudioFormatIO::FLAC)
+            return true;
+        switch (audioFormatIo->format() & AudioFormatIO::SubtypeMask) {
+            case AudioFormatIO::VORBIS:
+            case AudioFormatIO::OPUS:
+            case AudioFormatIO::ALAC_16:
+            case AudioFormatIO::ALAC_20:
+            case AudioFormatIO::ALAC_24:
+            case AudioFormatIO::ALAC_32:
+            case AudioFormatIO::MPEG_LAYER_I:
+            case AudioFormatIO::MPEG_LAYER_II:
+            case AudioFormatIO::MPEG_LAYER_III:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    QString ResampledAudioCachePrivate::fingerprintOf(const QString &sourceFileName) const {
+        QFileInfo info(sourceFileName);
+        if (!info.isFile())
+            return {};
+        auto it = fingerprintDict.constFind(sourceFileName);
+        if (it != fingerprintDict.cend() && it->size == info.size() && it->lastModified == info.lastModified())
+            return it->hash;
+        QFile f(sourceFileName);
+        if (!f.open(QIODevice::ReadOnly))
+            return {};
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        hash.addData(QByteArray::number(info.size()));
+        hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+        hash.addData(f.read(FINGERPRINT_CHUNK_SIZE));
+        if (info.size() > FINGERPRINT_CHUNK_SIZE) {
+            f.seek(qMax(FINGERPRINT_CHUNK_SIZE, info.size() - FINGERPRINT_CHUNK_SIZE));
+            hash.addData(f.read(FINGERPRINT_CHUNK_SIZE));
+        }
+        auto hex = QString::fromLatin1(hash.result().toHex());
+        fingerprintDict.insert(sourceFileName, {info.size(), info.lastModified(), hex});
+        return hex;
+    }
+
+    QString ResampledAudioCachePrivate::prefixOf(const QString &sourceFileName) {
+        return QString::fromLatin1(
+            QCryptographicHash::hash(sourceFileName.toUtf8(), QCryptographicHash::Sha1).toHex().left(16));
+    }
+
+    QString ResampledAudioCachePrivate::renditionFileNameOf(const QString &sourceFileName, double sampleRate) const {
+        if (directory.isEmpty() || sourceFileName.isEmpty() || sampleRate <= 0)
+            return {};
+        auto fingerprint = fingerprintOf(sourceFileName);
+        if (fingerprint.isEmpty())
+            return {};
+        return QDir(directory).filePath(QString("%1-%2-%3-%4%5")
+                                            .arg(prefixOf(sourceFileName), fingerprint)
+                                            .arg(sampleRate, 0, 'g', 10)
+                                            .arg(RENDITION_QUALITY_TAG, RENDITION_SUFFIX));
+    }
+
+    bool ResampledAudioCachePrivate::render(const QString &sourceFileName, double sampleRate,
+                                            const QString &renditionFileName) {
+        QFile srcFile(sourceFileName);
+        if (!srcFile.open(QIODevice::ReadOnly))
+            return false;
+        AudioFormatIO srcIo(&srcFile);
+        if (!srcIo.open(AbstractAudioFormatIO::Read) || srcIo.channelCount() <= 0 || srcIo.sampleRate() <= 0)
+            return false;
+        auto ratio = sampleRate / srcIo.sampleRate();
+        auto outLength = qRound64(static_cast<double>(srcIo.length()) * ratio);
+        {
+            QMutexLocker locker(&mutex);
+            if (sizeLimit && outLength * srcIo.channelCount() * qint64(sizeof(float)) > sizeLimit)
+                return false;
+        }
+
+        // Written to a temporary file first, so that a partial rendition is never mapped
+        auto partFileName = renditionFileName + ".part";
+        QFile outFile(partFileName);
+        if (!outFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            return false;
+        AudioFormatIO outIo(&outFile);
+        outIo.setFormat(AudioFormatIO::W64 | AudioFormatIO::FLOAT);
+        outIo.setChannelCount(srcIo.channelCount());
+        outIo.setSampleRate(sampleRate);
+        if (!outIo.open(AbstractAudioFormatIO::Write)) {
+            outFile.remove();
+            return false;
+        }
+
+        RenditionResampler resampler(ratio, &srcIo);
+        resampler.setThreadPool(QThreadPool::globalInstance());
+        AudioBuffer buf(srcIo.channelCount(), RENDITION_BLOCK_SIZE);
+        QVector<float> interleavedBuf(srcIo.channelCount() * RENDITION_BLOCK_SIZE);
+        bool ok = true;
+        for (qint64 pos = 0; pos < outLength; pos += RENDITION_BLOCK_SIZE) {
+            auto length = qMin(RENDITION_BLOCK_SIZE, outLength - pos);
+            resampler.process({&buf, 0, length});
+            InterleavedAudioDataWrapper wrapper(interleavedBuf.data(), srcIo.channelCount(), length);
+            for (int ch = 0; ch < srcIo.channelCount(); ch++)
+                wrapper.setSampleRange(ch, 0, length, buf, ch, 0);
+            if (outIo.write(interleavedBuf.constData(), length) != length) {
+                ok = false;
+                break;
+            }
+        }
+        outIo.close();
+        outFile.close();
+        if (!ok) {
+            QFile::remove(partFileName);
+            return false;
+        }
+        QFile::remove(renditionFileName);
+        if (!QFile::rename(partFileName, renditionFileName)) {
+            QFile::remove(partFileName);
+            return false;
+        }
+        return true;
+    }
+
+    void ResampledAudioCachePrivate::removeStaleRenditions(const QString &sourceFileName) {
+        QMutexLocker locker(&mutex);
+        if (directory.isEmpty())
+            return;
+        auto fingerprint = fingerprintOf(sourceFileName);
+        QDir dir(directory);
+        auto prefix = prefixOf(sourceFileName);
+        for (const auto &fileName : dir.entryList({prefix + "-*" + RENDITION_SUFFIX}, QDir::Files)) {
+            // Renditions written by a different resampler are stale as well
+            if (fileName.startsWith(prefix + "-" + fingerprint + "-") && fileName.endsWith(QString("-") + RENDITION_QUALITY_TAG + RENDITION_SUFFIX))
+                continue;
+            dir.remove(fileName);
+        }
+    }
+
+    // Removes the least recently used renditions until the total size is within the limit. The mutex must be locked.
+    void ResampledAudioCachePrivate::evictRenditions(const QString &keptFileName) {
+        if (directory.isEmpty() || !sizeLimit)
+            return;
+        QDir dir(directory);
+        auto renditionInfoList = dir.entryInfoList({QString("*") + RENDITION_SUFFIX}, QDir::Files, QDir::Time | QDir::Reversed);
+        qint64 totalSize = 0;
+        for (const auto &info : renditionInfoList)
+            totalSize += info.size();
+        for (const auto &info : renditionInfoList) {
+            if (totalSize <= sizeLimit)
+                break;
+            if (!keptFileName.isEmpty() && info.absoluteFilePath() == QFileInfo(keptFileName).absoluteFilePath())
+                continue;
+            // Fails on some platforms if the rendition is mapped, in which case it is evicted later
+            if (dir.remove(info.fileName()))
+                totalSize -= info.size();
+        }
+    }
+
+}
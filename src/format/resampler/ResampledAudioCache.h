@@ -0,0 +1,64 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#ifndef TALCS_RESAMPLEDAUDIOCACHE_H
+#define TALCS_RESAMPLEDAUDIOCACHE_H
+
+#include <QScopedPointer>
+#include <QString>
+
+#include <TalcsFormat/TalcsFormatGlobal.h>
+
+namespace talcs {
+
+    class AbstractAudioFormatIO;
+
+    class ResampledAudioCachePrivate;
+
+    class TALCSFORMAT_EXPORT ResampledAudioCache {
+        Q_DECLARE_PRIVATE(ResampledAudioCache)
+    public:
+        ResampledAudioCache();
+        ~ResampledAudioCache();
+
+        static ResampledAudioCache *globalInstance();
+
+        void setDirectory(const QString &path);
+        QString directory() const;
+
+        void setSizeLimit(qint64 bytes);
+        qint64 sizeLimit() const;
+
+        QString renditionPath(const QString &sourceFileName, double sampleRate) const;
+        void requestRendition(const QString &sourceFileName, double sampleRate);
+        bool waitForDone(int msecs = -1);
+
+        void removeRenditions(const QString &sourceFileName);
+        void clear();
+
+        static QString sourceFileName(AbstractAudioFormatIO *io);
+        static bool isSeekCostly(AbstractAudioFormatIO *io);
+
+    private:
+        QScopedPointer<ResampledAudioCachePrivate> d_ptr;
+    };
+
+}
+
+#endif // TALCS_RESAMPLEDAUDIOCACHE_H
@@ -0,0 +1,65 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#ifndef TALCS_RESAMPLEDAUDIOCACHE_P_H
+#define TALCS_RESAMPLEDAUDIOCACHE_P_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QThreadPool>
+
+#include <TalcsFormat/ResampledAudioCache.h>
+
+namespace talcs {
+
+    class ResampledAudioCachePrivate {
+        Q_DECLARE_PUBLIC(ResampledAudioCache)
+    public:
+        ResampledAudioCache *q_ptr;
+
+        mutable QMutex mutex;
+        QString directory;
+        qint64 sizeLimit;
+
+        struct Fingerprint {
+            qint64 size;
+            QDateTime lastModified;
+            QString hash;
+        };
+        // Hashing the content of a file is not free, so the fingerprints are reused until the file is modified
+        mutable QHash<QString, Fingerprint> fingerprintDict;
+        QSet<QString> pendingRenditionSet;
+        QSet<QString> failedRenditionSet;
+
+        // Renditions are written one at a time, so that rendering does not compete with playback for the CPU
+        QThreadPool threadPool;
+
+        QString fingerprintOf(const QString &sourceFileName) const;
+        static QString prefixOf(const QString &sourceFileName);
+        QString renditionFileNameOf(const QString &sourceFileName, double sampleRate) const;
+        bool render(const QString &sourceFileName, double sampleRate, const QString &renditionFileName);
+        void removeStaleRenditions(const QString &sourceFileName);
+        void evictRenditions(const QString &keptFileName = {});
+    };
+
+}
+
+#endif // TALCS_RESAMPLEDAUDIOCACHE_P_H
@@ -23,9 +23,15 @@
 #include <cmath>
 
 #include <QDebug>
+#include <QFile>
+#include <QVarLengthArray>
 
+#include <TalcsCore/AudioBlockCache.h>
+#include <TalcsCore/AudioSampleConverter.h>
 #include <TalcsCore/InterleavedAudioDataWrapper.h>
 #include <TalcsFormat/AudioFormatIO.h>
+#include <TalcsFormat/MemoryMappedAudioFormatIO.h>
+#include <TalcsFormat/ResampledAudioCache.h>
 
 namespace talcs {
 
@@ -43,7 +49,13 @@ namespace talcs {
      *
      * This is one of the @ref doc/object_binding.md "object-binding" classes.
      *
-     * r8brain is used to resample the audio.
+     * r8brain is used to resample the audio. If the directory of ResampledAudioCache::globalInstance() is set and the
+     * AudioFormatIO object reads from a file, the source reads from the resampled rendition of the file instead when
+     * it is available, and requests the rendition to be written otherwise. This is also done at the sample rate of the
+     * file if it is compressed, so that seeking in it does not need to restart the decoder.
+     *
+     * The audio can be played at a different speed with setPlaybackRate(), like a tape. The positions and the length of
+     * the source are still those at the normal speed.
      * @see @link URL https://github.com/avaneev/r8brain-free-src @endlink
      */
 
@@ -62,35 +74,183 @@ namespace talcs {
 
     AudioFormatInputSourcePrivate::AudioFormatInputResampler::AudioFormatInputResampler(double ratio, qint64 bufferSize,
                                                                                         int channelCount,
+                                                                                        AudioResampler::Quality quality,
+                                                                                        bool isVariableRatio,
                                                                                         AudioFormatInputSourcePrivate *d)
-            : MultichannelAudioResampler(ratio, bufferSize, channelCount), d(d) {
+            : MultichannelAudioResampler(ratio, bufferSize, channelCount, quality, isVariableRatio), d(d) {
+    }
+
+    void AudioFormatInputSourcePrivate::createResampler(qint64 bufferSize) {
+        resamplerGeneration++;
+        resampler.reset(new AudioFormatInputResampler(isVarispeed ? ratio / playbackRate : ratio, bufferSize, inputIo->channelCount(), resamplerQuality, isVarispeed, this));
+        resampler->setThreadPool(resamplerThreadPool);
+    }
+
+    // The mutex must be locked. It is unlocked while the resampler is built, since designing the filters may take long,
+    // and the reader keeps using the old resampler meanwhile. Returns false if the resampler has been superseded before
+    // the mutex is locked again, in which case it is dropped. The varispeed mode is switched along with the resampler.
+    bool AudioFormatInputSourcePrivate::rebuildResampler(qint64 bufferSize, bool isVariableRatio) {
+        auto generation = ++resamplerGeneration;
+        auto resamplerRatio = isVariableRatio ? ratio / playbackRate : ratio;
+        auto channelCount = inputIo->channelCount();
+        auto quality = resamplerQuality;
+        mutex.unlock();
+        QScopedPointer<AudioFormatInputResampler> newResampler(new AudioFormatInputResampler(resamplerRatio, bufferSize, channelCount, quality, isVariableRatio, this));
+        mutex.lock();
+        if (generation != resamplerGeneration)
+            return false;
+        resampler.swap(newResampler);
+        resampler->setThreadPool(resamplerThreadPool);
+        isVarispeed = isVariableRatio;
+        // The playback rate might have been changed meanwhile
+        if (isVarispeed && ratio / playbackRate != resamplerRatio)
+            resampler->setRatio(ratio / playbackRate);
+        inPosition = outPositionToIn(position, ratio);
+        resamplerStartPosition = position;
+        return true;
+    }
+
+    void AudioFormatInputSourcePrivate::updateBlockCacheIdentity() {
+        if (cacheKey.isEmpty() || qFuzzyCompare(ratio, 1.0))
+            blockCacheIdentity = cacheKey;
+        else
+            blockCacheIdentity = cacheKey + QStringLiteral("?quality=") + QString::number(resamplerQuality);
+    }
+
+    void AudioFormatInputSourcePrivate::seekIo(qint64 pos) {
+        inputIo->seek(pos);
+        ioPosition = pos;
+    }
+
+    void AudioFormatInputSourcePrivate::updateMappedFloatData() {
+        auto mappedIo = dynamic_cast<MemoryMappedAudioFormatIO *>(inputIo);
+        mappedFloatData = mappedIo ? mappedIo->floatData() : nullptr;
+    }
+
+    bool AudioFormatInputSourcePrivate::openRendition(double sampleRate) {
+        auto cache = ResampledAudioCache::globalInstance();
+        auto sourceFileName = ResampledAudioCache::sourceFileName(io);
+        if (sourceFileName.isEmpty())
+            return false;
+        auto renditionFileName = cache->renditionPath(sourceFileName, sampleRate);
+        if (renditionFileName.isEmpty()) {
+            cache->requestRendition(sourceFileName, sampleRate);
+            return false;
+        }
+        renditionFile.reset(new QFile(renditionFileName));
+        renditionIo.reset(new MemoryMappedAudioFormatIO(renditionFile.get()));
+        if (!renditionFile->open(QIODevice::ReadOnly) || !renditionIo->open(AbstractAudioFormatIO::Read) ||
+            renditionIo->channelCount() != io->channelCount() || !qFuzzyCompare(renditionIo->sampleRate(), sampleRate)) {
+            closeRendition();
+            return false;
+        }
+        return true;
+    }
+
+    void AudioFormatInputSourcePrivate::closeRendition() {
+        if (renditionIo)
+            renditionIo->close();
+        renditionIo.reset();
+        renditionFile.reset();
     }
 
     void AudioFormatInputSourcePrivate::AudioFormatInputResampler::read(const AudioSourceReadData &readData) {
-        d->io->seek(d->inPosition);
-        tmpBuf.resize(readData.length * channelCount());
-        auto inLength = d->io->read(tmpBuf.data(), readData.length);
-        InterleavedAudioDataWrapper wrapper(tmpBuf.data(), channelCount(), readData.length);
-        for (int i = 0; i < channelCount(); i++) {
-            readData.buffer->setSampleRange(i, readData.startPos, inLength, wrapper, i, 0);
-            readData.buffer->clear(i, readData.startPos + inLength, readData.length - inLength);
+        qint64 inLength;
+        const float *interleavedData;
+        if (d->mappedFloatData) {
+            inLength = qBound(0ll, d->inputIo->length() - d->inPosition, readData.length);
+            interleavedData = d->mappedFloatData + d->inPosition * channelCount();
+        } else {
+            if (d->ioPosition != d->inPosition)
+                d->seekIo(d->inPosition);
+            tmpBuf.resize(readData.length * channelCount());
+            inLength = qMax(0ll, d->inputIo->read(tmpBuf.data(), readData.length));
+            d->ioPosition += inLength;
+            interleavedData = tmpBuf.constData();
         }
+        if (readData.buffer->isContinuous()) {
+            QVarLengthArray<float *, 8> channelPointers(channelCount());
+            for (int i = 0; i < channelCount(); i++)
+                channelPointers[i] = readData.buffer->writePointerTo(i, readData.startPos);
+            AudioSampleConverter::deinterleave(channelPointers.data(), interleavedData, channelCount(), inLength);
+        } else {
+            InterleavedAudioDataWrapper wrapper(const_cast<float *>(interleavedData), channelCount(), inLength);
+            for (int i = 0; i < channelCount(); i++)
+                readData.buffer->setSampleRange(i, readData.startPos, inLength, wrapper, i, 0);
+        }
+        for (int i = 0; i < channelCount(); i++)
+            readData.buffer->clear(i, readData.startPos + inLength, readData.length - inLength);
         d->inPosition += inLength;
     }
 
+    void AudioFormatInputSourcePrivate::resetBlockCache() {
+        decodePosition = -1;
+        currentBlockIndex = -1;
+        currentBlock = {};
+    }
+
+    void AudioFormatInputSourcePrivate::decodeBlock(qint64 blockIndex, qint64 blockSize) {
+        Q_Q(AudioFormatInputSource);
+        auto blockStart = blockIndex * blockSize;
+        auto blockLength = qMin(blockSize, q->length() - blockStart);
+        if (decodePosition != blockStart) {
+            resampler->reset();
+            inPosition = outPositionToIn(blockStart, ratio);
+        }
+        currentBlock = AudioBuffer(inputIo->channelCount(), blockLength);
+        for (qint64 pos = 0; pos < blockLength; pos += resampler->bufferSize())
+            resampler->process({&currentBlock, pos, qMin(resampler->bufferSize(), blockLength - pos)});
+        decodePosition = blockStart + blockLength;
+        currentBlockIndex = blockIndex;
+    }
+
+    qint64 AudioFormatInputSourcePrivate::readFromBlockCache(const AudioSourceReadData &readData, qint64 readLength) {
+        Q_Q(AudioFormatInputSource);
+        auto cache = AudioBlockCache::globalInstance();
+        auto blockSize = cache->blockSize();
+        auto channelCount = qMin(inputIo->channelCount(), readData.buffer->channelCount());
+        for (qint64 offset = 0; offset < readLength;) {
+            auto blockIndex = (position + offset) / blockSize;
+            if (blockIndex != currentBlockIndex) {
+                if (cache->find(blockCacheIdentity, q->sampleRate(), blockIndex, currentBlock)) {
+                    currentBlockIndex = blockIndex;
+                } else {
+                    decodeBlock(blockIndex, blockSize);
+                    cache->insert(blockCacheIdentity, q->sampleRate(), blockIndex, currentBlock);
+                }
+            }
+            auto blockOffset = position + offset - blockIndex * blockSize;
+            auto length = qMin(readLength - offset, currentBlock.sampleCount() - blockOffset);
+            if (length <= 0)
+                break;
+            for (int ch = 0; ch < channelCount; ch++)
+                readData.buffer->setSampleRange(ch, readData.startPos + offset, length, currentBlock, ch, blockOffset);
+            offset += length;
+        }
+        return readLength;
+    }
+
     qint64 AudioFormatInputSource::processReading(const AudioSourceReadData &readData) {
         Q_D(AudioFormatInputSource);
         QMutexLocker locker(&d->mutex);
         Q_ASSERT(d->io && isOpen());
         auto readLength = qMax(qint64(0), qMin(readData.length, length() - d->position));
-        d->resampler->process({readData.buffer, readData.startPos, readLength, readData.silentFlags});
-        if (d->doStereoize && d->io->channelCount() == 1 && readData.buffer->channelCount() > 1) {
+        if (d->isVarispeed)
+            readLength = qMax(qint64(0), qMin(readData.length, static_cast<qint64>(std::ceil(static_cast<double>(length() - d->position) / d->playbackRate))));
+        if (!d->cacheKey.isEmpty() && !d->isVarispeed)
+            d->readFromBlockCache(readData, readLength);
+        else
+            d->resampler->process({readData.buffer, readData.startPos, readLength, readData.silentFlags});
+        if (d->doStereoize && d->inputIo->channelCount() == 1 && readData.buffer->channelCount() > 1) {
             readData.buffer->setSampleRange(1, readData.startPos, readLength, *readData.buffer, 0, readData.startPos);
         }
         for (int ch = 0; ch < readData.buffer->channelCount(); ch++) {
             readData.buffer->clear(ch, readData.startPos + readLength, readData.length - readLength);
         }
-        d->position += readLength;
+        if (d->isVarispeed)
+            d->position = d->resamplerStartPosition + qRound64(d->resampler->inputTime() * d->ratio);
+        else
+            d->position += readLength;
         return readLength;
     }
 
@@ -98,7 +258,7 @@ namespace talcs {
         Q_D(const AudioFormatInputSource);
         if (!d->io || !isOpen())
             return 0;
-        return inPositionToOut(d->io->length(), d->ratio);
+        return inPositionToOut(d->inputIo->length(), d->ratio);
     }
 
     void AudioFormatInputSource::setNextReadPosition(qint64 pos) {
@@ -107,10 +267,12 @@ namespace talcs {
         if (pos != d->position) {
             if (d->resampler)
                 d->resampler->reset();
-            if (isOpen()) {
-                d->io->seek(outPositionToIn(pos, d->ratio));
+            d->decodePosition = -1;
+            d->resamplerStartPosition = pos;
+            // The io is seeked lazily on the next read, since the clips of a series are repositioned long before they
+            // are read, and seeking a compressed file is expensive
+            if (isOpen())
                 d->inPosition = outPositionToIn(pos, d->ratio);
-            }
         }
         PositionableAudioSource::setNextReadPosition(pos);
     }
@@ -123,10 +285,20 @@ namespace talcs {
             return false;
         if (d->io->open(AbstractAudioFormatIO::Read)) {
             d->ratio = sampleRate / d->io->sampleRate();
-            d->resampler.reset(new AudioFormatInputSourcePrivate::AudioFormatInputResampler(d->ratio, bufferSize,
-                                                                                        d->io->channelCount(), d));
+            d->closeRendition();
+            d->inputIo = d->io;
+            if ((!qFuzzyCompare(d->ratio, 1.0) || ResampledAudioCache::isSeekCostly(d->io)) && d->openRendition(sampleRate)) {
+                d->inputIo = d->renditionIo.get();
+                d->ratio = 1.0;
+            }
+            d->isVarispeed = !qFuzzyCompare(d->playbackRate, 1.0);
+            d->createResampler(bufferSize);
             d->inPosition = outPositionToIn(d->position, d->ratio);
-            d->io->seek(d->inPosition);
+            d->resamplerStartPosition = d->position;
+            d->ioPosition = -1;
+            d->updateMappedFloatData();
+            d->updateBlockCacheIdentity();
+            d->resetBlockCache();
             return AudioSource::open(bufferSize, sampleRate);
         } else
             return false;
@@ -138,8 +310,15 @@ namespace talcs {
         if (!d->io)
             return;
         d->io->close();
+        d->closeRendition();
+        d->inputIo = d->io;
+        d->ioPosition = -1;
+        d->mappedFloatData = nullptr;
         d->ratio = 0;
+        d->isVarispeed = false;
+        d->resamplerGeneration++;
         d->resampler.reset();
+        d->resetBlockCache();
         AudioSource::close();
     }
 
@@ -157,8 +336,10 @@ namespace talcs {
         Q_D(AudioFormatInputSource);
         QMutexLocker locker(&d->mutex);
         d->io.reset(audioFormatIo, takeOwnership);
-        if (d->io && d->io->openMode())
-            d->io->seek(d->inPosition);
+        d->inputIo = d->io;
+        d->ioPosition = -1;
+        d->mappedFloatData = nullptr;
+        d->contentVersion.fetchAndAddRelaxed(1);
         if (d->resampler)
             d->resampler->reset();
     }
@@ -181,6 +362,11 @@ namespace talcs {
         QMutexLocker locker(&d->mutex);
         if (d->resampler)
             d->resampler->reset();
+        d->decodePosition = -1;
+        if (d->isVarispeed) {
+            d->inPosition = outPositionToIn(d->position, d->ratio);
+            d->resamplerStartPosition = d->position;
+        }
     }
 
     /**
@@ -200,4 +386,124 @@ namespace talcs {
         return d->doStereoize;
     }
 
+    /**
+     * Sets the key that identifies the audio in AudioBlockCache::globalInstance(), e.g. the canonical path of the
+     * file. Sources with the same key share the decoded and resampled blocks, so the audio is decoded only once.
+     *
+     * An empty key, which is the default value, disables the block cache. The key must change if the content of the
+     * audio changes, or the blocks of the key must be removed from the cache.
+     */
+    void AudioFormatInputSource::setCacheKey(const QString &key) {
+        Q_D(AudioFormatInputSource);
+        QMutexLocker locker(&d->mutex);
+        if (key == d->cacheKey)
+            return;
+        d->cacheKey = key;
+        d->updateBlockCacheIdentity();
+        d->resetBlockCache();
+        if (d->resampler)
+            d->resampler->reset();
+        if (isOpen()) {
+            d->inPosition = outPositionToIn(d->position, d->ratio);
+            d->resamplerStartPosition = d->position;
+        }
+    }
+
+    /**
+     * Gets the key that identifies the audio in the block cache.
+     */
+    QString AudioFormatInputSource::cacheKey() const {
+        Q_D(const AudioFormatInputSource);
+        return d->cacheKey;
+    }
+
+    /**
+     * Sets the thread pool used to resample the channels in parallel, or @c nullptr to resample them on the reading
+     * thread, which is the default.
+     *
+     * This is useful for offline rendering of audio with many channels.
+     * @see MultichannelAudioResampler::setThreadPool()
+     */
+    void AudioFormatInputSource::setResamplerThreadPool(QThreadPool *threadPool) {
+        Q_D(AudioFormatInputSource);
+        QMutexLocker locker(&d->mutex);
+        d->resamplerThreadPool = threadPool;
+        if (d->resampler)
+            d->resampler->setThreadPool(threadPool);
+    }
+
+    /**
+     * Gets the thread pool used to resample the channels in parallel.
+     */
+    QThreadPool *AudioFormatInputSource::resamplerThreadPool() const {
+        Q_D(const AudioFormatInputSource);
+        return d->resamplerThreadPool;
+    }
+
+    /**
+     * Sets the quality tier of resampling. The default value is AudioResampler::HighQuality.
+     *
+     * Lower tiers are cheaper and have less latency, so they are suitable for scrubbing and live preview, while
+     * exporting should use AudioResampler::HighQuality. If the source is open, the resampler is rebuilt at the current
+     * position. The new resampler is built without blocking the reading thread, which keeps using the old one meanwhile.
+     */
+    void AudioFormatInputSource::setResamplerQuality(AudioResampler::Quality quality) {
+        Q_D(AudioFormatInputSource);
+        QMutexLocker locker(&d->mutex);
+        if (quality == d->resamplerQuality)
+            return;
+        d->resamplerQuality = quality;
+        if (!isOpen())
+            return;
+        if (!d->rebuildResampler(bufferSize(), d->isVarispeed))
+            return;
+        d->updateBlockCacheIdentity();
+        d->resetBlockCache();
+    }
+
+    /**
+     * Gets the quality tier of resampling.
+     */
+    AudioResampler::Quality AudioFormatInputSource::resamplerQuality() const {
+        Q_D(const AudioFormatInputSource);
+        return d->resamplerQuality;
+    }
+
+    /**
+     * Sets the playback rate, e.g. 2 for double speed, which also changes the pitch like a tape. The default value is 1.
+     *
+     * Changing the rate while the source is open is continuous, so it is suitable for scrubbing. When the rate leaves 1
+     * for the first time after opening, the resampler is rebuilt at the current position in variable-ratio mode, which
+     * then persists until the source is closed. The new resampler is built without blocking the reading thread. The
+     * block cache is not used in this mode. Rates above 8 times the sample rate ratio are clamped by the resampler.
+     * @param rate the playback rate, which must be positive
+     * @param rampLength the number of output samples over which the rate glides to the new value, or 0 to change it at
+     * once
+     * @see AudioResampler::setRatio()
+     */
+    void AudioFormatInputSource::setPlaybackRate(double rate, qint64 rampLength) {
+        Q_D(AudioFormatInputSource);
+        Q_ASSERT(rate > 0.0);
+        QMutexLocker locker(&d->mutex);
+        if (rate <= 0.0 || rate == d->playbackRate)
+            return;
+        d->playbackRate = rate;
+        if (!isOpen())
+            return;
+        if (!d->isVarispeed) {
+            if (d->rebuildResampler(bufferSize(), true))
+                d->resetBlockCache();
+            return;
+        }
+        d->resampler->setRatio(d->ratio / rate, rampLength);
+    }
+
+    /**
+     * Gets the playback rate.
+     */
+    double AudioFormatInputSource::playbackRate() const {
+        Q_D(const AudioFormatInputSource);
+        return d->playbackRate;
+    }
+
 }
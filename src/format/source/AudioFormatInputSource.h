@@ -20,8 +20,13 @@
 #ifndef AUDIOFORMATINPUTSOURCE_H
 #define AUDIOFORMATINPUTSOURCE_H
 
+#include <QString>
+
+class QThreadPool;
+
 #include <TalcsCore/PositionableAudioSource.h>
 #include <TalcsFormat/TalcsFormatGlobal.h>
+#include <TalcsFormat/AudioResampler.h>
 
 namespace talcs {
 
@@ -47,6 +52,18 @@ namespace talcs {
         void setStereoize(bool stereoize);
         bool stereoize() const;
 
+        void setCacheKey(const QString &key);
+        QString cacheKey() const;
+
+        void setResamplerThreadPool(QThreadPool *threadPool);
+        QThreadPool *resamplerThreadPool() const;
+
+        void setResamplerQuality(AudioResampler::Quality quality);
+        AudioResampler::Quality resamplerQuality() const;
+
+        void setPlaybackRate(double rate, qint64 rampLength = 0);
+        double playbackRate() const;
+
     protected:
         explicit AudioFormatInputSource(AudioFormatInputSourcePrivate &d);
         qint64 processReading(const AudioSourceReadData &readData) override;
@@ -20,13 +20,16 @@
 #ifndef TALCS_AUDIOFORMATINPUTSOURCE_P_H
 #define TALCS_AUDIOFORMATINPUTSOURCE_P_H
 
+#include <QFile>
 #include <QMutex>
 #include <QVector>
 
+#include <TalcsCore/AudioBuffer.h>
 #include <TalcsCore/private/PositionableAudioSource_p.h>
 #include <TalcsCore/TakeOwnershipPointer.h>
 
 #include <TalcsFormat/AudioFormatInputSource.h>
+#include <TalcsFormat/MemoryMappedAudioFormatIO.h>
 #include <TalcsFormat/MultichannelAudioResampler.h>
 
 namespace talcs {
@@ -36,22 +39,65 @@ namespace talcs {
         Q_DECLARE_PUBLIC(AudioFormatInputSource);
     public:
         TakeOwnershipPointer<AbstractAudioFormatIO> io;
+
+        // The object that samples are read from, which is either io or the rendition of ResampledAudioCache
+        AbstractAudioFormatIO *inputIo = nullptr;
+        QScopedPointer<QFile> renditionFile;
+        QScopedPointer<MemoryMappedAudioFormatIO> renditionIo;
+        bool openRendition(double sampleRate);
+        void closeRendition();
         double ratio = 0;
 
         class AudioFormatInputResampler : public MultichannelAudioResampler {
         public:
-            AudioFormatInputResampler(double ratio, qint64 bufferSize, int channelCount, AudioFormatInputSourcePrivate *d);
+            AudioFormatInputResampler(double ratio, qint64 bufferSize, int channelCount, AudioResampler::Quality quality, bool isVariableRatio, AudioFormatInputSourcePrivate *d);
             void read(const talcs::AudioSourceReadData &readData) override;
             AudioFormatInputSourcePrivate *d;
             QVector<float> tmpBuf;
         };
 
         QScopedPointer<AudioFormatInputResampler> resampler;
+        QThreadPool *resamplerThreadPool = nullptr;
+        AudioResampler::Quality resamplerQuality = AudioResampler::HighQuality;
+        void createResampler(qint64 bufferSize);
+        bool rebuildResampler(qint64 bufferSize, bool isVariableRatio);
+        // Increased whenever the resampler is replaced, so that a resampler built without the mutex is not installed
+        // over a newer one
+        quint64 resamplerGeneration = 0;
 
         qint64 inPosition = 0;
 
+        // Once the playback rate leaves 1 after opening, the resampler is variable-ratio until the source is closed, so
+        // that later rate changes keep its state. The position is then derived from the input time of the resampler
+        // since its last reset at resamplerStartPosition.
+        double playbackRate = 1.0;
+        bool isVarispeed = false;
+        qint64 resamplerStartPosition = 0;
+
+        // The position of the AudioFormatIO object after the last seek or read, or -1 if unknown. Sequential reads do
+        // not seek, since seeking resets the decoder of compressed formats.
+        qint64 ioPosition = -1;
+        void seekIo(qint64 pos);
+
+        // Samples of MemoryMappedAudioFormatIO are deinterleaved straight from the mapped file
+        const float *mappedFloatData = nullptr;
+        void updateMappedFloatData();
+
         bool doStereoize = true;
 
+        // Blocks are shared through AudioBlockCache::globalInstance() when the cache key is set. In that case the
+        // resampler produces whole blocks, and decodePosition is the position of its next output, or -1 if unknown.
+        QString cacheKey;
+        // The key of the blocks in the cache, which also identifies the quality tier when the audio is resampled
+        QString blockCacheIdentity;
+        void updateBlockCacheIdentity();
+        qint64 decodePosition = -1;
+        qint64 currentBlockIndex = -1;
+        AudioBuffer currentBlock;
+        void resetBlockCache();
+        void decodeBlock(qint64 blockIndex, qint64 blockSize);
+        qint64 readFromBlockCache(const AudioSourceReadData &readData, qint64 readLength);
+
         QMutex mutex;
 
     };
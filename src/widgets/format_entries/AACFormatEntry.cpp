@@ -87,6 +87,13 @@ namespace talcs {
         return extensionHints;
     }
 
+    bool AACFormatEntry::matchesHeader(const QByteArray &header) const {
+        // MP4 container, or AAC in ADTS, whose MPEG layer bits are 00
+        if (header.mid(4, 4) == "ftyp")
+            return true;
+        return header.size() >= 2 && quint8(header[0]) == 0xff && (quint8(header[1]) & 0xf6) == 0xf0;
+    }
+
     AbstractAudioFormatIO *AACFormatEntry::getFormatOpen(const QString &filename, QVariant &, QWidget *) {
 #if defined(Q_OS_WIN) || defined(Q_OS_MACOS)
         return openAACFile(filename);
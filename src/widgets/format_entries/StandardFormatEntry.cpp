@@ -77,6 +77,19 @@ namespace talcs {
         Q_D(const StandardFormatEntry);
         return d->extensionHints;
     }
+    bool StandardFormatEntry::matchesHeader(const QByteArray &header) const {
+        static const QByteArray magics[] = {
+            "RIFF", "RIFX", "RF64", "BW64", "riff", "FORM", ".snd", "dns.", "fLaC", "OggS", "caff", "ID3",
+            "Creative Voice File", "NIST_1A",
+        };
+        for (const auto &magic : magics) {
+            if (header.startsWith(magic))
+                return true;
+        }
+        // MPEG audio frame sync, excluding layer bits 00, which is AAC in ADTS
+        return header.size() >= 2 && quint8(header[0]) == 0xff && (quint8(header[1]) & 0xe0) == 0xe0 &&
+               (quint8(header[1]) & 0x06) != 0;
+    }
     AbstractAudioFormatIO *StandardFormatEntry::getFormatOpen(const QString &filename, QVariant &userData, QWidget *win) {
         Q_D(StandardFormatEntry);
         auto io = std::make_unique<AudioFormatIOObject>();
@@ -164,6 +177,10 @@ namespace talcs {
         return io.release();
     }
     AbstractAudioFormatIO *StandardFormatEntry::getFormatLoad(const QString &filename, const QVariant &userData) {
+        FormatManager::ProbeInfo probeInfo;
+        return getFormatLoadProbed(filename, userData, probeInfo);
+    }
+    AbstractAudioFormatIO *StandardFormatEntry::getFormatLoadProbed(const QString &filename, const QVariant &userData, FormatManager::ProbeInfo &probeInfo) {
         auto io = std::make_unique<AudioFormatIOObject>();
         auto f = std::make_unique<QFile>(filename, io.get());
         if (!f->open(QIODevice::ReadOnly)) {
@@ -180,10 +197,14 @@ namespace talcs {
             streamOffset = rawOptions.value("offset").toInt();
         }
         io->setStream(f.release(), streamOffset);
+        // The file has been loaded by this entry before and is unchanged, so it is not validated again
+        if (probeInfo.channelCount > 0)
+            return io.release();
         if (!io->open(AbstractAudioFormatIO::Read)) {
             qWarning() << "StandardFormatEntry: Cannot open AudioFormatIO on loading" << filename << io->errorString();
             return nullptr;
         }
+        probeInfo = {{}, io->format(), io->channelCount(), io->sampleRate(), io->length()};
         io->close();
         return io.release();
     }
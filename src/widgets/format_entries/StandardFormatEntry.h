@@ -36,8 +36,10 @@ namespace talcs {
 
         QStringList filters() const override;
         QStringList extensionHints() const override;
+        bool matchesHeader(const QByteArray &header) const override;
         AbstractAudioFormatIO *getFormatOpen(const QString &filename, QVariant &userData, QWidget *win) override;
         AbstractAudioFormatIO *getFormatLoad(const QString &filename, const QVariant &userData) override;
+        AbstractAudioFormatIO *getFormatLoadProbed(const QString &filename, const QVariant &userData, FormatManager::ProbeInfo &probeInfo) override;
 
     private:
         QScopedPointer<StandardFormatEntryPrivate> d_ptr;
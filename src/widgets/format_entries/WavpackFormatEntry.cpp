@@ -60,6 +60,10 @@ namespace talcs {
         return extensionHints;
     }
 
+    bool WavpackFormatEntry::matchesHeader(const QByteArray &header) const {
+        return header.startsWith("wvpk");
+    }
+
     AbstractAudioFormatIO * WavpackFormatEntry::getFormatOpen(const QString &filename, QVariant &userData, QWidget *win) {
         auto f = std::make_unique<QFile>(filename);
         if (!f->open(QIODevice::ReadOnly)) {
@@ -33,6 +33,7 @@ public:
 
     QStringList filters() const override;
     QStringList extensionHints() const override;
+    bool matchesHeader(const QByteArray &header) const override;
     AbstractAudioFormatIO * getFormatOpen(const QString &filename, QVariant &userData, QWidget *win) override;
     AbstractAudioFormatIO * getFormatLoad(const QString &filename, const QVariant &userData) override;
 };
@@ -0,0 +1,136 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#include <cmath>
+#include <functional>
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <TalcsCore/AudioBuffer.h>
+#include <TalcsFormat/AudioFormatIO.h>
+#include <TalcsFormat/AudioFormatInputSource.h>
+#include <TalcsFormat/MemoryMappedAudioFormatIO.h>
+
+using namespace talcs;
+
+static constexpr double PI = 3.14159265358979323846;
+static const int CHANNEL_COUNT = 2;
+static const double SAMPLE_RATE = 48000;
+static const qint64 LENGTH = 48000 * 60;
+static const qint64 BUFFER_SIZE = 1024;
+
+static bool writeFile(const QString &filename, int format) {
+    QFile f(filename);
+    if (!f.open(QIODevice::WriteOnly))
+        return false;
+    AudioFormatIO io(&f);
+    io.setFormat(format);
+    io.setChannelCount(CHANNEL_COUNT);
+    io.setSampleRate(SAMPLE_RATE);
+    if (!io.open(AbstractAudioFormatIO::Write))
+        return false;
+    QVector<float> block(BUFFER_SIZE * CHANNEL_COUNT);
+    for (qint64 pos = 0; pos < LENGTH; pos += BUFFER_SIZE) {
+        for (qint64 i = 0; i < BUFFER_SIZE; i++) {
+            auto value = float(0.5 * std::sin(2 * PI * 440 * double(pos + i) / SAMPLE_RATE));
+            for (int ch = 0; ch < CHANNEL_COUNT; ch++)
+                block[i * CHANNEL_COUNT + ch] = value;
+        }
+        io.write(block.data(), qMin(BUFFER_SIZE, LENGTH - pos));
+    }
+    io.close();
+    return true;
+}
+
+static void benchmark(const QString &name, AbstractAudioFormatIO *io, double sampleRate) {
+    AudioFormatInputSource src(io);
+    AudioBuffer buf(CHANNEL_COUNT, BUFFER_SIZE);
+    QElapsedTimer timer;
+    timer.start();
+    if (!src.open(BUFFER_SIZE, sampleRate)) {
+        qWarning() << name << "cannot be opened";
+        return;
+    }
+    qint64 readLength = 0;
+    auto outLength = src.length();
+    while (readLength < outLength) {
+        auto length = src.read(&buf);
+        if (length <= 0)
+            break;
+        readLength += length;
+    }
+    src.close();
+    auto elapsed = timer.nsecsElapsed();
+    auto audioSeconds = double(LENGTH) / SAMPLE_RATE;
+    qInfo().noquote() << QString("%1 (%2 Hz): %3 ms, %4x realtime")
+                             .arg(name, -40)
+                             .arg(sampleRate)
+                             .arg(elapsed / 1e6, 0, 'f', 2)
+                             .arg(audioSeconds / (elapsed / 1e9), 0, 'f', 1);
+}
+
+int main(int argc, char **argv) {
+    QCoreApplication a(argc, argv);
+
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        qWarning() << "Cannot create temporary directory";
+        return 1;
+    }
+
+    struct FileEntry {
+        QString name;
+        int format;
+        bool mappable;
+    };
+    const QList<FileEntry> entries = {
+        {"wav-pcm16.wav", AudioFormatIO::WAV | AudioFormatIO::PCM_16, true},
+        {"wav-float.wav", AudioFormatIO::WAV | AudioFormatIO::FLOAT, true},
+        {"flac.flac", AudioFormatIO::FLAC | AudioFormatIO::PCM_16, false},
+        {"ogg.ogg", AudioFormatIO::OGG | AudioFormatIO::VORBIS, false},
+    };
+
+    for (const auto &entry : entries) {
+        auto filename = dir.filePath(entry.name);
+        if (!writeFile(filename, entry.format)) {
+            qWarning() << "Cannot write" << entry.name;
+            continue;
+        }
+        for (double sampleRate : {SAMPLE_RATE, 44100.0}) {
+            {
+                QFile f(filename);
+                f.open(QIODevice::ReadOnly);
+                AudioFormatIO io(&f);
+                benchmark(entry.name + " [AudioFormatIO]", &io, sampleRate);
+            }
+            if (entry.mappable) {
+                QFile f(filename);
+                f.open(QIODevice::ReadOnly);
+                MemoryMappedAudioFormatIO io(&f);
+                benchmark(entry.name + " [MemoryMappedAudioFormatIO]", &io, sampleRate);
+            }
+        }
+    }
+
+    return 0;
+}
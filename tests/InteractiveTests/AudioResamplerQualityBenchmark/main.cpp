@@ -0,0 +1,105 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#include <cmath>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <TalcsFormat/AudioResampler.h>
+
+using namespace talcs;
+
+static constexpr double PI = 3.14159265358979323846;
+static const qint64 BUFFER_SIZE = 1024;
+static const qint64 LENGTH = 48000 * 60;
+// Samples at both ends excluded from the measurement of THD+N
+static const qint64 MARGIN = 4096;
+
+class SineResampler : public AudioResampler {
+public:
+    SineResampler(double frequency, double sourceSampleRate, double destinationSampleRate, Quality quality)
+            : AudioResampler(destinationSampleRate / sourceSampleRate, BUFFER_SIZE, quality),
+              frequency(frequency), sourceSampleRate(sourceSampleRate) {
+    }
+
+protected:
+    void read(float *inputBlock, qint64 length) override {
+        for (qint64 i = 0; i < length; i++)
+            inputBlock[i] = float(0.5 * std::sin(2 * PI * frequency * double(position + i) / sourceSampleRate));
+        position += length;
+    }
+
+private:
+    double frequency;
+    double sourceSampleRate;
+    qint64 position = 0;
+};
+
+static void benchmark(const QString &qualityName, AudioResampler::Quality quality, double frequency,
+                      double sourceSampleRate, double destinationSampleRate) {
+    SineResampler resampler(frequency, sourceSampleRate, destinationSampleRate, quality);
+    std::vector<float> output(LENGTH);
+    QElapsedTimer timer;
+    timer.start();
+    for (qint64 pos = 0; pos < LENGTH; pos += BUFFER_SIZE)
+        resampler.process(output.data() + pos, qMin(BUFFER_SIZE, LENGTH - pos));
+    auto elapsed = timer.nsecsElapsed();
+
+    // The residual against the ideal sine is the sum of harmonic distortion, aliasing and noise
+    double signalEnergy = 0;
+    double residualEnergy = 0;
+    for (qint64 i = MARGIN; i < LENGTH - MARGIN; i++) {
+        auto expected = 0.5 * std::sin(2 * PI * frequency * double(i) / destinationSampleRate);
+        signalEnergy += expected * expected;
+        residualEnergy += (output[i] - expected) * (output[i] - expected);
+    }
+    auto thdn = 10 * std::log10(residualEnergy / signalEnergy);
+
+    auto audioSeconds = double(LENGTH) / destinationSampleRate;
+    qInfo().noquote() << QString("%1 %2 Hz -> %3 Hz, %4 Hz sine: %5x realtime, THD+N %6 dB")
+                             .arg(qualityName, -12)
+                             .arg(sourceSampleRate)
+                             .arg(destinationSampleRate)
+                             .arg(frequency)
+                             .arg(audioSeconds / (elapsed / 1e9), 0, 'f', 1)
+                             .arg(thdn, 0, 'f', 1);
+}
+
+int main(int argc, char **argv) {
+    QCoreApplication a(argc, argv);
+
+    struct Conversion {
+        double sourceSampleRate;
+        double destinationSampleRate;
+    };
+    for (auto conversion : {Conversion{44100, 48000}, Conversion{48000, 44100}, Conversion{48000, 96000}, Conversion{96000, 48000}}) {
+        for (double frequency : {1000.0, 10000.0}) {
+            benchmark("Linear", AudioResampler::Linear, frequency, conversion.sourceSampleRate, conversion.destinationSampleRate);
+            benchmark("Cubic", AudioResampler::Cubic, frequency, conversion.sourceSampleRate, conversion.destinationSampleRate);
+            benchmark("ShortSinc", AudioResampler::ShortSinc, frequency, conversion.sourceSampleRate, conversion.destinationSampleRate);
+            benchmark("Sinc", AudioResampler::Sinc, frequency, conversion.sourceSampleRate, conversion.destinationSampleRate);
+            benchmark("HighQuality", AudioResampler::HighQuality, frequency, conversion.sourceSampleRate, conversion.destinationSampleRate);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#include <cmath>
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QThreadPool>
+
+#include <TalcsCore/AudioBuffer.h>
+#include <TalcsFormat/MultichannelAudioResampler.h>
+
+using namespace talcs;
+
+static constexpr double PI = 3.14159265358979323846;
+static const double SOURCE_SAMPLE_RATE = 44100;
+static const double DESTINATION_SAMPLE_RATE = 48000;
+static const qint64 BUFFER_SIZE = 1024;
+static const qint64 LENGTH = 48000 * 30;
+
+class SineResampler : public MultichannelAudioResampler {
+public:
+    SineResampler(int channelCount) : MultichannelAudioResampler(DESTINATION_SAMPLE_RATE / SOURCE_SAMPLE_RATE, BUFFER_SIZE, channelCount) {
+    }
+
+protected:
+    void read(const AudioSourceReadData &readData) override {
+        for (qint64 i = 0; i < readData.length; i++) {
+            auto value = float(0.5 * std::sin(2 * PI * 440 * double(position + i) / SOURCE_SAMPLE_RATE));
+            for (int ch = 0; ch < channelCount(); ch++)
+                readData.buffer->setSample(ch, readData.startPos + i, value);
+        }
+        position += readData.length;
+    }
+
+private:
+    qint64 position = 0;
+};
+
+static qint64 benchmark(int channelCount, QThreadPool *threadPool) {
+    SineResampler resampler(channelCount);
+    resampler.setThreadPool(threadPool);
+    AudioBuffer buf(channelCount, BUFFER_SIZE);
+    QElapsedTimer timer;
+    timer.start();
+    for (qint64 pos = 0; pos < LENGTH; pos += BUFFER_SIZE)
+        resampler.process({&buf, 0, qMin(BUFFER_SIZE, LENGTH - pos)});
+    return timer.nsecsElapsed();
+}
+
+int main(int argc, char **argv) {
+    QCoreApplication a(argc, argv);
+
+    qInfo() << "Thread pool size:" << QThreadPool::globalInstance()->maxThreadCount();
+    auto audioSeconds = double(LENGTH) / DESTINATION_SAMPLE_RATE;
+    for (int channelCount : {1, 2, 4, 8, 16}) {
+        auto serial = benchmark(channelCount, nullptr);
+        auto parallel = benchmark(channelCount, QThreadPool::globalInstance());
+        qInfo().noquote() << QString("%1 channels: serial %2 ms (%3x realtime), parallel %4 ms (%5x realtime), speedup %6")
+                                 .arg(channelCount, 2)
+                                 .arg(serial / 1e6, 0, 'f', 2)
+                                 .arg(audioSeconds / (serial / 1e9), 0, 'f', 1)
+                                 .arg(parallel / 1e6, 0, 'f', 2)
+                                 .arg(audioSeconds / (parallel / 1e9), 0, 'f', 1)
+                                 .arg(double(serial) / double(parallel), 0, 'f', 2);
+    }
+
+    return 0;
+}
@@ -29,7 +29,21 @@ using namespace talcs;
 
 class TestResampler1 : public AudioResampler {
 public:
-    TestResampler1() : AudioResampler(0.8, 1024), src(440) {
+    explicit TestResampler1(Quality quality = HighQuality) : AudioResampler(0.8, 1024, quality), src(440) {
+        src.open(1300, 48000);
+    }
+    void read(float *inputBlock, qint64 length) override {
+        AudioDataWrapper buf(&inputBlock, 1, length);
+        src.read(&buf);
+    }
+
+private:
+    SineWaveAudioSource src;
+};
+
+class TestResampler2 : public AudioResampler {
+public:
+    TestResampler2(double ratio, Quality quality, bool isVariableRatio = false) : AudioResampler(ratio, 1024, quality, isVariableRatio), src(440) {
         src.open(1300, 48000);
     }
     void read(float *inputBlock, qint64 length) override {
@@ -86,6 +100,102 @@ private slots:
         QVERIFY(Decibels::gainToDecibels(buf.rms(0)) < -72);
     }
 
+    void sincProcess_data() {
+        QTest::addColumn<int>("quality");
+        QTest::newRow("ShortSinc") << int(AudioResampler::ShortSinc);
+        QTest::newRow("Sinc") << int(AudioResampler::Sinc);
+    }
+
+    void sincProcess() {
+        static const quint32 MAGIC_SEED = 114514;
+        QRandomGenerator g(MAGIC_SEED);
+
+        QFETCH(int, quality);
+        TestResampler1 resampler(static_cast<AudioResampler::Quality>(quality));
+
+        AudioBuffer buf(1, 32768 + 1024);
+        for (int i = 0; i < 32768 + 1024;) {
+            int len = g.bounded(0, 1025);
+            resampler.process(buf.data(0) + i, len);
+            i += len;
+        }
+        buf.resize(-1, 32768);
+
+        SineWaveAudioSource cmpSrc(440);
+        cmpSrc.open(32768, 38400);
+        AudioBuffer cmpBuf(1, 32768);
+        cmpSrc.read(&cmpBuf);
+        buf.addSampleRange(0, 0, 32768, cmpBuf, 0, 0, -1);
+
+        QVERIFY(Decibels::gainToDecibels(buf.magnitude(0)) < -24);
+        QVERIFY(Decibels::gainToDecibels(buf.rms(0)) < -72);
+    }
+
+    void powerOfTwoProcess_data() {
+        QTest::addColumn<double>("ratio");
+        QTest::addColumn<int>("quality");
+        for (double ratio : {2.0, 0.5, 4.0, 0.25}) {
+            QTest::addRow("%g ShortSinc", ratio) << ratio << int(AudioResampler::ShortSinc);
+            QTest::addRow("%g Sinc", ratio) << ratio << int(AudioResampler::Sinc);
+            QTest::addRow("%g HighQuality", ratio) << ratio << int(AudioResampler::HighQuality);
+        }
+    }
+
+    void powerOfTwoProcess() {
+        static const quint32 MAGIC_SEED = 114514;
+        QRandomGenerator g(MAGIC_SEED);
+
+        QFETCH(double, ratio);
+        QFETCH(int, quality);
+        TestResampler2 resampler(ratio, static_cast<AudioResampler::Quality>(quality));
+
+        AudioBuffer buf(1, 32768 + 1024);
+        for (int i = 0; i < 32768 + 1024;) {
+            int len = g.bounded(0, 1025);
+            resampler.process(buf.data(0) + i, len);
+            i += len;
+        }
+        buf.resize(-1, 32768);
+
+        // The half-band resamplers are expected to be as accurate as the general engines
+        SineWaveAudioSource cmpSrc(440);
+        cmpSrc.open(32768, 48000 * ratio);
+        AudioBuffer cmpBuf(1, 32768);
+        cmpSrc.read(&cmpBuf);
+        buf.addSampleRange(0, 0, 32768, cmpBuf, 0, 0, -1);
+
+        QVERIFY(Decibels::gainToDecibels(buf.magnitude(0)) < -24);
+        QVERIFY(Decibels::gainToDecibels(buf.rms(0)) < -72);
+    }
+
+    void variableRatio() {
+        static const quint32 MAGIC_SEED = 114514;
+        QRandomGenerator g(MAGIC_SEED);
+
+        TestResampler2 resampler(1.0, AudioResampler::Sinc, true);
+        QVERIFY(resampler.isVariableRatio());
+
+        // The output must follow the input time continuously while the ratio ramps up and down
+        AudioBuffer buf(1, 32768);
+        AudioBuffer cmpBuf(1, 32768);
+        for (int i = 0; i < 32768; i++) {
+            if (i % 4096 == 0)
+                resampler.setRatio(0.5 + g.generateDouble(), g.bounded(0, 4096));
+            cmpBuf.data(0)[i] = static_cast<float>(std::sin(2 * 3.14159265358979323846 * 440 * resampler.inputTime() / 48000));
+            resampler.process(buf.data(0) + i, 1);
+        }
+        buf.addSampleRange(0, 0, 32768, cmpBuf, 0, 0, -1);
+
+        QVERIFY(Decibels::gainToDecibels(buf.magnitude(0)) < -24);
+        QVERIFY(Decibels::gainToDecibels(buf.rms(0)) < -72);
+
+        // Smaller ratios are clamped to the largest step that the history is allocated for
+        resampler.setRatio(0.01);
+        QCOMPARE(resampler.ratio(), 0.125);
+        resampler.process(buf.data(0), 1024);
+        resampler.process(buf.data(0), 1024);
+    }
+
     void zeroReadLength() {
         static const quint32 MAGIC_SEED = 114514;
         QRandomGenerator g(MAGIC_SEED);
@@ -19,12 +19,43 @@
 
 #include <QtTest/QtTest>
 
+#include <QSemaphore>
+#include <QThread>
+
 #include <TalcsCore/AudioSourceClipSeries.h>
 #include <TalcsCore/AudioBuffer.h>
 #include <TalcsCore/MemoryAudioSource.h>
 
 using namespace talcs;
 
+// Counts opens and closes, and if gated, blocks in open() until the gate is released
+class GatedAudioSource : public MemoryAudioSource {
+public:
+    explicit GatedAudioSource(AudioBuffer *buffer, bool isGated = false) : MemoryAudioSource(buffer), isGated(isGated) {
+    }
+
+    bool open(qint64 bufferSize, double sampleRate) override {
+        openEnterCount.fetchAndAddOrdered(1);
+        if (isGated)
+            gate.acquire();
+        openThread = QThread::currentThread();
+        openCount.fetchAndAddOrdered(1);
+        return MemoryAudioSource::open(bufferSize, sampleRate);
+    }
+
+    void close() override {
+        closeCount.fetchAndAddOrdered(1);
+        MemoryAudioSource::close();
+    }
+
+    bool isGated;
+    QSemaphore gate;
+    QAtomicInt openEnterCount = 0;
+    QAtomicInt openCount = 0;
+    QAtomicInt closeCount = 0;
+    QThread *openThread = nullptr;
+};
+
 class TestAudioSourceClipSeries : public QObject {
     Q_OBJECT
 private slots:
@@ -77,6 +108,228 @@ private slots:
         }
     }
 
+    void clipFading() {
+        AudioBuffer buf1(1, 1024);
+        std::fill_n(buf1.data(0), 1024, 1.0f);
+        MemoryAudioSource src1(&buf1);
+        AudioSourceClipSeries series;
+        auto clip = series.insertClip(&src1, 0, 0, 1024);
+        series.setClipFadeIn(clip, 256, FadeCurve::Linear);
+        series.setClipFadeOut(clip, 512, FadeCurve::Linear);
+        QCOMPARE(clip.fadeInLength(), 256);
+        QCOMPARE(clip.fadeOutShape(), FadeCurve::Linear);
+        AudioBuffer tmpBuf(1, 1024);
+        series.open(1024, 48000);
+        series.read(&tmpBuf);
+        for (int i = 0; i < 256; i++)
+            QVERIFY(qAbs(tmpBuf.sample(0, i) - i / 256.0f) < 1e-4f);
+        for (int i = 256; i < 512; i++)
+            QCOMPARE(tmpBuf.sample(0, i), 1.0f);
+        for (int i = 512; i < 1024; i++)
+            QVERIFY(qAbs(tmpBuf.sample(0, i) - (1024 - i) / 512.0f) < 1e-4f);
+    }
+
+    void clipGainPanAndMute() {
+        AudioBuffer buf1(2, 1024);
+        std::fill_n(buf1.data(0), 1024, 1.0f);
+        std::fill_n(buf1.data(1), 1024, 1.0f);
+        MemoryAudioSource src1(&buf1);
+        AudioSourceClipSeries series;
+        auto clip = series.insertClip(&src1, 0, 0, 1024);
+        series.setClipGain(clip, 0.5f);
+        series.setClipPan(clip, 0.5f);
+        QCOMPARE(clip.gain(), 0.5f);
+        AudioBuffer tmpBuf(2, 1024);
+        series.open(1024, 48000);
+        series.read(&tmpBuf);
+        for (int i = 0; i < 1024; i++) {
+            QCOMPARE(tmpBuf.sample(0, i), 0.25f);
+            QCOMPARE(tmpBuf.sample(1, i), 0.5f);
+        }
+        series.setClipMute(clip, true);
+        QVERIFY(clip.isMute());
+        series.setNextReadPosition(0);
+        series.read(&tmpBuf);
+        for (int i = 0; i < 1024; i++) {
+            QCOMPARE(tmpBuf.sample(0, i), 0.0f);
+            QCOMPARE(tmpBuf.sample(1, i), 0.0f);
+        }
+    }
+
+    void clipCrossfading() {
+        AudioBuffer buf1(1, 1024);
+        std::fill_n(buf1.data(0), 1024, 1.0f);
+        MemoryAudioSource src1(&buf1);
+        AudioBuffer buf2(1, 1024);
+        std::fill_n(buf2.data(0), 1024, 1.0f);
+        MemoryAudioSource src2(&buf2);
+        AudioSourceClipSeries series;
+        series.insertClip(&src1, 0, 0, 1024);
+        series.insertClip(&src2, 768, 0, 1024);
+        series.setOverlapCrossfadeEnabled(true);
+        series.setOverlapCrossfadeShape(FadeCurve::Linear);
+        AudioBuffer tmpBuf(1, 2048);
+        series.open(2048, 48000);
+        series.read(&tmpBuf);
+        for (int i = 0; i < 1792; i++)
+            QVERIFY(qAbs(tmpBuf.sample(0, i) - 1.0f) < 1e-4f);
+        for (int i = 1792; i < 2048; i++)
+            QCOMPARE(tmpBuf.sample(0, i), 0.0f);
+    }
+
+    void emptyRanges() {
+        AudioBuffer buf1(1, 1024);
+        MemoryAudioSource src1(&buf1);
+        AudioBuffer buf2(1, 1024);
+        MemoryAudioSource src2(&buf2);
+        AudioSourceClipSeries series;
+        QCOMPARE(series.nextNonEmptyPosition(0), std::numeric_limits<qint64>::max());
+        series.insertClip(&src1, 1024, 0, 1024);
+        auto clip2 = series.insertClip(&src2, 1536, 0, 512);
+        QCOMPARE(series.nextNonEmptyPosition(0), 1024);
+        QCOMPARE(series.nextNonEmptyPosition(1500), 1500);
+        QCOMPARE(series.nextNonEmptyPosition(2048), std::numeric_limits<qint64>::max());
+        QVERIFY(series.isEmptyRange(0, 1024));
+        QVERIFY(!series.isEmptyRange(0, 1025));
+        // Both clips end at the same position, removing one of them must not lose the other
+        series.removeClip(clip2);
+        QCOMPARE(series.effectiveLength(), 2048);
+        QCOMPARE(series.nextNonEmptyPosition(1600), 1600);
+    }
+
+    void openWindowFollowsReadPosition() {
+        AudioBuffer buf1(1, 1024);
+        AudioBuffer buf2(1, 1024);
+        std::fill_n(buf2.data(0), 1024, 1.0f);
+        GatedAudioSource src1(&buf1);
+        GatedAudioSource src2(&buf2);
+        AudioSourceClipSeries series;
+        series.setOpenWindowSize(4096);
+        series.insertClip(&src1, 0, 0, 1024);
+        series.insertClip(&src2, 8192, 0, 1024);
+        QVERIFY(series.open(1024, 48000));
+        QCOMPARE(src1.openCount.loadAcquire(), 1);
+        QCOMPARE(src2.openCount.loadAcquire(), 0);
+        AudioBuffer tmpBuf(1, 1024);
+        for (int i = 0; i < 6; i++)
+            series.read(&tmpBuf);
+        // The window is now [1024, 9216), so the second clip is opened ahead and the first one is closed behind
+        QTRY_COMPARE(src2.openCount.loadAcquire(), 1);
+        QTRY_COMPARE(src1.closeCount.loadAcquire(), 1);
+        QVERIFY(src2.openThread != QThread::currentThread());
+        series.setNextReadPosition(8192);
+        series.read(&tmpBuf);
+        QCOMPARE(tmpBuf.sample(0, 0), 1.0f);
+        QCOMPARE(src2.openCount.loadAcquire(), 1);
+        QCOMPARE(series.synchronousOpenCount(), qint64(0));
+    }
+
+    void skipClipNotOpenYet() {
+        AudioBuffer buf1(1, 1024);
+        std::fill_n(buf1.data(0), 1024, 1.0f);
+        AudioBuffer buf2(1, 1024);
+        std::fill_n(buf2.data(0), 1024, 2.0f);
+        GatedAudioSource src1(&buf1, true);
+        GatedAudioSource src2(&buf2, true);
+        AudioSourceClipSeries series;
+        series.setOpenWindowSize(4096);
+        series.insertClip(&src1, 65536, 0, 1024);
+        series.insertClip(&src2, 66560, 0, 1024);
+        QVERIFY(series.open(1024, 48000));
+        series.setNextReadPosition(65536);
+        // The worker is blocked in opening one clip, and the other one is still queued
+        QTRY_COMPARE(src1.openEnterCount.loadAcquire() + src2.openEnterCount.loadAcquire(), 1);
+        auto busySrc = src1.openEnterCount.loadAcquire() ? &src1 : &src2;
+        auto queuedSrc = busySrc == &src1 ? &src2 : &src1;
+        auto queuedPosition = queuedSrc == &src1 ? 65536 : 66560;
+        auto queuedValue = queuedSrc == &src1 ? 1.0f : 2.0f;
+        AudioBuffer tmpBuf(1, 1024);
+        auto readAt = [&](qint64 pos) {
+            series.setNextReadPosition(pos);
+            series.read(&tmpBuf);
+            return tmpBuf.sample(0, 0);
+        };
+        // The reading thread neither opens the queued clip nor waits for it
+        QCOMPARE(readAt(queuedPosition), 0.0f);
+        QCOMPARE(queuedSrc->openEnterCount.loadAcquire(), 0);
+        QCOMPARE(series.synchronousOpenCount(), qint64(1));
+        // The skipped clip is opened by the worker once it is free
+        queuedSrc->gate.release();
+        busySrc->gate.release();
+        QTRY_COMPARE(readAt(queuedPosition), queuedValue);
+        QCOMPARE(queuedSrc->openCount.loadAcquire(), 1);
+        QVERIFY(queuedSrc->openThread != QThread::currentThread());
+        QTRY_COMPARE(busySrc->openCount.loadAcquire(), 1);
+        series.resetSynchronousOpenCount();
+        QCOMPARE(series.synchronousOpenCount(), qint64(0));
+    }
+
+    void seekIntoClipBeingOpened() {
+        AudioBuffer buf1(1, 1024);
+        std::fill_n(buf1.data(0), 1024, 1.0f);
+        GatedAudioSource src1(&buf1, true);
+        AudioSourceClipSeries series;
+        series.setOpenWindowSize(4096);
+        series.insertClip(&src1, 65536, 0, 1024);
+        QVERIFY(series.open(1024, 48000));
+        series.setNextReadPosition(65536);
+        QTRY_COMPARE(src1.openEnterCount.loadAcquire(), 1);
+        AudioBuffer tmpBuf(1, 1024);
+        auto readAt = [&](qint64 pos) {
+            series.setNextReadPosition(pos);
+            series.read(&tmpBuf);
+            return tmpBuf.sample(0, 0);
+        };
+        // The read neither waits for the open in progress nor opens the clip a second time
+        QCOMPARE(readAt(65536), 0.0f);
+        QCOMPARE(series.synchronousOpenCount(), qint64(1));
+        src1.gate.release();
+        QTRY_COMPARE(readAt(65536), 1.0f);
+        QCOMPARE(src1.openEnterCount.loadAcquire(), 1);
+    }
+
+    void removeClipDuringOpen() {
+        AudioBuffer buf1(1, 1024);
+        std::fill_n(buf1.data(0), 1024, 1.0f);
+        AudioBuffer buf2(1, 1024);
+        std::fill_n(buf2.data(0), 1024, 1.0f);
+        GatedAudioSource src1(&buf1, true);
+        GatedAudioSource src2(&buf2, true);
+        AudioSourceClipSeries series;
+        series.setOpenWindowSize(4096);
+        auto clip1 = series.insertClip(&src1, 65536, 0, 1024);
+        auto clip2 = series.insertClip(&src2, 66560, 0, 1024);
+        QVERIFY(series.open(1024, 48000));
+        series.setNextReadPosition(65536);
+        QTRY_COMPARE(src1.openEnterCount.loadAcquire() + src2.openEnterCount.loadAcquire(), 1);
+        auto busyClip = src1.openEnterCount.loadAcquire() ? clip1 : clip2;
+        auto queuedClip = busyClip == clip1 ? clip2 : clip1;
+        auto busySrc = static_cast<GatedAudioSource *>(busyClip.content());
+        auto queuedSrc = static_cast<GatedAudioSource *>(queuedClip.content());
+        // The queued clip is dropped from the queue at once
+        series.removeClip(queuedClip);
+        QAtomicInt isRemoved = 0;
+        QScopedPointer<QThread> remover(QThread::create([&] {
+            series.removeClip(busyClip);
+            isRemoved.storeRelease(1);
+        }));
+        remover->start();
+        // The clip being opened is removed only after the open finishes
+        QTest::qWait(50);
+        QCOMPARE(isRemoved.loadAcquire(), 0);
+        busySrc->gate.release();
+        queuedSrc->gate.release();
+        QVERIFY(remover->wait(5000));
+        QVERIFY(series.clips().isEmpty());
+        AudioBuffer tmpBuf(1, 1024);
+        series.setNextReadPosition(65536);
+        series.read(&tmpBuf);
+        QCOMPARE(tmpBuf.sample(0, 0), 0.0f);
+        QTest::qWait(50);
+        QCOMPARE(busySrc->openCount.loadAcquire(), 1);
+        QCOMPARE(queuedSrc->openEnterCount.loadAcquire(), 0);
+    }
+
 };
 
 QTEST_MAIN(TestAudioSourceClipSeries)
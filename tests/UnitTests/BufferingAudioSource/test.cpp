@@ -19,12 +19,61 @@
 
 #include <QtTest/QtTest>
 
+#include <QRandomGenerator>
+#include <QThreadPool>
+
 #include <TalcsCore/BufferingAudioSource.h>
 #include <TalcsCore/SineWaveAudioSource.h>
 #include <TalcsCore/AudioBuffer.h>
+#include <TalcsCore/AudioCacheBudget.h>
+#include <TalcsCore/MemoryAudioSource.h>
+#include <TalcsCore/PositionableMixerAudioSource.h>
 
 using namespace talcs;
 
+// Each sample is its own position. Reading blocks while held, and sleeps for the delay in milliseconds in each read. If
+// a read counter is set, the first read takes a number from it. Setting the looping range hint blocks while the hint is
+// held.
+class SlowAudioSource : public MemoryAudioSource {
+public:
+    explicit SlowAudioSource(AudioBuffer *buffer) : MemoryAudioSource(buffer) {
+        for (qint64 i = 0; i < buffer->sampleCount(); i++)
+            buffer->data(0)[i] = float(i);
+    }
+
+    void setNextReadPosition(qint64 pos) override {
+        seekCount.fetchAndAddOrdered(1);
+        MemoryAudioSource::setNextReadPosition(pos);
+    }
+
+    void setLoopingRangeHint(qint64 l, qint64 r) override {
+        isHintEntered.storeRelease(1);
+        while (isHintHeld.loadAcquire())
+            QThread::msleep(1);
+        MemoryAudioSource::setLoopingRangeHint(l, r);
+    }
+
+    QAtomicInt isHeld = 0;
+    QAtomicInt isHintHeld = 0;
+    QAtomicInt isHintEntered = 0;
+    QAtomicInt delay = 0;
+    QAtomicInt seekCount = 0;
+    QAtomicPointer<QAtomicInt> readCounter = nullptr;
+    QAtomicInt readIndex = -1;
+
+protected:
+    qint64 processReading(const AudioSourceReadData &readData) override {
+        auto counter = readCounter.loadAcquire();
+        if (counter && readIndex.loadAcquire() < 0)
+            readIndex.storeRelease(counter->fetchAndAddOrdered(1));
+        while (isHeld.loadAcquire())
+            QThread::msleep(1);
+        if (delay.loadAcquire())
+            QThread::msleep(delay.loadAcquire());
+        return MemoryAudioSource::processReading(readData);
+    }
+};
+
 class TestBufferingAudioSource: public QObject {
     Q_OBJECT
 private slots:
@@ -124,6 +173,302 @@ private slots:
         }
     }
 
+    void seekWhileBuffering() {
+        // Each sample is its own position, so any sample buffered before a seek is detected after it
+        AudioBuffer rampBuf(1, 1 << 20);
+        SlowAudioSource src(&rampBuf);
+        BufferingAudioSource bufSrc(&src, 1, 16384);
+        bufSrc.open(256, 48000);
+        QRandomGenerator rng(42);
+        AudioBuffer buf(1, 256);
+        qint64 recentPos = 0;
+        qint64 staleSampleCount = 0;
+        for (int i = 0; i < 4000; i++) {
+            // Seek back to a recent position now and then, which is served from the seek cache window
+            qint64 pos = rng.bounded(4) == 0 ? recentPos : rng.bounded(int(rampBuf.sampleCount() - 65536));
+            recentPos = pos;
+            bufSrc.setNextReadPosition(pos);
+            int blockCount = rng.bounded(1, 8);
+            for (int j = 0; j < blockCount; j++) {
+                bufSrc.read(&buf);
+                for (qint64 k = 0; k < buf.sampleCount(); k++) {
+                    if (buf.constData(0)[k] != float(pos + k))
+                        staleSampleCount++;
+                }
+                pos += buf.sampleCount();
+            }
+        }
+        QCOMPARE(staleSampleCount, qint64(0));
+    }
+
+    void skipUnderrun() {
+        AudioBuffer rampBuf(1, 1 << 20);
+        SlowAudioSource src(&rampBuf);
+        BufferingAudioSource bufSrc(&src, 1, 16384);
+        bufSrc.setUnderrunPolicy(BufferingAudioSource::Silence);
+        bufSrc.open(256, 48000);
+        QVERIFY(bufSrc.waitForBuffering(QDeadlineTimer(2000)));
+        auto seekCount = src.seekCount.loadAcquire();
+        AudioBuffer buf(1, 256);
+
+        // Drain the ring buffer and underrun for 8 blocks while the source is held
+        src.isHeld.storeRelease(1);
+        for (qint64 pos = 0; pos < 16384; pos += 256)
+            bufSrc.read(&buf);
+        QCOMPARE(bufSrc.underrunCount(), qint64(0));
+        for (int i = 0; i < 8; i++) {
+            bufSrc.read(&buf);
+            QCOMPARE(buf.magnitude(0), 0.0f);
+        }
+        QCOMPARE(bufSrc.underrunCount(), qint64(8));
+
+        // The buffering task drops the audio that arrives late instead of being repositioned
+        src.isHeld.storeRelease(0);
+        QVERIFY(bufSrc.waitForBuffering(QDeadlineTimer(2000)));
+        bufSrc.read(&buf);
+        QCOMPARE(buf.constData(0)[0], float(16384 + 2048));
+        QCOMPARE(buf.constData(0)[255], float(16384 + 2048 + 255));
+        QCOMPARE(src.seekCount.loadAcquire(), seekCount);
+
+        // Falling behind by more than the ring buffer repositions the buffering task
+        src.isHeld.storeRelease(1);
+        qint64 pos = 16384 + 2048 + 256;
+        for (int i = 0; i < 2 * 16384 / 256 + 1; i++) {
+            bufSrc.read(&buf);
+            pos += 256;
+        }
+        src.isHeld.storeRelease(0);
+        QVERIFY(bufSrc.waitForBuffering(QDeadlineTimer(2000)));
+        bufSrc.read(&buf);
+        QCOMPARE(buf.constData(0)[0], float(pos));
+        QVERIFY(src.seekCount.loadAcquire() > seekCount);
+    }
+
+    void skipWhileLocked() {
+        AudioBuffer rampBuf(1, 1 << 20);
+        SlowAudioSource src(&rampBuf);
+        BufferingAudioSource bufSrc(&src, 1, 16384);
+        bufSrc.setUnderrunPolicy(BufferingAudioSource::Silence);
+        bufSrc.open(256, 48000);
+        QVERIFY(bufSrc.waitForBuffering(QDeadlineTimer(2000)));
+        AudioBuffer buf(1, 256);
+        bufSrc.read(&buf);
+        QCOMPARE(buf.constData(0)[0], 0.0f);
+
+        // The reader does not wait for a setter holding the mutex
+        src.isHintHeld.storeRelease(1);
+        QScopedPointer<QThread> setter(QThread::create([&] {
+            bufSrc.setLoopingRangeHint(0, 1 << 20);
+        }));
+        setter->start();
+        QTRY_COMPARE(src.isHintEntered.loadAcquire(), 1);
+        for (int i = 0; i < 2; i++) {
+            bufSrc.read(&buf);
+            QCOMPARE(buf.magnitude(0), 0.0f);
+        }
+        QCOMPARE(bufSrc.underrunCount(), qint64(2));
+        src.isHintHeld.storeRelease(0);
+        QVERIFY(setter->wait(2000));
+
+        // The skipped blocks are caught up on
+        bufSrc.read(&buf);
+        QCOMPARE(buf.constData(0)[0], float(768));
+        QCOMPARE(buf.constData(0)[255], float(768 + 255));
+        QCOMPARE(bufSrc.nextReadPosition(), qint64(1024));
+    }
+
+    void earliestDeadlineFirst() {
+        QThreadPool pool;
+        pool.setMaxThreadCount(1);
+        AudioBuffer rampBufA(1, 1 << 18), rampBufB(1, 1 << 18), rampBufC(1, 1 << 18), rampBufD(1, 1 << 18);
+        SlowAudioSource srcA(&rampBufA), srcB(&rampBufB), srcC(&rampBufC), srcD(&rampBufD);
+        BufferingAudioSource bufSrcA(&srcA, 1, 16384, true, &pool);
+        BufferingAudioSource bufSrcB(&srcB, 1, 16384, true, &pool);
+        BufferingAudioSource bufSrcC(&srcC, 1, 16384, true, &pool);
+        BufferingAudioSource bufSrcD(&srcD, 1, 16384, true, &pool);
+        bufSrcC.setIoGroup("file");
+        bufSrcD.setIoGroup("file");
+        QCOMPARE(bufSrcD.ioGroup(), QString("file"));
+        for (auto bufSrc : {&bufSrcA, &bufSrcB, &bufSrcC, &bufSrcD}) {
+            bufSrc->open(256, 48000);
+            QVERIFY(bufSrc->waitForBuffering(QDeadlineTimer(2000)));
+        }
+        AudioBuffer buf(1, 256);
+
+        // Occupy the only worker with A
+        srcA.isHeld.storeRelease(1);
+        for (int i = 0; i < 16; i++)
+            bufSrcA.read(&buf);
+        QTRY_COMPARE(BufferingAudioSource::schedulerStatistics(&pool).busyWorkerCount, 1);
+
+        // Read no faster than real time, so that the slack only depends on the buffered length. C is closest to
+        // underrun, and D is in the same I/O group as C.
+        for (int i = 0; i < 48; i++) {
+            if (i < 16) {
+                bufSrcB.read(&buf);
+                bufSrcD.read(&buf);
+            }
+            bufSrcC.read(&buf);
+            QThread::msleep(6);
+        }
+        QCOMPARE(BufferingAudioSource::schedulerStatistics(&pool).queueDepth, 3);
+
+        QAtomicInt readCounter = 0;
+        for (auto src : {&srcB, &srcC, &srcD})
+            src->readCounter.storeRelease(&readCounter);
+        srcA.isHeld.storeRelease(0);
+        QTRY_COMPARE(readCounter.loadAcquire(), 3);
+        QCOMPARE(srcC.readIndex.loadAcquire(), 0);
+        QCOMPARE(srcD.readIndex.loadAcquire(), 1);
+        QCOMPARE(srcB.readIndex.loadAcquire(), 2);
+        for (auto bufSrc : {&bufSrcA, &bufSrcB, &bufSrcC, &bufSrcD})
+            QVERIFY(bufSrc->waitForBuffering(QDeadlineTimer(2000)));
+    }
+
+    void adaptiveReadAhead() {
+        AudioBuffer rampBuf(1, 1 << 20);
+        SlowAudioSource src(&rampBuf);
+        BufferingAudioSource bufSrc(&src, 1, 65536);
+        bufSrc.setAdaptiveReadAheadEnabled(true);
+        bufSrc.setUnderrunPolicy(BufferingAudioSource::Silence);
+        // At this sample rate, the buffer must stay comfortable for 100 reads before the read-ahead shrinks
+        bufSrc.open(256, 2560);
+        QCOMPARE(bufSrc.fillStatistics().effectiveReadAheadSize, qint64(16384));
+        QVERIFY(bufSrc.waitForBuffering(QDeadlineTimer(2000)));
+        QCOMPARE(bufSrc.fillStatistics().bufferedLength, qint64(16384));
+        AudioBuffer buf(1, 256);
+
+        // Underruns grow the read-ahead up to readAheadSize()
+        src.isHeld.storeRelease(1);
+        for (int i = 0; i < 72; i++) {
+            bufSrc.read(&buf);
+            auto size = bufSrc.fillStatistics().effectiveReadAheadSize;
+            QVERIFY(size >= 4096 && size <= 65536);
+        }
+        auto statistics = bufSrc.fillStatistics();
+        QVERIFY(statistics.underrunCount > 0);
+        QCOMPARE(statistics.minimumBufferedLength, qint64(0));
+        QCOMPARE(statistics.effectiveReadAheadSize, qint64(65536));
+        src.isHeld.storeRelease(0);
+        QVERIFY(bufSrc.waitForBuffering(QDeadlineTimer(2000)));
+        QCOMPARE(bufSrc.fillStatistics().bufferedLength, qint64(65536));
+
+        // Comfortable fills shrink the read-ahead down to the minimum
+        bufSrc.resetFillStatistics();
+        qint64 lastSize = 65536;
+        for (int i = 0; i < 2500; i++) {
+            bufSrc.read(&buf);
+            QVERIFY(bufSrc.waitForBuffering(QDeadlineTimer(2000)));
+            auto size = bufSrc.fillStatistics().effectiveReadAheadSize;
+            QVERIFY(size <= lastSize && size >= 4096);
+            if (i == 99)
+                QVERIFY(size < 65536);
+            lastSize = size;
+        }
+        QCOMPARE(lastSize, qint64(4096));
+        QCOMPARE(bufSrc.fillStatistics().underrunCount, qint64(0));
+    }
+
+    void loopCacheWindow() {
+        SineWaveAudioSource src(440);
+        BufferingAudioSource bufSrc(&src, 2, 65536);
+        bufSrc.setLoopingRangeHint(0, 8192);
+        QCOMPARE(bufSrc.loopingRangeHint(), qMakePair(0ll, 8192ll));
+        bufSrc.open(1024, 48000);
+        AudioBuffer buf(2, 8192);
+        for (qint64 i = 0; i < 8192; i += 1024)
+            bufSrc.read({&buf, i, 1024});
+
+        // Wrapping around the loop is served from the cache window, and the source continues after the window
+        bufSrc.setNextReadPosition(0);
+        QVERIFY(bufSrc.waitForBuffering(QDeadlineTimer(2000)));
+        QCOMPARE(src.nextReadPosition(), 8192 + 65536);
+        buf.clear();
+        for (qint64 i = 0; i < 8192; i += 1024)
+            bufSrc.read({&buf, i, 1024});
+        QCOMPARE(bufSrc.nextReadPosition(), 8192);
+
+        AudioBuffer refBuf(2, 8192);
+        SineWaveAudioSource refSrc(440);
+        refSrc.open(8192, 48000);
+        refSrc.read(&refBuf);
+        for (qint64 i = 0; i < 8192; i++) {
+            QCOMPARE(buf.constData(0)[i], refBuf.constData(0)[i]);
+            QCOMPARE(buf.constData(1)[i], refBuf.constData(1)[i]);
+        }
+    }
+
+    void cacheWindowContentChange() {
+        AudioBuffer ones(2, 65536);
+        AudioBuffer twos(2, 65536);
+        for (int ch = 0; ch < 2; ch++) {
+            std::fill(ones.data(ch), ones.data(ch) + 65536, 1.0f);
+            std::fill(twos.data(ch), twos.data(ch) + 65536, 2.0f);
+        }
+        MemoryAudioSource memSrc(&ones);
+        PositionableMixerAudioSource mixer;
+        mixer.addSource(&memSrc);
+        BufferingAudioSource bufSrc(&mixer, 2, 16384);
+        bufSrc.setLoopingRangeHint(0, 8192);
+        bufSrc.open(1024, 48000);
+        QVERIFY(bufSrc.waitForBuffering(QDeadlineTimer(2000)));
+        AudioBuffer buf(2, 8192);
+        for (qint64 i = 0; i < 8192; i += 1024)
+            bufSrc.read({&buf, i, 1024});
+        QCOMPARE(buf.constData(0)[8191], 1.0f);
+
+        // The content of a source in the mixer changes, so the loop is not replayed from the cache window
+        auto version = bufSrc.contentVersion();
+        memSrc.setBuffer(&twos);
+        QVERIFY(bufSrc.contentVersion() != version);
+        bufSrc.setNextReadPosition(0);
+        QVERIFY(bufSrc.waitForBuffering(QDeadlineTimer(2000)));
+        for (qint64 i = 0; i < 8192; i += 1024)
+            bufSrc.read({&buf, i, 1024});
+        for (qint64 i = 0; i < 8192; i++)
+            QCOMPARE(buf.constData(0)[i], 2.0f);
+    }
+
+    void memoryBudget() {
+        SineWaveAudioSource src1(440);
+        SineWaveAudioSource src2(440);
+        BufferingAudioSource bufSrc1(&src1, 2, 65536);
+        BufferingAudioSource bufSrc2(&src2, 2, 65536);
+        bufSrc1.setSeekCacheWindowCount(0);
+        bufSrc2.setSeekCacheWindowCount(0);
+        bufSrc1.open(1024, 48000);
+        bufSrc2.open(1024, 48000);
+        QCOMPARE(bufSrc1.preferredCacheMemory(), qint64(65536 * 2 * sizeof(float)));
+        QCOMPARE(bufSrc1.minimumCacheMemory(), qint64(4096 * 2 * sizeof(float)));
+
+        // The source that has been read is closer to the playhead
+        QThread::msleep(10);
+        AudioBuffer buf(2, 1024);
+        bufSrc1.read(&buf);
+
+        AudioCacheBudget budget;
+        budget.registerClient(&bufSrc1);
+        budget.registerClient(&bufSrc2);
+        budget.setBudget(bufSrc1.preferredCacheMemory() + bufSrc2.minimumCacheMemory());
+        QCOMPARE(bufSrc1.cacheMemoryUsage(), bufSrc1.preferredCacheMemory());
+
+        // The buffered audio is kept until the next seek, when the ring buffer is resized
+        QVERIFY(bufSrc2.waitForBuffering(QDeadlineTimer(2000)));
+        QCOMPARE(bufSrc2.cacheMemoryUsage(), bufSrc2.preferredCacheMemory());
+        QCOMPARE(bufSrc2.fillStatistics().bufferedLength, qint64(65536));
+        bufSrc2.flush();
+        QVERIFY(bufSrc2.waitForBuffering(QDeadlineTimer(2000)));
+        QCOMPARE(bufSrc2.cacheMemoryUsage(), bufSrc2.minimumCacheMemory());
+        QCOMPARE(budget.totalUsage(), budget.budget());
+        QCOMPARE(budget.clientUsage().size(), 2);
+
+        budget.setBudget(0);
+        bufSrc2.flush();
+        QVERIFY(bufSrc2.waitForBuffering(QDeadlineTimer(2000)));
+        QCOMPARE(bufSrc2.cacheMemoryUsage(), bufSrc2.preferredCacheMemory());
+        budget.unregisterClient(&bufSrc1);
+        budget.unregisterClient(&bufSrc2);
+    }
 
 };
 
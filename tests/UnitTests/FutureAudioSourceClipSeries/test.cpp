@@ -0,0 +1,199 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <QFutureInterface>
+#include <QThread>
+
+#include <TalcsCore/FutureAudioSourceClipSeries.h>
+#include <TalcsCore/FutureAudioSource.h>
+#include <TalcsCore/StreamingAudioBuffer.h>
+#include <TalcsCore/AudioBuffer.h>
+#include <TalcsCore/MemoryAudioSource.h>
+
+using namespace talcs;
+
+class TestFutureAudioSourceClipSeries : public QObject {
+    Q_OBJECT
+private slots:
+    void blockReadingPlaysRenderedPart() {
+        QFutureInterface<PositionableAudioSource *> futureInterface;
+        futureInterface.setProgressRange(0, 2048);
+        futureInterface.reportStarted();
+        StreamingAudioBuffer streamingBuf(1, 2048);
+        MemoryAudioSource streamingSrc(&streamingBuf);
+        MemoryAudioSource readySrc(&streamingBuf);
+        FutureAudioSource src(futureInterface.future());
+        src.setStreamingSource(&streamingSrc);
+
+        FutureAudioSourceClipSeries series;
+        series.setReadMode(FutureAudioSourceClipSeries::Block);
+        series.insertClip(&src, 0, 0, 2048);
+        QVERIFY(series.open(1024, 48000));
+
+        AudioBuffer renderedBuf(1, 1024);
+        std::fill_n(renderedBuf.data(0), 1024, 1.0f);
+        QCOMPARE(streamingBuf.append(renderedBuf, 0, 1024), qint64(1024));
+        futureInterface.setProgressValue(1024);
+
+        AudioBuffer tmpBuf1(1, 1024);
+        AudioBuffer tmpBuf2(1, 1024);
+        QAtomicInt readCount = 0;
+        QScopedPointer<QThread> reader(QThread::create([&] {
+            series.read(&tmpBuf1);
+            readCount.storeRelease(1);
+            series.read(&tmpBuf2);
+            readCount.storeRelease(2);
+        }));
+        reader->start();
+
+        // The first half plays while the render is still running
+        QTRY_COMPARE(readCount.loadAcquire(), 1);
+        QCOMPARE(src.status(), FutureAudioSource::Running);
+        QCOMPARE(tmpBuf1.sample(0, 0), 1.0f);
+        QCOMPARE(tmpBuf1.sample(0, 1023), 1.0f);
+
+        // The second half blocks until it is rendered
+        QTest::qWait(50);
+        QCOMPARE(readCount.loadAcquire(), 1);
+        std::fill_n(renderedBuf.data(0), 1024, 0.5f);
+        QCOMPARE(streamingBuf.append(renderedBuf, 0, 1024), qint64(1024));
+        futureInterface.setProgressValue(2048);
+        QTRY_COMPARE(readCount.loadAcquire(), 2);
+        QVERIFY(reader->wait(5000));
+        QCOMPARE(src.status(), FutureAudioSource::Running);
+        QCOMPARE(tmpBuf2.sample(0, 0), 0.5f);
+        QCOMPARE(tmpBuf2.sample(0, 1023), 0.5f);
+
+        futureInterface.reportResult(&readySrc);
+        futureInterface.reportFinished();
+        QTRY_COMPARE(src.status(), FutureAudioSource::Ready);
+        QTRY_COMPARE(src.source(), static_cast<PositionableAudioSource *>(&readySrc));
+        QVERIFY(readySrc.isOpen());
+    }
+
+    void maxConcurrentRenderCount() {
+        QFutureInterface<PositionableAudioSource *> futureInterfaces[3];
+        for (auto &futureInterface : futureInterfaces) {
+            futureInterface.setProgressRange(0, 1024);
+            futureInterface.reportStarted();
+        }
+        FutureAudioSource src0(futureInterfaces[0].future());
+        FutureAudioSource src1(futureInterfaces[1].future());
+        FutureAudioSource src2(futureInterfaces[2].future());
+
+        FutureAudioSourceClipSeries series;
+        series.insertClip(&src0, 0, 0, 1024);
+        series.insertClip(&src1, 480000, 0, 1024);
+        series.insertClip(&src2, 960000, 0, 1024);
+        QVERIFY(series.open(1024, 48000));
+        series.setMaxConcurrentRenderCount(1);
+        QCOMPARE(series.maxConcurrentRenderCount(), 1);
+        QCOMPARE(src0.status(), FutureAudioSource::Running);
+        QCOMPARE(src1.status(), FutureAudioSource::Paused);
+        QCOMPARE(src2.status(), FutureAudioSource::Paused);
+
+        // Reading and seeking do not pause or resume the futures, and the ranking follows on the thread of the series
+        AudioBuffer buf(2, 1024);
+        series.read(&buf);
+        series.setNextReadPosition(960000);
+        QCOMPARE(src0.status(), FutureAudioSource::Running);
+        QCOMPARE(src2.status(), FutureAudioSource::Paused);
+        QTRY_COMPARE(src2.status(), FutureAudioSource::Running);
+        QCOMPARE(src0.status(), FutureAudioSource::Paused);
+        QCOMPARE(src1.status(), FutureAudioSource::Paused);
+
+        // Behind the read position, the clips at the beginning of the hinted looping range come first
+        series.setLoopingRangeHint(0, 961024);
+        series.setMaxConcurrentRenderCount(2);
+        QCOMPARE(src2.status(), FutureAudioSource::Running);
+        QCOMPARE(src0.status(), FutureAudioSource::Running);
+        QCOMPARE(src1.status(), FutureAudioSource::Paused);
+
+        series.setMaxConcurrentRenderCount(0);
+        QCOMPARE(src0.status(), FutureAudioSource::Running);
+        QCOMPARE(src1.status(), FutureAudioSource::Running);
+        QCOMPARE(src2.status(), FutureAudioSource::Running);
+    }
+
+    void blockReadingOverlappingClips() {
+        QFutureInterface<PositionableAudioSource *> futureInterfaces[2];
+        for (auto &futureInterface : futureInterfaces) {
+            futureInterface.setProgressRange(0, 8192);
+            futureInterface.reportStarted();
+        }
+        StreamingAudioBuffer streamingBuf(1, 8192);
+        MemoryAudioSource streamingSrc(&streamingBuf);
+        AudioBuffer renderedBuf(1, 8192);
+        std::fill_n(renderedBuf.data(0), 8192, 1.0f);
+        QCOMPARE(streamingBuf.append(renderedBuf, 0, 8192), qint64(8192));
+        futureInterfaces[0].setProgressValue(8192);
+        FutureAudioSource src0(futureInterfaces[0].future());
+        src0.setStreamingSource(&streamingSrc);
+        FutureAudioSource src1(futureInterfaces[1].future());
+
+        FutureAudioSourceClipSeries series;
+        series.setReadMode(FutureAudioSourceClipSeries::Block);
+        series.insertClip(&src0, 0, 0, 8192);
+        series.insertClip(&src1, 4096, 0, 8192);
+        QVERIFY(series.open(1024, 48000));
+        series.setMaxConcurrentRenderCount(1);
+        QCOMPARE(src0.status(), FutureAudioSource::Running);
+        QCOMPARE(src1.status(), FutureAudioSource::Paused);
+
+        // The read position enters the paused clip before the timer re-ranks. The event loop of this thread does not
+        // run until the reader finishes, so the paused clip must not be waited for.
+        AudioBuffer buf(1, 1024);
+        QScopedPointer<QThread> reader(QThread::create([&] {
+            series.setNextReadPosition(4096);
+            series.read(&buf);
+        }));
+        reader->start();
+        QVERIFY(reader->wait(5000));
+        QCOMPARE(src1.status(), FutureAudioSource::Paused);
+
+        // Both clips are read by the next block, so both keep running beyond the limit
+        QTRY_COMPARE(src1.status(), FutureAudioSource::Running);
+        QCOMPARE(src0.status(), FutureAudioSource::Running);
+        series.setMaxConcurrentRenderCount(0);
+    }
+
+    void streamingAudioBuffer() {
+        StreamingAudioBuffer buf(2, 40000);
+        QCOMPARE(buf.sampleCount(), qint64(40000));
+        QCOMPARE(buf.sampleCountAvailable(), qint64(0));
+        AudioBuffer src(1, 30000);
+        for (int i = 0; i < 30000; i++)
+            src.data(0)[i] = float(i);
+        QCOMPARE(buf.append(src, 0, 30000), qint64(30000));
+        QCOMPARE(buf.sampleCountAvailable(), qint64(30000));
+        QCOMPARE(buf.sample(0, 20000), 20000.0f);
+        QCOMPARE(buf.sample(1, 20000), 0.0f);
+        QCOMPARE(buf.sample(0, 30000), 0.0f);
+        // Appending stops at the end of the buffer
+        QCOMPARE(buf.append(src, 0, 30000), qint64(10000));
+        QCOMPARE(buf.sample(0, 39999), 9999.0f);
+    }
+
+};
+
+QTEST_MAIN(TestFutureAudioSourceClipSeries)
+
+#include "test.moc"
@@ -326,6 +326,25 @@ private slots:
         mixer.removeAllSources();
     }
 
+    void loopingRangeHintAndContentVersion() {
+        PositionableMixerAudioSource mixer;
+        PositionableMixerAudioSource emptyMixer;
+        SineWaveAudioSource src(440);
+        mixer.addSource(&src);
+        mixer.addSource(&emptyMixer);
+        mixer.setLoopingRangeHint(0, 1024);
+        QCOMPARE(src.loopingRangeHint(), qMakePair(0ll, 1024ll));
+        QCOMPARE(emptyMixer.loopingRangeHint(), qMakePair(-1ll, -1ll));
+
+        auto version = mixer.contentVersion();
+        mixer.setGain(0.5);
+        QVERIFY(mixer.contentVersion() != version);
+        version = mixer.contentVersion();
+        src.setFrequency(880);
+        QVERIFY(mixer.contentVersion() != version);
+        mixer.removeAllSources();
+    }
+
 };
 
 QTEST_MAIN(TestIMixer)
@@ -0,0 +1,338 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <TalcsFormat/AudioFormatIO.h>
+#include <TalcsFormat/MemoryMappedAudioFormatIO.h>
+
+using namespace talcs;
+
+template <class T>
+static void appendLittleEndian(QByteArray &bytes, T value) {
+    char p[sizeof(T)];
+    qToLittleEndian(value, p);
+    bytes.append(p, sizeof(T));
+}
+
+template <class T>
+static void appendBigEndian(QByteArray &bytes, T value) {
+    char p[sizeof(T)];
+    qToBigEndian(value, p);
+    bytes.append(p, sizeof(T));
+}
+
+static QVector<qint16> randomInt16Samples(QRandomGenerator &g, int sampleCount) {
+    QVector<qint16> samples(sampleCount);
+    for (auto &sample : samples)
+        sample = qint16(g.bounded(-32768, 32768));
+    return samples;
+}
+
+// The fmt chunk of 16-bit stereo PCM at 44100 Hz
+static void appendRiffFormatChunk(QByteArray &bytes) {
+    bytes.append("fmt ", 4);
+    appendLittleEndian<quint32>(bytes, 16);
+    appendLittleEndian<quint16>(bytes, 1);
+    appendLittleEndian<quint16>(bytes, 2);
+    appendLittleEndian<quint32>(bytes, 44100);
+    appendLittleEndian<quint32>(bytes, 44100 * 4);
+    appendLittleEndian<quint16>(bytes, 4);
+    appendLittleEndian<quint16>(bytes, 16);
+}
+
+static bool writeFile(const QString &fileName, const QByteArray &bytes) {
+    QFile file(fileName);
+    return file.open(QIODevice::WriteOnly) && file.write(bytes) == bytes.size();
+}
+
+// Returns whether the interleaved samples equal exactly the 16-bit samples converted to float
+static bool verifyInt16Samples(const float *ptr, const qint16 *samples, qint64 sampleCount) {
+    for (qint64 i = 0; i < sampleCount; i++) {
+        if (ptr[i] != float(samples[i]) / 32768.0f)
+            return false;
+    }
+    return true;
+}
+
+// Reads sequentially in random chunks and then at random positions, and returns whether io gives the same samples as
+// the reference
+static bool readsMatch(AbstractAudioFormatIO &io, AbstractAudioFormatIO &ref, QRandomGenerator &g) {
+    if (io.length() != ref.length() || io.channelCount() != ref.channelCount())
+        return false;
+    int channelCount = io.channelCount();
+    QVector<float> buf(channelCount * 4096);
+    QVector<float> refBuf(channelCount * 4096);
+    auto compareRead = [&](qint64 length) {
+        auto readLength = io.read(buf.data(), length);
+        if (readLength != ref.read(refBuf.data(), length) || io.pos() != ref.pos())
+            return false;
+        return std::equal(buf.cbegin(), buf.cbegin() + readLength * channelCount, refBuf.cbegin());
+    };
+    while (io.pos() < io.length()) {
+        if (!compareRead(g.bounded(1, 4097)))
+            return false;
+    }
+    if (!compareRead(1))
+        return false;
+    for (int t = 0; t < 200; t++) {
+        qint64 position = g.bounded(0, int(io.length()) + 1);
+        if (io.seek(position) != position || ref.seek(position) != position)
+            return false;
+        if (!compareRead(g.bounded(1, 4097)))
+            return false;
+    }
+    return io.seek(io.length() + 1) == -1;
+}
+
+class TestMemoryMappedAudioFormatIO : public QObject {
+    Q_OBJECT
+private slots:
+    void compareWithAudioFormatIO_data() {
+        QTest::addColumn<int>("format");
+        QTest::addColumn<int>("expectedFormat");
+        static const QPair<int, const char *> riffFormats[] = {
+            {AudioFormatIO::WAV, "WAV"},
+            {AudioFormatIO::WAVEX, "WAVEX"},
+            {AudioFormatIO::RF64, "RF64"},
+            {AudioFormatIO::W64, "W64"},
+        };
+        static const QPair<int, const char *> riffSubtypes[] = {
+            {AudioFormatIO::PCM_U8, "PCM_U8"},
+            {AudioFormatIO::PCM_16, "PCM_16"},
+            {AudioFormatIO::PCM_24, "PCM_24"},
+            {AudioFormatIO::PCM_32, "PCM_32"},
+            {AudioFormatIO::FLOAT, "FLOAT"},
+            {AudioFormatIO::DOUBLE, "DOUBLE"},
+        };
+        for (const auto &majorFormat : riffFormats) {
+            for (const auto &subtype : riffSubtypes) {
+                // WAVE_FORMAT_EXTENSIBLE is reported as plain WAV
+                int expectedMajorFormat = majorFormat.first == AudioFormatIO::WAVEX ? AudioFormatIO::WAV : majorFormat.first;
+                QTest::addRow("%s %s", majorFormat.second, subtype.second) << (majorFormat.first | subtype.first) << (expectedMajorFormat | subtype.first);
+            }
+        }
+        static const QPair<int, const char *> aiffSubtypes[] = {
+            {AudioFormatIO::PCM_S8, "PCM_S8"},
+            {AudioFormatIO::PCM_16, "PCM_16"},
+            {AudioFormatIO::PCM_24, "PCM_24"},
+            {AudioFormatIO::PCM_32, "PCM_32"},
+            {AudioFormatIO::FLOAT, "FLOAT"},
+            {AudioFormatIO::DOUBLE, "DOUBLE"},
+        };
+        for (const auto &subtype : aiffSubtypes) {
+            QTest::addRow("AIFF %s", subtype.second) << (AudioFormatIO::AIFF | subtype.first) << (AudioFormatIO::AIFF | subtype.first);
+        }
+        // Little-endian AIFF is written as AIFC with the compression type "sowt"
+        for (const auto &subtype : aiffSubtypes) {
+            if (subtype.first == AudioFormatIO::PCM_S8 || subtype.first == AudioFormatIO::FLOAT || subtype.first == AudioFormatIO::DOUBLE)
+                continue;
+            int format = AudioFormatIO::AIFF | subtype.first | AudioFormatIO::LittleEndian;
+            QTest::addRow("AIFC sowt %s", subtype.second) << format << format;
+        }
+    }
+
+    void compareWithAudioFormatIO() {
+        static const quint32 MAGIC_SEED = 114514;
+        QRandomGenerator g(MAGIC_SEED);
+
+        QFETCH(int, format);
+        QFETCH(int, expectedFormat);
+
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QFile file(dir.filePath("test"));
+
+        // An odd length, to leave a pad byte after 8-bit data
+        static const qint64 LENGTH = 100001;
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        {
+            AudioFormatIO writer(&file);
+            writer.setFormat(format);
+            writer.setChannelCount(3);
+            writer.setSampleRate(48000);
+            QVERIFY2(writer.open(AbstractAudioFormatIO::Write), qPrintable(writer.errorString()));
+            QVector<float> buf(3 * LENGTH);
+            for (auto &sample : buf)
+                sample = float(g.bounded(1.8) - 0.9);
+            QCOMPARE(writer.write(buf.constData(), LENGTH), LENGTH);
+        }
+        file.close();
+
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        AudioFormatIO ref(&file);
+        QVERIFY(ref.open(AbstractAudioFormatIO::Read));
+        MemoryMappedAudioFormatIO io(&file);
+        QVERIFY2(io.open(AbstractAudioFormatIO::Read), qPrintable(io.errorString()));
+        QCOMPARE(io.format(), expectedFormat);
+        QCOMPARE(io.channelCount(), 3);
+        QCOMPARE(io.sampleRate(), 48000.0);
+        QCOMPARE(io.length(), LENGTH);
+        QCOMPARE(ref.length(), LENGTH);
+        QVERIFY(readsMatch(io, ref, g));
+    }
+
+    void oddSizedChunks() {
+        static const quint32 MAGIC_SEED = 114514;
+        QRandomGenerator g(MAGIC_SEED);
+
+        static const int LENGTH = 10001;
+        auto samples = randomInt16Samples(g, 2 * LENGTH);
+
+        // The odd-sized chunks are followed by a pad byte that is not included in the chunk size
+        QByteArray bytes("RIFF\0\0\0\0WAVE", 12);
+        bytes.append("LIST", 4);
+        appendLittleEndian<quint32>(bytes, 3);
+        bytes.append("abc\0", 4);
+        appendRiffFormatChunk(bytes);
+        bytes.append("junk", 4);
+        appendLittleEndian<quint32>(bytes, 5);
+        bytes.append("abcde\0", 6);
+        bytes.append("data", 4);
+        appendLittleEndian<quint32>(bytes, 4 * LENGTH);
+        for (auto sample : samples)
+            appendLittleEndian<qint16>(bytes, sample);
+        qToLittleEndian<quint32>(bytes.size() - 8, bytes.data() + 4);
+
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QVERIFY(writeFile(dir.filePath("test.wav"), bytes));
+        QFile file(dir.filePath("test.wav"));
+        QVERIFY(file.open(QIODevice::ReadOnly));
+
+        MemoryMappedAudioFormatIO io(&file);
+        QVERIFY(io.open(AbstractAudioFormatIO::Read));
+        QCOMPARE(io.format(), AudioFormatIO::WAV | AudioFormatIO::PCM_16);
+        QCOMPARE(io.channelCount(), 2);
+        QCOMPARE(io.sampleRate(), 44100.0);
+        QCOMPARE(io.length(), qint64(LENGTH));
+        QVector<float> buf(2 * LENGTH);
+        QCOMPARE(io.read(buf.data(), LENGTH), qint64(LENGTH));
+        QVERIFY(verifyInt16Samples(buf.constData(), samples.constData(), 2 * LENGTH));
+
+        QCOMPARE(io.seek(0), qint64(0));
+        AudioFormatIO ref(&file);
+        QVERIFY(ref.open(AbstractAudioFormatIO::Read));
+        QVERIFY(readsMatch(io, ref, g));
+    }
+
+    void rf64DataSize() {
+        static const quint32 MAGIC_SEED = 114514;
+        QRandomGenerator g(MAGIC_SEED);
+
+        static const int LENGTH = 10001;
+        auto samples = randomInt16Samples(g, 2 * LENGTH);
+
+        // The 32-bit sizes are 0xFFFFFFFF, so the data size must be taken from the ds64 chunk. A chunk after the data
+        // makes the file longer than the data.
+        QByteArray bytes("RF64\xFF\xFF\xFF\xFFWAVE", 12);
+        bytes.append("ds64", 4);
+        appendLittleEndian<quint32>(bytes, 28);
+        int riffSizeOffset = bytes.size();
+        appendLittleEndian<quint64>(bytes, 0);
+        appendLittleEndian<quint64>(bytes, 4 * LENGTH);
+        appendLittleEndian<quint64>(bytes, LENGTH);
+        appendLittleEndian<quint32>(bytes, 0);
+        appendRiffFormatChunk(bytes);
+        bytes.append("data\xFF\xFF\xFF\xFF", 8);
+        for (auto sample : samples)
+            appendLittleEndian<qint16>(bytes, sample);
+        bytes.append("junk", 4);
+        appendLittleEndian<quint32>(bytes, 64);
+        bytes.append(64, '\x7F');
+        qToLittleEndian<quint64>(bytes.size() - 8, bytes.data() + riffSizeOffset);
+
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QVERIFY(writeFile(dir.filePath("test.wav"), bytes));
+        QFile file(dir.filePath("test.wav"));
+        QVERIFY(file.open(QIODevice::ReadOnly));
+
+        MemoryMappedAudioFormatIO io(&file);
+        QVERIFY(io.open(AbstractAudioFormatIO::Read));
+        QCOMPARE(io.format(), AudioFormatIO::RF64 | AudioFormatIO::PCM_16);
+        QCOMPARE(io.length(), qint64(LENGTH));
+        QVector<float> buf(2 * LENGTH);
+        QCOMPARE(io.read(buf.data(), LENGTH + 1), qint64(LENGTH));
+        QVERIFY(verifyInt16Samples(buf.constData(), samples.constData(), 2 * LENGTH));
+
+        QCOMPARE(io.seek(0), qint64(0));
+        AudioFormatIO ref(&file);
+        QVERIFY(ref.open(AbstractAudioFormatIO::Read));
+        QVERIFY(readsMatch(io, ref, g));
+    }
+
+    void aifcSowt() {
+        static const quint32 MAGIC_SEED = 114514;
+        QRandomGenerator g(MAGIC_SEED);
+
+        static const int LENGTH = 10001;
+        auto samples = randomInt16Samples(g, 2 * LENGTH);
+
+        QByteArray bytes("FORM\0\0\0\0AIFC", 12);
+        bytes.append("FVER", 4);
+        appendBigEndian<quint32>(bytes, 4);
+        appendBigEndian<quint32>(bytes, 0xA2805140);
+        bytes.append("COMM", 4);
+        appendBigEndian<quint32>(bytes, 24);
+        appendBigEndian<qint16>(bytes, 2);
+        appendBigEndian<quint32>(bytes, LENGTH);
+        appendBigEndian<qint16>(bytes, 16);
+        // 44100 as an 80-bit extended precision number
+        appendBigEndian<quint16>(bytes, 0x400E);
+        appendBigEndian<quint64>(bytes, 0xAC44000000000000ull);
+        // The compression type followed by an empty compression name padded to an even length
+        bytes.append("sowt\0\0", 6);
+        bytes.append("ANNO", 4);
+        appendBigEndian<quint32>(bytes, 3);
+        bytes.append("abc\0", 4);
+        bytes.append("SSND", 4);
+        appendBigEndian<quint32>(bytes, 8 + 4 * LENGTH);
+        appendBigEndian<quint32>(bytes, 0);
+        appendBigEndian<quint32>(bytes, 0);
+        for (auto sample : samples)
+            appendLittleEndian<qint16>(bytes, sample);
+        qToBigEndian<quint32>(bytes.size() - 8, bytes.data() + 4);
+
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QVERIFY(writeFile(dir.filePath("test.aifc"), bytes));
+        QFile file(dir.filePath("test.aifc"));
+        QVERIFY(file.open(QIODevice::ReadOnly));
+
+        MemoryMappedAudioFormatIO io(&file);
+        QVERIFY(io.open(AbstractAudioFormatIO::Read));
+        QCOMPARE(io.format(), AudioFormatIO::AIFF | AudioFormatIO::PCM_16 | AudioFormatIO::LittleEndian);
+        QCOMPARE(io.channelCount(), 2);
+        QCOMPARE(io.sampleRate(), 44100.0);
+        QCOMPARE(io.length(), qint64(LENGTH));
+        QVector<float> buf(2 * LENGTH);
+        QCOMPARE(io.read(buf.data(), LENGTH), qint64(LENGTH));
+        QVERIFY(verifyInt16Samples(buf.constData(), samples.constData(), 2 * LENGTH));
+
+        QCOMPARE(io.seek(0), qint64(0));
+        AudioFormatIO ref(&file);
+        QVERIFY(ref.open(AbstractAudioFormatIO::Read));
+        QVERIFY(readsMatch(io, ref, g));
+    }
+};
+
+QTEST_MAIN(TestMemoryMappedAudioFormatIO)
+
+#include "test.moc"
@@ -0,0 +1,155 @@
+/******************************************************************************
+ * Copyright (c) 2024 CrSjimo                                                 *
+ *                                                                            *
+ * This file is part of TALCS.                                                *
+ *                                                                            *
+ * TALCS is free software: you can redistribute it and/or modify it under the *
+ * terms of the GNU Lesser General Public License as published by the Free    *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * TALCS is distributed in the hope that it will be useful, but WITHOUT ANY   *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS  *
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for    *
+ * more details.                                                              *
+ *                                                                            *
+ * You should have received a copy of the GNU Lesser General Public License   *
+ * along with TALCS. If not, see <https://www.gnu.org/licenses/>.             *
+ ******************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <TalcsFormat/ReadAheadAudioFormatIO.h>
+
+using namespace talcs;
+
+// Sample i of channel ch is i + 0.5 * ch. The decoder may end before the reported length to simulate truncated files.
+class RampAudioFormatIO : public AbstractAudioFormatIO {
+public:
+    explicit RampAudioFormatIO(qint64 length, qint64 decodableLength = -1)
+            : m_length(length), m_decodableLength(decodableLength < 0 ? length : decodableLength) {
+    }
+    bool open(OpenMode mode) override {
+        m_openMode = mode;
+        m_pos = 0;
+        return true;
+    }
+    OpenMode openMode() const override {
+        return m_openMode;
+    }
+    void close() override {
+        m_openMode = NotOpen;
+    }
+    int format() const override {
+        return 0;
+    }
+    void setFormat(int) override {
+    }
+    int channelCount() const override {
+        return 2;
+    }
+    void setChannelCount(int) override {
+    }
+    double sampleRate() const override {
+        return 48000;
+    }
+    void setSampleRate(double) override {
+    }
+    qint64 length() const override {
+        return m_length;
+    }
+    qint64 read(float *ptr, qint64 length) override {
+        length = qBound(0ll, length, m_decodableLength - m_pos);
+        for (qint64 i = 0; i < length; i++) {
+            ptr[2 * i] = float(m_pos + i);
+            ptr[2 * i + 1] = float(m_pos + i) + 0.5f;
+        }
+        m_pos += length;
+        return length;
+    }
+    qint64 write(const float *, qint64) override {
+        return 0;
+    }
+    qint64 seek(qint64 pos) override {
+        m_pos = pos;
+        return pos;
+    }
+    qint64 pos() const override {
+        return m_pos;
+    }
+
+private:
+    OpenMode m_openMode = NotOpen;
+    qint64 m_length;
+    qint64 m_decodableLength;
+    qint64 m_pos = 0;
+};
+
+static bool verifyRamp(const float *ptr, qint64 position, qint64 length) {
+    for (qint64 i = 0; i < length; i++) {
+        if (ptr[2 * i] != float(position + i) || ptr[2 * i + 1] != float(position + i) + 0.5f)
+            return false;
+    }
+    return true;
+}
+
+class TestReadAheadAudioFormatIO : public QObject {
+    Q_OBJECT
+private slots:
+    void sequentialRead() {
+        static const quint32 MAGIC_SEED = 114514;
+        QRandomGenerator g(MAGIC_SEED);
+
+        ReadAheadAudioFormatIO io(new RampAudioFormatIO(200000), true);
+        io.setChunkSize(4096);
+        QVERIFY(io.open(AbstractAudioFormatIO::Read));
+        QCOMPARE(io.length(), qint64(200000));
+
+        QVector<float> buf(2 * 10000);
+        qint64 position = 0;
+        while (position < io.length()) {
+            auto length = io.read(buf.data(), g.bounded(1, 10000));
+            QVERIFY(length > 0);
+            QVERIFY(verifyRamp(buf.constData(), position, length));
+            position += length;
+            QCOMPARE(io.pos(), position);
+        }
+        QCOMPARE(io.read(buf.data(), 1), qint64(0));
+    }
+
+    void randomSeek() {
+        static const quint32 MAGIC_SEED = 114514;
+        QRandomGenerator g(MAGIC_SEED);
+
+        ReadAheadAudioFormatIO io(new RampAudioFormatIO(200000), true);
+        io.setChunkSize(4096);
+        QVERIFY(io.open(AbstractAudioFormatIO::Read));
+
+        QVector<float> buf(2 * 10000);
+        for (int t = 0; t < 1000; t++) {
+            // Seeks both within and out of the queued chunks
+            qint64 position = g.bounded(2) ? io.pos() + g.bounded(0, 8192) : g.bounded(0, 200000);
+            position = qMin(position, io.length());
+            QCOMPARE(io.seek(position), position);
+            qint64 requestedLength = g.bounded(1, 10000);
+            auto length = io.read(buf.data(), requestedLength);
+            QCOMPARE(length, qMin(requestedLength, io.length() - position));
+            QVERIFY(verifyRamp(buf.constData(), position, length));
+        }
+    }
+
+    void truncatedSource() {
+        ReadAheadAudioFormatIO io(new RampAudioFormatIO(100000, 50000), true);
+        QVERIFY(io.open(AbstractAudioFormatIO::Read));
+
+        QVector<float> buf(2 * 100000);
+        auto length = io.read(buf.data(), 100000);
+        QCOMPARE(length, qint64(50000));
+        QVERIFY(verifyRamp(buf.constData(), 0, length));
+        QCOMPARE(io.read(buf.data(), 100000), qint64(0));
+    }
+};
+
+QTEST_MAIN(TestReadAheadAudioFormatIO)
+
+#include "test.moc"